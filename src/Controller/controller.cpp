@@ -1,51 +1,289 @@
 #include "controller.h"
 
+#include <atomic>
 #include <exception>
+#include <mutex>
+
+#include "model/meshLoader.h"
 
 namespace s21 {
 
+struct Controller::LoadJob {
+  std::string path;
+  // Polled by the loader; `finished` is set by BackgroundJobs.
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> finished{false};
+  std::atomic<int> lastPercent{-1};
+  std::unique_ptr<Mesh> mesh;
+  // Taken before parsing, so a file changed meanwhile is never cached as
+  // unchanged.
+  std::optional<FileStamp> stamp;
+  QString error;
+
+  // Streaming: batches accumulate here until the GUI thread picks them up,
+  // so a busy GUI receives fewer, larger batches.
+  std::mutex batchMutex;
+  std::vector<Vertex> batchVertices;
+  PolygonList batchPolygons;
+  bool batchQueued = false;
+  bool previewStarted = false;  // GUI thread only
+};
+
+Controller::~Controller() = default;
+
+bool Controller::IsLoading() const { return jobs_.current() != nullptr; }
+
 void Controller::LoadModel(const QString &path) {
-  try {
-    model_->loadFromFile(path.toStdString());
-    emit ModelLoaded(model_->vertexCount(), model_->edgeCount());
-    emit ModelChanged();
-  } catch (const std::exception &e) {
-    emit ModelLoadError(QString::fromUtf8(e.what()));
+  if (jobs_.current()) DropPreview(*jobs_.current());
+  // The load in progress is cancelled and stops being current, so a cache
+  // hit below leaves nothing that could still report back as this load.
+  jobs_.retire();
+
+  const std::string file = path.toStdString();
+  FileStamp stamp;
+  if (std::optional<Mesh> cached = cache_.take(file, &stamp)) {
+    ShowMesh(std::move(*cached), file, stamp);
+    return;
   }
+
+  auto job = std::make_shared<LoadJob>();
+  job->path = file;
+  if (fileStamp(file, stamp)) job->stamp = stamp;
+
+  LoadOptions options = model_->loadOptions();
+  options.progress.cancelled = &job->cancelled;
+  options.progress.onProgress = [this, job](size_t done, size_t total) {
+    const int percent = total ? static_cast<int>(done * 100 / total) : 100;
+    if (job->lastPercent.exchange(percent) != percent)
+      emit ModelLoadProgress(static_cast<qint64>(done),
+                             static_cast<qint64>(total));
+  };
+
+  if (streaming_) {
+    options.progress.onBatch = [this, job](const std::vector<Vertex> &vertices,
+                                           const PolygonList &polygons) {
+      std::lock_guard<std::mutex> lock(job->batchMutex);
+      job->batchVertices.insert(job->batchVertices.end(), vertices.begin(),
+                                vertices.end());
+      job->batchPolygons.append(polygons);
+      if (job->batchQueued) return;
+      job->batchQueued = true;
+      QMetaObject::invokeMethod(
+          this, [this, job] { OnLoadBatch(job); }, Qt::QueuedConnection);
+    };
+  }
+
+  jobs_.start(
+      job,
+      [job, options] {
+        try {
+          job->mesh =
+              std::make_unique<Mesh>(MeshLoader::load(job->path, options));
+        } catch (const LoadCancelled &) {
+        } catch (const std::exception &e) {
+          job->error = QString::fromUtf8(e.what());
+        }
+      },
+      [this, job] {
+        QMetaObject::invokeMethod(
+            this, [this, job] { OnLoadFinished(job); }, Qt::QueuedConnection);
+      });
 }
 
-void Controller::Translate(float dx, float dy, float dz) {
-  model_->translate(dx, dy, dz);
+void Controller::CancelLoad() {
+  if (jobs_.current()) jobs_.current()->cancelled = true;
+}
+
+void Controller::OnLoadBatch(const std::shared_ptr<LoadJob> &job) {
+  if (job != jobs_.current() || job->cancelled) return;
+
+  std::vector<Vertex> vertices;
+  PolygonList polygons;
+  {
+    std::lock_guard<std::mutex> lock(job->batchMutex);
+    vertices.swap(job->batchVertices);
+    polygons = std::move(job->batchPolygons);
+    job->batchPolygons.clear();
+    job->batchQueued = false;
+  }
+  if (!job->previewStarted) {
+    StashModel();
+    coalescer_.discard();
+    model_->beginPreview(job->path);
+    job->previewStarted = true;
+  }
+  model_->appendPreview(vertices, polygons);
   emit ModelChanged();
 }
-void Controller::RotateX(float rad) {
-  model_->rotateX(rad);
+
+void Controller::DropPreview(LoadJob &job) {
+  if (!job.previewStarted) return;
+  job.previewStarted = false;
+  model_->clear();
   emit ModelChanged();
 }
-void Controller::RotateY(float rad) {
-  model_->rotateY(rad);
+
+void Controller::OnLoadFinished(const std::shared_ptr<LoadJob> &job) {
+  // A superseded load is only joined; its result and state are dropped.
+  if (!jobs_.finish(job)) return;
+
+  if (job->cancelled || !job->mesh) DropPreview(*job);
+  if (job->cancelled) {
+    emit ModelLoadCancelled();
+  } else if (job->mesh) {
+    ShowMesh(std::move(*job->mesh), job->path, job->stamp);
+    job->mesh.reset();
+  } else {
+    emit ModelLoadError(job->error);
+  }
+}
+
+void Controller::StashModel() {
+  const std::string file = model_->filename();
+  if (modelStamp_ && !model_->isPreview() && model_->vertexCount() > 0 &&
+      !file.empty())
+    cache_.put(file, *modelStamp_, model_->takeMesh());
+  modelStamp_.reset();
+}
+
+void Controller::ShowMesh(Mesh mesh, const std::string &path,
+                          const std::optional<FileStamp> &stamp) {
+  StashModel();
+  coalescer_.discard();
+  model_->setMesh(std::move(mesh), path);
+  modelStamp_ = stamp;
+  emit ModelLoaded(model_->vertexCount(), model_->edgeCount());
   emit ModelChanged();
 }
+
+void Controller::SetCacheBudget(size_t bytes) { cache_.setBudget(bytes); }
+
+MeshCacheStats Controller::CacheStats() const { return cache_.stats(); }
+
+void Controller::SetProfilingEnabled(bool enabled) {
+  Profiler::instance().setEnabled(enabled);
+}
+bool Controller::IsProfilingEnabled() const {
+  return Profiler::instance().enabled();
+}
+ProfilerStats Controller::PerfStats() const {
+  return Profiler::instance().stats();
+}
+void Controller::ResetPerfStats() { Profiler::instance().reset(); }
+void Controller::WritePerfTrace(const QString &path) const {
+  Profiler::instance().writeChromeTrace(path.toStdString());
+}
+
+void Controller::BeginFrame() { coalescer_.apply(); }
+void Controller::FramePresented() { coalescer_.presented(); }
+
+void Controller::PostTransform(const std::function<void(Transform &)> &edit) {
+  // One repaint per frame; later commands only update the pending state.
+  if (coalescer_.post(edit)) emit ModelChanged();
+}
+
+void Controller::Translate(float dx, float dy, float dz) {
+  PostTransform([=](Transform &t) {
+    t.tx += dx;
+    t.ty += dy;
+    t.tz += dz;
+  });
+}
+void Controller::RotateX(float rad) {
+  PostTransform([=](Transform &t) { t.rx += rad; });
+}
+void Controller::RotateY(float rad) {
+  PostTransform([=](Transform &t) { t.ry += rad; });
+}
 void Controller::RotateZ(float rad) {
-  model_->rotateZ(rad);
-  emit ModelChanged();
+  PostTransform([=](Transform &t) { t.rz += rad; });
 }
 void Controller::Scale(float sx, float sy, float sz) {
-  model_->scale(sx, sy, sz);
-  emit ModelChanged();
+  (void)sy;
+  (void)sz;
+  PostTransform([=](Transform &t) {
+    t.s *= sx;
+    if (t.s <= 0.f) t.s = 1.f;
+  });
 }
 
 void Controller::SetTranslateAbs(float tx, float ty, float tz) {
-  model_->setTranslation(tx, ty, tz);
-  emit ModelChanged();
+  PostTransform([=](Transform &t) {
+    t.tx = tx;
+    t.ty = ty;
+    t.tz = tz;
+  });
 }
 void Controller::SetRotateAbs(float rx, float ry, float rz) {
-  model_->setRotation(rx, ry, rz);
-  emit ModelChanged();
+  PostTransform([=](Transform &t) {
+    t.rx = rx;
+    t.ry = ry;
+    t.rz = rz;
+  });
 }
 void Controller::SetScaleAbs(float s) {
-  model_->setScale(s);
+  PostTransform([=](Transform &t) { t.s = s; });
+}
+PickResult Controller::PickVertex(float x, float y, float radius) const {
+  return model_->pickVertex(x, y, radius);
+}
+PickResult Controller::PickEdge(float x, float y, float radius) const {
+  return model_->pickEdge(x, y, radius);
+}
+PickResult Controller::Raycast(float x, float y) const {
+  return model_->raycast(x, y);
+}
+PickResult Controller::NearestVertex(const Vertex &point,
+                                     float maxDistance) const {
+  return model_->nearestVertex(point, maxDistance);
+}
+
+void Controller::SetForcedLod(int level) {
+  model_->setForcedLod(level);
+  emit ModelChanged();
+}
+
+void Controller::SetGroupVisible(size_t group, bool visible) {
+  if (group >= model_->groups().size()) return;
+  model_->setGroupVisible(group, visible);
   emit ModelChanged();
 }
 
+void Controller::IsolateGroup(int group) {
+  if (group < 0)
+    model_->showAllGroups();
+  else if (static_cast<size_t>(group) < model_->groups().size())
+    model_->isolateGroup(group);
+  else
+    return;
+  emit ModelChanged();
+}
+
+void Controller::AddToScene(const QString &path) {
+  LoadOptions options = model_->loadOptions();
+  // Scene instances are not picked.
+  options.buildPickIndex = false;
+  scene_.setLoadOptions(options);
+  try {
+    scene_.addFromFile(path.toStdString());
+  } catch (const std::exception &e) {
+    emit ModelLoadError(QString::fromUtf8(e.what()));
+    return;
+  }
+  scene_.arrangeGrid();
+  emit SceneChanged(scene_.size(), scene_.geometryCount());
+}
+
+void Controller::DuplicateInScene() {
+  if (scene_.empty()) return;
+  scene_.addInstance(scene_.size() - 1);
+  scene_.arrangeGrid();
+  emit SceneChanged(scene_.size(), scene_.geometryCount());
+}
+
+void Controller::ClearScene() {
+  scene_.clear();
+  emit SceneChanged(0, 0);
+}
+
 }  // namespace s21
@@ -1,19 +1,72 @@
 #pragma once
 #include <QObject>
 #include <QString>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
 
+#include "model/backgroundJobs.h"
+#include "model/meshCache.h"
 #include "model/model.h"
+#include "model/profiler.h"
+#include "model/scene.h"
+#include "model/transformCoalescer.h"
 
 namespace s21 {
 class Controller : public QObject {
   Q_OBJECT
  public:
   explicit Controller(Model *model, QObject *parent = nullptr)
-      : QObject(parent), model_(model) {}
+      : QObject(parent), model_(model), coalescer_(*model) {}
+  ~Controller() override;
   Model *model() const { return model_; }
+  // Parts laid out side by side; while non-empty the view draws it instead
+  // of the model.
+  const Scene *scene() const { return &scene_; }
+  bool IsLoading() const;
+  // Streaming loads show the geometry parsed so far as a model preview and
+  // emit ModelChanged as batches arrive. A failed or cancelled streaming
+  // load leaves an empty model instead of the previous one.
+  void SetStreamingLoad(bool enabled) { streaming_ = enabled; }
+  bool IsStreamingLoad() const { return streaming_; }
+
+  // Per-stage timers and counters of the whole viewer (see Profiler); off
+  // by default.
+  void SetProfilingEnabled(bool enabled);
+  bool IsProfilingEnabled() const;
+  ProfilerStats PerfStats() const;
+  void ResetPerfStats();
+  // Chrome trace-event JSON; throws std::runtime_error on I/O errors.
+  void WritePerfTrace(const QString &path) const;
+
+  // Geometry replaced by a load is kept in an in-memory LRU cache (see
+  // MeshCache), so reopening an unchanged file swaps it back without
+  // parsing. Bytes; 0 disables the cache.
+  void SetCacheBudget(size_t bytes);
+  MeshCacheStats CacheStats() const;
+
+  // Picking at (x, y) in normalized device coordinates of the view; radius
+  // is in the same units (see Model::pickVertex).
+  PickResult PickVertex(float x, float y, float radius) const;
+  PickResult PickEdge(float x, float y, float radius) const;
+  PickResult Raycast(float x, float y) const;
+  // Vertex nearest to a point in view space (see Model::nearestVertex).
+  PickResult NearestVertex(const Vertex &point, float maxDistance) const;
+
+  // Transform slots below only record the requested state and emit one
+  // ModelChanged per frame (see TransformCoalescer). The view calls
+  // BeginFrame() before drawing, to apply the latest state to the model,
+  // and FramePresented() once the frame is on screen, which records the
+  // input-to-present latency as Stage::kInput.
+  void BeginFrame();
+  void FramePresented();
 
  public slots:
+  // Parses on a background thread and swaps the result into the model on
+  // the GUI thread. Starting a new load cancels the one in progress.
   void LoadModel(const QString &path);
+  void CancelLoad();
 
   void Translate(float dx, float dy, float dz);
   void RotateX(float rad);
@@ -24,13 +77,53 @@ class Controller : public QObject {
   void SetTranslateAbs(float tx, float ty, float tz);
   void SetRotateAbs(float rx, float ry, float rz);
   void SetScaleAbs(float s);
+  // Draw a fixed level of detail (0 = full mesh), or -1 to pick by size.
+  void SetForcedLod(int level);
+  // Group visibility (see Model::groups()); only changes what is drawn.
+  void SetGroupVisible(size_t group, bool visible);
+  // Shows `group` alone, or every group for -1.
+  void IsolateGroup(int group);
+
+  // Adds an instance of the file to the scene and lays the scene out on a
+  // grid. A file whose contents are already in the scene is not parsed
+  // again. Unlike LoadModel(), new geometry is loaded on the GUI thread.
+  void AddToScene(const QString &path);
+  // Adds another instance of the last one added.
+  void DuplicateInScene();
+  void ClearScene();
 
  signals:
   void ModelLoaded(size_t vertices, size_t edges);
   void ModelLoadError(const QString &message);
+  // Bytes parsed so far; emitted from the loader thread about once per
+  // percent.
+  void ModelLoadProgress(qint64 done, qint64 total);
+  void ModelLoadCancelled();
   void ModelChanged();
+  // Instances were added or removed.
+  void SceneChanged(size_t instances, size_t geometries);
 
  private:
+  struct LoadJob;
+
+  void PostTransform(const std::function<void(Transform &)> &edit);
+  // Moves the model's geometry into cache_, if it came from a file.
+  void StashModel();
+  void ShowMesh(Mesh mesh, const std::string &path,
+                const std::optional<FileStamp> &stamp);
+  void OnLoadBatch(const std::shared_ptr<LoadJob> &job);
+  void OnLoadFinished(const std::shared_ptr<LoadJob> &job);
+  void DropPreview(LoadJob &job);
+
   Model *model_;
+  Scene scene_;
+  TransformCoalescer coalescer_;
+  MeshCache cache_;
+  // Stamp of the model's file when its geometry was loaded.
+  std::optional<FileStamp> modelStamp_;
+  // The current load and cancelled ones still winding down. Declared after
+  // the members the loader threads use, so it joins them first.
+  BackgroundJobs<LoadJob> jobs_;
+  bool streaming_ = false;
 };
 }  // namespace s21
@@ -3,7 +3,9 @@
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QShortcut>
 #include <QSlider>
+#include <QStatusBar>
 #include <cmath>
 
 #include "Controller/controller.h"
@@ -58,6 +60,7 @@ MainWindow::MainWindow(Controller *controller, QWidget *parent)
   }
 
   ui->openGLWidget->setModel(controller_->model());
+  ui->openGLWidget->setScene(controller_->scene());
 
   connect(ui->pushButtonOpenObj, &QPushButton::clicked, this,
           &MainWindow::OnOpenClicked);
@@ -66,8 +69,53 @@ MainWindow::MainWindow(Controller *controller, QWidget *parent)
           &MainWindow::OnModelLoaded);
   connect(controller_, &Controller::ModelLoadError, this,
           &MainWindow::OnModelError);
+  connect(controller_, &Controller::ModelLoadProgress, this,
+          &MainWindow::OnLoadProgress);
+  connect(controller_, &Controller::ModelLoadCancelled, this,
+          &MainWindow::OnLoadCancelled);
   connect(controller_, &Controller::ModelChanged, ui->openGLWidget,
           QOverload<>::of(&QOpenGLWidget::update));
+  connect(controller_, &Controller::SceneChanged, this,
+          &MainWindow::OnSceneChanged);
+  // Slider drags are applied once per frame; see Controller::BeginFrame.
+  connect(ui->openGLWidget, &WireframeWidget::frameStarted, controller_,
+          &Controller::BeginFrame, Qt::DirectConnection);
+  connect(ui->openGLWidget, &QOpenGLWidget::frameSwapped, controller_,
+          &Controller::FramePresented);
+
+  // Click: pick the vertex, edge or face under the cursor. The marker is
+  // placed on screen, so any change of the model hides it.
+  connect(ui->openGLWidget, &WireframeWidget::clicked, this,
+          &MainWindow::OnViewClicked);
+  connect(controller_, &Controller::ModelChanged, ui->openGLWidget,
+          [this] { ui->openGLWidget->setMarker(false); });
+
+  // F3: profiler and stats overlay; F4: cycle forced levels of detail;
+  // F5: toggle culling; F6: show the next OBJ group alone, Shift+F6: show
+  // every group; Ctrl+Shift+T: save a Chrome trace.
+  // Ctrl+Shift+O / D / X: add a part to the scene, duplicate the last one,
+  // clear the scene.
+  connect(new QShortcut(QKeySequence(Qt::Key_F3), this),
+          &QShortcut::activated, this, &MainWindow::OnToggleStats);
+  connect(new QShortcut(QKeySequence(Qt::Key_F4), this),
+          &QShortcut::activated, this, &MainWindow::OnCycleLod);
+  connect(new QShortcut(QKeySequence(Qt::Key_F5), this),
+          &QShortcut::activated, this, &MainWindow::OnToggleCulling);
+  connect(new QShortcut(QKeySequence(Qt::Key_F6), this),
+          &QShortcut::activated, this, &MainWindow::OnCycleGroup);
+  connect(new QShortcut(QKeySequence("Shift+F6"), this),
+          &QShortcut::activated, this, [this] {
+            isolatedGroup_ = -1;
+            controller_->IsolateGroup(-1);
+          });
+  connect(new QShortcut(QKeySequence("Ctrl+Shift+T"), this),
+          &QShortcut::activated, this, &MainWindow::OnSaveTrace);
+  connect(new QShortcut(QKeySequence("Ctrl+Shift+O"), this),
+          &QShortcut::activated, this, &MainWindow::OnAddToScene);
+  connect(new QShortcut(QKeySequence("Ctrl+Shift+D"), this),
+          &QShortcut::activated, controller_, &Controller::DuplicateInScene);
+  connect(new QShortcut(QKeySequence("Ctrl+Shift+X"), this),
+          &QShortcut::activated, controller_, &Controller::ClearScene);
 
   auto applyTranslate = [this] {
     const float tx =
@@ -121,8 +169,11 @@ void MainWindow::OnOpenClicked() {
       QFileDialog::getOpenFileName(this, "Open OBJ", {}, "OBJ Files (*.obj)");
   if (file.isEmpty()) return;
   ui->label->setText(QFileInfo(file).fileName());
+  statusBar()->showMessage("Loading...");
   controller_->LoadModel(file);
+}
 
+void MainWindow::ResetSliders() {
   auto reset = [](QSlider *s, int v) {
     if (!s) return;
     s->blockSignals(true);
@@ -139,12 +190,140 @@ void MainWindow::OnOpenClicked() {
 }
 
 void MainWindow::OnModelLoaded(size_t v, size_t e) {
+  const MeshCacheStats cache = controller_->CacheStats();
+  statusBar()->showMessage(
+      QString("Memory cache: %1 models, %2 of %3 MB, %4 hits, %5 misses")
+          .arg(cache.entries)
+          .arg(cache.bytes / 1048576.0, 0, 'f', 1)
+          .arg(cache.budgetBytes / 1048576.0, 0, 'f', 0)
+          .arg(cache.hits)
+          .arg(cache.misses),
+      3000);
+  ResetSliders();
+  isolatedGroup_ = -1;
   ui->label_11->setText(QString::number(v));
   ui->label_12->setText(QString::number(e));
 }
 
 void MainWindow::OnModelError(const QString &msg) {
+  statusBar()->clearMessage();
   QMessageBox::warning(this, "Load error", msg);
 }
 
+void MainWindow::OnLoadProgress(qint64 done, qint64 total) {
+  const qint64 percent = total > 0 ? done * 100 / total : 100;
+  statusBar()->showMessage(QString("Loading... %1%").arg(percent));
+}
+
+void MainWindow::OnLoadCancelled() { statusBar()->clearMessage(); }
+
+void MainWindow::OnToggleStats() {
+  const bool on = !ui->openGLWidget->statsOverlayVisible();
+  if (on) controller_->ResetPerfStats();
+  controller_->SetProfilingEnabled(on);
+  ui->openGLWidget->setStatsOverlayVisible(on);
+}
+
+void MainWindow::OnCycleLod() {
+  // auto -> 0 -> 1 -> ... -> coarsest -> auto
+  const Model *model = controller_->model();
+  int level = model->forcedLod() + 1;
+  if (level >= static_cast<int>(model->lodCount())) level = -1;
+  controller_->SetForcedLod(level);
+  statusBar()->showMessage(
+      level < 0 ? QString("Level of detail: auto")
+                : QString("Level of detail: %1 of %2")
+                      .arg(level)
+                      .arg(model->lodCount() - 1),
+      2000);
+}
+
+void MainWindow::OnToggleCulling() {
+  const bool on = !ui->openGLWidget->cullingEnabled();
+  ui->openGLWidget->setCullingEnabled(on);
+  statusBar()->showMessage(on ? "Culling: on" : "Culling: off", 2000);
+}
+
+void MainWindow::OnCycleGroup() {
+  // all -> 0 -> 1 -> ... -> last -> all
+  const auto &groups = controller_->model()->groups();
+  if (groups.empty()) {
+    statusBar()->showMessage("No groups in this model", 2000);
+    return;
+  }
+  if (++isolatedGroup_ >= static_cast<int>(groups.size())) isolatedGroup_ = -1;
+  controller_->IsolateGroup(isolatedGroup_);
+  if (isolatedGroup_ < 0) {
+    statusBar()->showMessage("Groups: all", 2000);
+    return;
+  }
+  const FaceGroup &g = groups[isolatedGroup_];
+  statusBar()->showMessage(QString("Group %1 of %2: %3 %4 %5")
+                               .arg(isolatedGroup_ + 1)
+                               .arg(groups.size())
+                               .arg(QString::fromStdString(g.object))
+                               .arg(QString::fromStdString(g.group))
+                               .arg(QString::fromStdString(g.material)),
+                           2000);
+}
+
+void MainWindow::OnSaveTrace() {
+  QString file = QFileDialog::getSaveFileName(this, "Save trace", QString(),
+                                              "Trace files (*.json)");
+  if (file.isEmpty()) return;
+  try {
+    controller_->WritePerfTrace(file);
+  } catch (const std::exception &e) {
+    QMessageBox::warning(this, "Save error", QString::fromUtf8(e.what()));
+  }
+}
+
+void MainWindow::OnViewClicked(float x, float y, float radius) {
+  Model *model = controller_->model();
+  WireframeWidget *view = ui->openGLWidget;
+  if (const PickResult hit = controller_->PickVertex(x, y, radius);
+      hit.found) {
+    const Vertex &v = model->getOriginalVertices()[hit.index];
+    const auto &m = model->transformMatrix();
+    view->setMarker(true,
+                    m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3],
+                    m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3]);
+    statusBar()->showMessage(QString("Vertex %1: (%2, %3, %4)")
+                                 .arg(hit.index + 1)
+                                 .arg(v.x)
+                                 .arg(v.y)
+                                 .arg(v.z));
+    return;
+  }
+  view->setMarker(true, x, y);
+  if (const PickResult hit = controller_->PickEdge(x, y, radius); hit.found) {
+    const Edge &e = model->getEdges()[hit.index];
+    statusBar()->showMessage(
+        QString("Edge %1: %2-%3").arg(hit.index + 1).arg(e.a + 1).arg(e.b + 1));
+  } else if (const PickResult face = controller_->Raycast(x, y); face.found) {
+    statusBar()->showMessage(QString("Face %1").arg(face.index + 1));
+  } else {
+    view->setMarker(false);
+    statusBar()->clearMessage();
+  }
+}
+
+void MainWindow::OnAddToScene() {
+  const QString file = QFileDialog::getOpenFileName(this, "Add to scene", {},
+                                                    "OBJ Files (*.obj)");
+  if (file.isEmpty()) return;
+  controller_->AddToScene(file);
+}
+
+void MainWindow::OnSceneChanged(size_t instances, size_t geometries) {
+  ui->openGLWidget->update();
+  if (instances == 0) {
+    statusBar()->showMessage("Scene cleared", 2000);
+    return;
+  }
+  statusBar()->showMessage(QString("Scene: %1 instances of %2 parts")
+                               .arg(instances)
+                               .arg(geometries));
+}
+
 }  // namespace s21
@@ -25,6 +25,16 @@ class MainWindow : public QMainWindow {
   void OnOpenClicked();
   void OnModelLoaded(size_t v, size_t e);
   void OnModelError(const QString &msg);
+  void OnLoadProgress(qint64 done, qint64 total);
+  void OnLoadCancelled();
+  void OnToggleStats();
+  void OnCycleLod();
+  void OnToggleCulling();
+  void OnCycleGroup();
+  void OnSaveTrace();
+  void OnViewClicked(float x, float y, float radius);
+  void OnAddToScene();
+  void OnSceneChanged(size_t instances, size_t geometries);
 
  private:
   void InitSlider(QSlider *s);
@@ -32,11 +42,14 @@ class MainWindow : public QMainWindow {
   void OnRotateChanged(QSlider *s, void (s21::Controller::*rotFn)(float),
                        int value);
   void OnScaleChanged(int value);
+  void ResetSliders();
 
  private:
   Ui::MainWindow *ui = nullptr;
   s21::Controller *controller_ = nullptr;
   s21::WireframeWidget *glview_ = nullptr;
+  // Group shown alone by OnCycleGroup(), -1 for all.
+  int isolatedGroup_ = -1;
 };
 
 }  // namespace s21
@@ -0,0 +1,479 @@
+#include "wireframeRenderer.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace s21 {
+
+namespace {
+
+constexpr int kPositionLocation = 0;
+
+const char *kVertexShader = R"(
+#version 120
+attribute vec3 position;
+uniform mat4 mvp;
+void main() { gl_Position = mvp * vec4(position, 1.0); }
+)";
+
+const char *kFragmentShader = R"(
+#version 120
+uniform vec4 color;
+void main() { gl_FragColor = color; }
+)";
+
+QMatrix4x4 Projection() {
+  QMatrix4x4 projection;
+  projection.ortho(-1, 1, -1, 1, -10, 10);
+  return projection;
+}
+
+}  // namespace
+
+WireframeRenderer::WireframeRenderer()
+    : vertexBuffer_(QOpenGLBuffer::VertexBuffer),
+      indexBuffer_(QOpenGLBuffer::IndexBuffer) {}
+
+void WireframeRenderer::initialize() {
+  initializeOpenGLFunctions();
+
+  retainedSupported_ =
+      program_.addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader) &&
+      program_.addShaderFromSourceCode(QOpenGLShader::Fragment,
+                                       kFragmentShader);
+  if (retainedSupported_) {
+    program_.bindAttributeLocation("position", kPositionLocation);
+    retainedSupported_ = program_.link();
+  }
+  if (retainedSupported_)
+    retainedSupported_ = vertexBuffer_.create() && indexBuffer_.create();
+
+  uploadedModel_ = nullptr;
+}
+
+void WireframeRenderer::release() {
+  vertexBuffer_.destroy();
+  indexBuffer_.destroy();
+  releaseSceneBuffers();
+  program_.removeAllShaders();
+  retainedSupported_ = false;
+  uploadedModel_ = nullptr;
+  uploadedScene_ = nullptr;
+}
+
+void WireframeRenderer::setMode(Mode mode) { mode_ = mode; }
+
+WireframeRenderer::Mode WireframeRenderer::mode() const {
+  return retainedSupported_ ? mode_ : Mode::kImmediate;
+}
+
+bool WireframeRenderer::retainedSupported() const {
+  return retainedSupported_;
+}
+
+void WireframeRenderer::setCullingEnabled(bool enabled) {
+  culling_ = enabled;
+}
+
+void WireframeRenderer::render(Model &model) {
+  if (mode() == Mode::kRetained)
+    renderRetained(model);
+  else
+    renderImmediate(model);
+}
+
+void WireframeRenderer::render(const Scene &scene) {
+  updatePixelsPerUnit();
+  lastCull_ = CullStats{};
+  lastEdgeCount_ = 0;
+  lastLevel_ = 0;
+  if (mode() == Mode::kRetained)
+    renderSceneRetained(scene);
+  else
+    renderSceneImmediate(scene);
+  lastEdgeCount_ = lastCull_.drawnEdges;
+}
+
+void WireframeRenderer::updatePixelsPerUnit() {
+  GLint viewport[4] = {0, 0, 0, 0};
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  // The ortho volume spans 2 units across each axis; the larger axis gives
+  // the finer (safer) level for non-square views.
+  pixelsPerUnit_ = std::max(viewport[2], viewport[3]) * 0.5f;
+}
+
+size_t WireframeRenderer::selectLevel(const Model &model) {
+  updatePixelsPerUnit();
+  lastLevel_ = model.selectLod(pixelsPerUnit_);
+  return lastLevel_;
+}
+
+const std::vector<EdgeClusters::Range> &WireframeRenderer::visibleRanges(
+    Model &model, size_t level) {
+  const auto edges = static_cast<unsigned>(model.getLodEdges(level).size());
+  lastCull_ = CullStats{};
+  // Hidden groups pin the full mesh, whose upload keeps group ranges; with
+  // all groups shown the ranges still leave out edges shared by groups.
+  const std::vector<EdgeClusters::Range> *groups =
+      level == 0 && !model.groups().empty() ? &model.visibleEdgeRanges()
+                                            : nullptr;
+  if (culling_ && !model.isPreview()) {
+    lastCull_ = model.edgeClusters(level).cull(
+        model.transformMatrix(), pixelsPerUnit_, ranges_, groups);
+  } else if (groups) {
+    ranges_ = *groups;
+    for (const EdgeClusters::Range &r : ranges_) lastCull_.edges += r.count;
+    lastCull_.drawnEdges = lastCull_.edges;
+  } else {
+    ranges_.assign(1, EdgeClusters::Range{0, edges});
+    lastCull_.edges = lastCull_.drawnEdges = edges;
+  }
+  lastEdgeCount_ = lastCull_.drawnEdges;
+  return ranges_;
+}
+
+void WireframeRenderer::upload(Model &model) {
+  size_t vertexCount = 0, edgeCount = 0;
+  for (size_t level = 0; level < model.lodCount(); ++level) {
+    vertexCount += level == 0 ? model.vertexCount()
+                              : model.getLodOriginalVertices(level).size();
+    edgeCount += model.getLodEdges(level).size();
+  }
+
+  std::vector<Vertex> vertices;
+  std::vector<unsigned> indices;
+  vertices.reserve(vertexCount);
+  indices.reserve(edgeCount * 2);
+  levels_.clear();
+  uploadedClustered_ = culling_ && !model.isPreview();
+  for (size_t level = 0; level < model.lodCount(); ++level) {
+    const auto base = static_cast<unsigned>(vertices.size());
+    model.appendLodOriginalVertices(level, vertices);
+    LevelRange range;
+    range.firstIndex = static_cast<GLsizei>(indices.size());
+    const auto &edges = model.getLodEdges(level);
+    auto push = [&](const Edge &e) {
+      indices.push_back(base + e.a);
+      indices.push_back(base + e.b);
+    };
+    if (uploadedClustered_) {
+      for (unsigned i : model.edgeClusters(level).order()) push(edges[i]);
+    } else {
+      for (const Edge &e : edges) push(e);
+    }
+    range.indexCount = static_cast<GLsizei>(indices.size()) - range.firstIndex;
+    levels_.push_back(range);
+  }
+
+  // Previews keep room to grow and 32-bit indices for the vertices to come.
+  const bool preview = model.isPreview();
+  uploadedVertices_ = vertices.size();
+  uploadedEdges_ = indices.size() / 2;
+  vertexCapacity_ = preview ? uploadedVertices_ * 2 : uploadedVertices_;
+  edgeCapacity_ = preview ? uploadedEdges_ * 2 : uploadedEdges_;
+
+  vertexBuffer_.bind();
+  vertexBuffer_.setUsagePattern(preview ? QOpenGLBuffer::DynamicDraw
+                                        : QOpenGLBuffer::StaticDraw);
+  if (preview) {
+    vertexBuffer_.allocate(static_cast<int>(vertexCapacity_ * sizeof(Vertex)));
+    vertexBuffer_.write(0, vertices.data(),
+                        static_cast<int>(vertices.size() * sizeof(Vertex)));
+  } else {
+    vertexBuffer_.allocate(vertices.data(),
+                           static_cast<int>(vertices.size() * sizeof(Vertex)));
+  }
+  vertexBuffer_.release();
+
+  indexBuffer_.bind();
+  indexBuffer_.setUsagePattern(preview ? QOpenGLBuffer::DynamicDraw
+                                       : QOpenGLBuffer::StaticDraw);
+  indexType_ = !preview && model.vertexLayout() == VertexLayout::kQuantized &&
+                       vertexCount <= 0x10000
+                   ? GL_UNSIGNED_SHORT
+                   : GL_UNSIGNED_INT;
+  if (preview) {
+    indexBuffer_.allocate(
+        static_cast<int>(edgeCapacity_ * 2 * sizeof(unsigned)));
+    indexBuffer_.write(0, indices.data(),
+                       static_cast<int>(indices.size() * sizeof(unsigned)));
+  } else if (indexType_ == GL_UNSIGNED_SHORT) {
+    const std::vector<uint16_t> narrow(indices.begin(), indices.end());
+    indexBuffer_.allocate(narrow.data(),
+                          static_cast<int>(narrow.size() * sizeof(uint16_t)));
+  } else {
+    indexBuffer_.allocate(indices.data(),
+                          static_cast<int>(indices.size() * sizeof(unsigned)));
+  }
+  indexBuffer_.release();
+
+  uploadedModel_ = &model;
+  uploadedVersion_ = model.geometryVersion();
+  uploadedPreviewVersion_ = model.previewVersion();
+  ++uploadCount_;
+}
+
+void WireframeRenderer::appendPreview(Model &model) {
+  // A preview has no levels of detail and is never compact, so level 0 is
+  // the whole buffer and its vertices are the mesh's.
+  const std::vector<Vertex> &vertices = model.getLodOriginalVertices(0);
+  const std::vector<Edge> &edges = model.getLodEdges(0);
+  if (vertices.size() > vertexCapacity_ || edges.size() > edgeCapacity_) {
+    upload(model);
+    return;
+  }
+
+  if (vertices.size() > uploadedVertices_) {
+    vertexBuffer_.bind();
+    vertexBuffer_.write(
+        static_cast<int>(uploadedVertices_ * sizeof(Vertex)),
+        vertices.data() + uploadedVertices_,
+        static_cast<int>((vertices.size() - uploadedVertices_) *
+                         sizeof(Vertex)));
+    vertexBuffer_.release();
+  }
+  if (edges.size() > uploadedEdges_) {
+    std::vector<unsigned> indices;
+    indices.reserve((edges.size() - uploadedEdges_) * 2);
+    for (size_t i = uploadedEdges_; i < edges.size(); ++i) {
+      indices.push_back(edges[i].a);
+      indices.push_back(edges[i].b);
+    }
+    indexBuffer_.bind();
+    indexBuffer_.write(
+        static_cast<int>(uploadedEdges_ * 2 * sizeof(unsigned)),
+        indices.data(), static_cast<int>(indices.size() * sizeof(unsigned)));
+    indexBuffer_.release();
+  }
+
+  uploadedVertices_ = vertices.size();
+  uploadedEdges_ = edges.size();
+  levels_.assign(1, LevelRange{0, static_cast<GLsizei>(edges.size() * 2)});
+  uploadedPreviewVersion_ = model.previewVersion();
+}
+
+void WireframeRenderer::renderRetained(Model &model) {
+  if (uploadedModel_ != &model ||
+      uploadedVersion_ != model.geometryVersion() ||
+      uploadedClustered_ != (culling_ && !model.isPreview()))
+    upload(model);
+  else if (uploadedPreviewVersion_ != model.previewVersion())
+    appendPreview(model);
+  const size_t level = selectLevel(model);
+  const LevelRange range = levels_[level];
+  const auto &ranges = visibleRanges(model, level);
+  if (lastEdgeCount_ == 0) return;
+
+  const auto &m = model.transformMatrix();
+  const QMatrix4x4 modelMatrix(&m[0][0]);
+
+  program_.bind();
+  program_.setUniformValue("mvp", Projection() * modelMatrix);
+  program_.setUniformValue("color", QVector4D(0.9f, 0.9f, 0.9f, 1.0f));
+
+  vertexBuffer_.bind();
+  program_.enableAttributeArray(kPositionLocation);
+  program_.setAttributeBuffer(kPositionLocation, GL_FLOAT, 0, 3,
+                              sizeof(Vertex));
+  indexBuffer_.bind();
+
+  glLineWidth(1.0f);
+  const size_t indexSize =
+      indexType_ == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned);
+  for (const EdgeClusters::Range &r : ranges) {
+    const size_t first = range.firstIndex + r.first * 2;
+    glDrawElements(GL_LINES, static_cast<GLsizei>(r.count * 2), indexType_,
+                   reinterpret_cast<const void *>(first * indexSize));
+  }
+
+  indexBuffer_.release();
+  program_.disableAttributeArray(kPositionLocation);
+  vertexBuffer_.release();
+  program_.release();
+}
+
+void WireframeRenderer::renderImmediate(Model &model) {
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glOrtho(-1, 1, -1, 1, -10, 10);
+
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+
+  const size_t level = selectLevel(model);
+  const auto &ranges = visibleRanges(model, level);
+  const std::vector<unsigned> *order =
+      culling_ && !model.isPreview() ? &model.edgeClusters(level).order()
+                                     : nullptr;
+  const auto &verts = model.getLodVertices(level);
+  const auto &edges = model.getLodEdges(level);
+
+  glColor3f(0.9f, 0.9f, 0.9f);
+  glLineWidth(1.0f);
+
+  glBegin(GL_LINES);
+  for (const EdgeClusters::Range &r : ranges) {
+    for (unsigned i = r.first; i < r.first + r.count; ++i) {
+      const Edge &e = edges[order ? (*order)[i] : i];
+      const auto &va = verts[e.a];
+      const auto &vb = verts[e.b];
+      glVertex3f(va.x, va.y, va.z);
+      glVertex3f(vb.x, vb.y, vb.z);
+    }
+  }
+  glEnd();
+}
+
+void WireframeRenderer::syncSceneBuffers(const Scene &scene) {
+  if (uploadedScene_ == &scene && uploadedSceneVersion_ == scene.version())
+    return;
+  // Keep the buffers of geometry still in the scene, upload new geometry
+  // and free the rest. Entries own their geometry, so keys stay unique.
+  std::unordered_map<const SceneGeometry *, GeometryBuffers> kept;
+  for (size_t i = 0; i < scene.size(); ++i) {
+    const auto &geometry = scene.instance(i).geometry;
+    if (kept.count(geometry.get())) continue;
+    if (auto it = sceneBuffers_.find(geometry.get());
+        it != sceneBuffers_.end()) {
+      kept.emplace(geometry.get(), std::move(it->second));
+      sceneBuffers_.erase(it);
+      continue;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned> indices;
+    GeometryBuffers buffers;
+    buffers.geometry = geometry;
+    for (size_t level = 0; level < geometry->levelCount(); ++level) {
+      const auto base = static_cast<unsigned>(vertices.size());
+      const auto &verts = geometry->vertices(level);
+      vertices.insert(vertices.end(), verts.begin(), verts.end());
+      LevelRange range;
+      range.firstIndex = static_cast<GLsizei>(indices.size());
+      const auto &edges = geometry->edges(level);
+      for (unsigned i : geometry->clusters(level).order()) {
+        indices.push_back(base + edges[i].a);
+        indices.push_back(base + edges[i].b);
+      }
+      range.indexCount =
+          static_cast<GLsizei>(indices.size()) - range.firstIndex;
+      buffers.levels.push_back(range);
+    }
+    if (!buffers.vertices.create() || !buffers.indices.create()) {
+      buffers.vertices.destroy();
+      buffers.indices.destroy();
+      continue;
+    }
+    buffers.vertices.bind();
+    buffers.vertices.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buffers.vertices.allocate(
+        vertices.data(), static_cast<int>(vertices.size() * sizeof(Vertex)));
+    buffers.vertices.release();
+    buffers.indices.bind();
+    buffers.indices.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buffers.indices.allocate(
+        indices.data(), static_cast<int>(indices.size() * sizeof(unsigned)));
+    buffers.indices.release();
+    kept.emplace(geometry.get(), std::move(buffers));
+  }
+  releaseSceneBuffers();
+  sceneBuffers_ = std::move(kept);
+  uploadedScene_ = &scene;
+  uploadedSceneVersion_ = scene.version();
+}
+
+void WireframeRenderer::releaseSceneBuffers() {
+  for (auto &[geometry, buffers] : sceneBuffers_) {
+    buffers.vertices.destroy();
+    buffers.indices.destroy();
+  }
+  sceneBuffers_.clear();
+}
+
+void WireframeRenderer::renderSceneRetained(const Scene &scene) {
+  syncSceneBuffers(scene);
+  const QMatrix4x4 projection = Projection();
+  size_t finest = SIZE_MAX;
+  CullStats stats;
+
+  program_.bind();
+  program_.setUniformValue("color", QVector4D(0.9f, 0.9f, 0.9f, 1.0f));
+  glLineWidth(1.0f);
+  for (const Scene::Batch &batch : scene.batches()) {
+    auto it = sceneBuffers_.find(batch.geometry);
+    if (it == sceneBuffers_.end()) continue;
+    GeometryBuffers &buffers = it->second;
+    bool bound = false;
+    for (size_t index : batch.instances) {
+      if (!scene.inView(index)) continue;
+      const size_t level = scene.cull(index, pixelsPerUnit_, ranges_, stats);
+      lastCull_ += stats;
+      if (stats.drawnEdges == 0) continue;
+      if (!bound) {
+        buffers.vertices.bind();
+        program_.enableAttributeArray(kPositionLocation);
+        program_.setAttributeBuffer(kPositionLocation, GL_FLOAT, 0, 3,
+                                    sizeof(Vertex));
+        buffers.indices.bind();
+        bound = true;
+      }
+      const auto m = scene.matrix(index);
+      program_.setUniformValue("mvp", projection * QMatrix4x4(&m[0][0]));
+      for (const EdgeClusters::Range &r : ranges_) {
+        const size_t first = buffers.levels[level].firstIndex + r.first * 2;
+        glDrawElements(
+            GL_LINES, static_cast<GLsizei>(r.count * 2), GL_UNSIGNED_INT,
+            reinterpret_cast<const void *>(first * sizeof(unsigned)));
+      }
+      finest = std::min(finest, level);
+    }
+    if (bound) {
+      buffers.indices.release();
+      program_.disableAttributeArray(kPositionLocation);
+      buffers.vertices.release();
+    }
+  }
+  program_.release();
+  lastLevel_ = finest == SIZE_MAX ? 0 : finest;
+}
+
+void WireframeRenderer::renderSceneImmediate(const Scene &scene) {
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glOrtho(-1, 1, -1, 1, -10, 10);
+  glMatrixMode(GL_MODELVIEW);
+
+  glColor3f(0.9f, 0.9f, 0.9f);
+  glLineWidth(1.0f);
+  size_t finest = SIZE_MAX;
+  CullStats stats;
+  for (const Scene::Batch &batch : scene.batches()) {
+    for (size_t index : batch.instances) {
+      if (!scene.inView(index)) continue;
+      const size_t level = scene.cull(index, pixelsPerUnit_, ranges_, stats);
+      lastCull_ += stats;
+      const auto &verts = batch.geometry->vertices(level);
+      const auto &edges = batch.geometry->edges(level);
+      const auto &order = batch.geometry->clusters(level).order();
+      // The fixed-function pipeline applies the model matrix.
+      const auto m = scene.matrix(index);
+      glLoadMatrixf(QMatrix4x4(&m[0][0]).constData());
+      glBegin(GL_LINES);
+      for (const EdgeClusters::Range &r : ranges_) {
+        for (unsigned i = r.first; i < r.first + r.count; ++i) {
+          const Edge &e = edges[order[i]];
+          const auto &va = verts[e.a];
+          const auto &vb = verts[e.b];
+          glVertex3f(va.x, va.y, va.z);
+          glVertex3f(vb.x, vb.y, vb.z);
+        }
+      }
+      glEnd();
+      finest = std::min(finest, level);
+    }
+  }
+  glLoadIdentity();
+  lastLevel_ = finest == SIZE_MAX ? 0 : finest;
+}
+
+}  // namespace s21
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QVector4D>
+#include <memory>
+#include <unordered_map>
+
+#include "model/model.h"
+#include "model/scene.h"
+
+namespace s21 {
+
+// Draws a Model's edges into the current OpenGL context. Independent of
+// QOpenGLWidget so it can also run in an offscreen QOpenGLContext.
+//
+// kRetained uploads the untransformed vertices and the edge index buffer
+// once per geometry version and applies the model transform as a matrix
+// uniform, so a transform change costs no per-vertex CPU work.
+// kImmediate is the fixed-function glBegin/glEnd path on CPU-transformed
+// vertices, used as a fallback when shaders are unavailable.
+//
+// A streaming preview only grows, so its batches are appended to the
+// uploaded buffers in place. Preview buffers are allocated with twice the
+// room they need; a batch that does not fit reallocates them at twice the
+// new size, so a load of n edges copies O(n) data to the GPU overall.
+//
+// Both paths draw the level of detail Model::selectLod() picks for the
+// current viewport. Retained mode uploads every level into the same
+// buffers, so switching levels while zooming costs no upload.
+//
+// With culling on, edges are uploaded and drawn in EdgeClusters order:
+// clusters outside the view volume are skipped and clusters of sub-pixel
+// edges are thinned, at the cost of one draw call per run of visible
+// clusters.
+//
+// Hidden model groups (Model::setGroupVisible()) only shrink the list of
+// index ranges drawn: clusters never straddle groups, nor a group's own
+// and shared edges, so both stay contiguous in either upload order and
+// nothing is uploaded again. With every group shown the shared copies are
+// left out and a boundary edge is drawn once; scene instances draw all
+// stored edges, copies included.
+//
+// Scenes are drawn batch by batch: each distinct geometry is uploaded once
+// with all of its levels and bound once per frame, and its instances differ
+// only in the matrix. Every instance is culled and thinned on its own (see
+// Scene::cull()). OpenGL 2.1 has no instanced draw calls, so an instance
+// still costs a matrix update and its draw calls, but no upload or
+// per-vertex CPU work.
+class WireframeRenderer : protected QOpenGLFunctions {
+ public:
+  enum class Mode { kRetained, kImmediate };
+
+  WireframeRenderer();
+
+  // Must be called with a current context, before the first render().
+  void initialize();
+  // Frees the GPU buffers; requires the context used for initialize().
+  void release();
+
+  void setMode(Mode mode);
+  Mode mode() const;
+  bool retainedSupported() const;
+  // On by default; previews are never culled.
+  void setCullingEnabled(bool enabled);
+  bool cullingEnabled() const { return culling_; }
+
+  // Draws with the same orthographic volume as glOrtho(-1,1,-1,1,-10,10).
+  void render(Model &model);
+  // Draws the visible instances of the scene that reach the view, each at
+  // its own level of detail. Transform changes cost no upload.
+  void render(const Scene &scene);
+  // Level and edge count of the last render() call; for scenes, the finest
+  // level drawn and the total.
+  size_t lastLevel() const { return lastLevel_; }
+  size_t lastEdgeCount() const { return lastEdgeCount_; }
+  // Culling of the last render() call; all zero when nothing was culled.
+  const CullStats &lastCull() const { return lastCull_; }
+  // Full uploads of a model's buffers in retained mode; appended preview
+  // batches do not count.
+  size_t uploadCount() const { return uploadCount_; }
+
+ private:
+  void upload(Model &model);
+  // Writes the vertices and edges the preview gained since the last upload
+  // behind the uploaded ones, or uploads everything when they do not fit.
+  void appendPreview(Model &model);
+  void renderRetained(Model &model);
+  void renderImmediate(Model &model);
+  size_t selectLevel(const Model &model);
+  // Ranges of the level's edges (in upload order) to draw this frame.
+  const std::vector<EdgeClusters::Range> &visibleRanges(Model &model,
+                                                        size_t level);
+
+  // Index range of one level of detail in indexBuffer_.
+  struct LevelRange {
+    GLsizei firstIndex = 0;
+    GLsizei indexCount = 0;
+  };
+  // GPU copy of one scene geometry, all levels in one pair of buffers.
+  struct GeometryBuffers {
+    std::shared_ptr<const SceneGeometry> geometry;
+    QOpenGLBuffer vertices{QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer indices{QOpenGLBuffer::IndexBuffer};
+    std::vector<LevelRange> levels;
+  };
+
+  void updatePixelsPerUnit();
+  void syncSceneBuffers(const Scene &scene);
+  void releaseSceneBuffers();
+  void renderSceneRetained(const Scene &scene);
+  void renderSceneImmediate(const Scene &scene);
+
+  QOpenGLShaderProgram program_;
+  QOpenGLBuffer vertexBuffer_;
+  QOpenGLBuffer indexBuffer_;
+  Mode mode_ = Mode::kRetained;
+  bool retainedSupported_ = false;
+  const Model *uploadedModel_ = nullptr;
+  unsigned long long uploadedVersion_ = 0;
+  // Preview batches in the buffers, and the vertices and edges they hold
+  // out of the room allocated for them.
+  unsigned long long uploadedPreviewVersion_ = 0;
+  size_t uploadedVertices_ = 0;
+  size_t uploadedEdges_ = 0;
+  size_t vertexCapacity_ = 0;
+  size_t edgeCapacity_ = 0;
+  std::vector<LevelRange> levels_;
+  // GL_UNSIGNED_SHORT when a VertexLayout::kQuantized model fits 16-bit
+  // indices, GL_UNSIGNED_INT otherwise.
+  GLenum indexType_ = GL_UNSIGNED_INT;
+  bool culling_ = true;
+  // Whether the uploaded levels are in cluster order.
+  bool uploadedClustered_ = false;
+  std::vector<EdgeClusters::Range> ranges_;
+  float pixelsPerUnit_ = 0.f;
+  size_t lastLevel_ = 0;
+  size_t lastEdgeCount_ = 0;
+  size_t uploadCount_ = 0;
+  CullStats lastCull_;
+  std::unordered_map<const SceneGeometry *, GeometryBuffers> sceneBuffers_;
+  const Scene *uploadedScene_ = nullptr;
+  unsigned long long uploadedSceneVersion_ = 0;
+};
+
+}  // namespace s21
@@ -1,52 +1,149 @@
 #include "wireframewidget.h"
 
+#include <algorithm>
+
+#include <QMouseEvent>
+#include <QOpenGLContext>
+#include <QPainter>
+
+#include "model/profiler.h"
+
 namespace s21 {
 
 WireframeWidget::WireframeWidget(QWidget* parent) : QOpenGLWidget(parent) {}
 
+WireframeWidget::~WireframeWidget() { releaseGL(); }
+
 void WireframeWidget::setModel(Model* m) {
   model_ = m;
   update();
 }
 
+void WireframeWidget::setScene(const Scene* scene) {
+  scene_ = scene;
+  update();
+}
+
+void WireframeWidget::setRenderMode(WireframeRenderer::Mode mode) {
+  renderer_.setMode(mode);
+  update();
+}
+
+void WireframeWidget::setCullingEnabled(bool enabled) {
+  renderer_.setCullingEnabled(enabled);
+  update();
+}
+
+void WireframeWidget::setStatsOverlayVisible(bool visible) {
+  statsOverlay_ = visible;
+  update();
+}
+
+void WireframeWidget::setMarker(bool visible, float x, float y) {
+  marker_ = visible;
+  markerX_ = x;
+  markerY_ = y;
+  update();
+}
+
 void WireframeWidget::initializeGL() {
   initializeOpenGLFunctions();
   glEnable(GL_DEPTH_TEST);
+  renderer_.initialize();
+  connect(context(), &QOpenGLContext::aboutToBeDestroyed, this,
+          &WireframeWidget::releaseGL, Qt::DirectConnection);
+}
+
+void WireframeWidget::releaseGL() {
+  if (!context()) return;
+  makeCurrent();
+  renderer_.release();
+  doneCurrent();
 }
 
 void WireframeWidget::resizeGL(int w, int h) { glViewport(0, 0, w, h); }
 
 void WireframeWidget::paintGL() {
-  glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-  if (!model_) return;
-  glMatrixMode(GL_PROJECTION);
-  glLoadIdentity();
-  glOrtho(-1, 1, -1, 1, -10, 10);
-
-  glMatrixMode(GL_MODELVIEW);
-  glLoadIdentity();
-
-  const auto& verts = model_->getVertices();
-  const auto& polys = model_->getPolygons();
-
-  glColor3f(0.9f, 0.9f, 0.9f);
-  glLineWidth(1.0f);
-
-  for (const auto& p : polys) {
-    if (p.vertexIndices.size() < 2) continue;
-    glBegin(GL_LINES);
-    for (size_t i = 0; i < p.vertexIndices.size(); ++i) {
-      unsigned a = p.vertexIndices[i];
-      unsigned b = p.vertexIndices[(i + 1) % p.vertexIndices.size()];
-      const auto& va = verts[a];
-      const auto& vb = verts[b];
-      glVertex3f(va.x, va.y, va.z);
-      glVertex3f(vb.x, vb.y, vb.z);
-    }
-    glEnd();
+  emit frameStarted();
+  {
+    ScopedTimer timer(Stage::kPaint);
+    // QPainter (stats overlay) may leave depth testing off.
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (drawsScene())
+      renderer_.render(*scene_);
+    else if (model_)
+      renderer_.render(*model_);
+  }
+  const bool drawn = drawsScene() || model_;
+  Profiler::instance().frame(drawn ? renderer_.lastEdgeCount() : 0);
+  if (drawn) Profiler::instance().recordCull(renderer_.lastCull());
+  if (marker_) drawMarker();
+  if (statsOverlay_) drawStatsOverlay();
+}
+
+void WireframeWidget::mousePressEvent(QMouseEvent* event) {
+  if (event->button() != Qt::LeftButton || width() <= 0 || height() <= 0) {
+    QOpenGLWidget::mousePressEvent(event);
+    return;
   }
+  // glOrtho(-1, 1) stretches over the whole viewport.
+  const QPointF pos = event->position();
+  const float x = 2.f * static_cast<float>(pos.x()) / width() - 1.f;
+  const float y = 1.f - 2.f * static_cast<float>(pos.y()) / height();
+  emit clicked(x, y, 2.f * kPickPixels / std::max(width(), height()));
+}
+
+void WireframeWidget::drawMarker() {
+  const QPointF center((markerX_ + 1.f) * 0.5f * width(),
+                       (1.f - markerY_) * 0.5f * height());
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(QPen(QColor(255, 170, 0), 2));
+  painter.drawEllipse(center, kPickPixels, kPickPixels);
+}
+
+void WireframeWidget::drawStatsOverlay() {
+  const ProfilerStats stats = Profiler::instance().stats();
+  QString text;
+  if (!Profiler::instance().enabled()) text += "profiler off\n";
+  text += QString("frame %1 ms (avg %2)\n")
+              .arg(stats.frameMs, 0, 'f', 2)
+              .arg(stats.averageFrameMs, 0, 'f', 2);
+  text += QString("edges/frame %1 (lod %2)\n")
+              .arg(stats.edgesPerFrame)
+              .arg(renderer_.lastLevel());
+  if (stats.cull.edges > 0) {
+    text += QString("culled %1 of %2 edges (%3 of %4 clusters out, %5 "
+                    "thinned)%6\n")
+                .arg(stats.cull.skippedEdges())
+                .arg(stats.cull.edges)
+                .arg(stats.cull.culledClusters)
+                .arg(stats.cull.clusters)
+                .arg(stats.cull.thinnedClusters)
+                .arg(renderer_.cullingEnabled() ? "" : " [off]");
+  }
+  text += QString("transform %1 Mvert/s\n")
+              .arg(stats.verticesPerSecond() * 1e-6, 0, 'f', 1);
+  text += QString("model %1 MB (peak %2)\n")
+              .arg(stats.modelBytes / 1048576.0, 0, 'f', 1)
+              .arg(stats.peakModelBytes / 1048576.0, 0, 'f', 1);
+  for (size_t i = 0; i < stats.stages.size(); ++i) {
+    const StageStats& s = stats.stages[i];
+    if (s.calls == 0) continue;
+    text += QString("%1: last %2 ms, avg %3 ms, n=%4\n")
+                .arg(Profiler::stageName(static_cast<Stage>(i)))
+                .arg(s.lastMs(), 0, 'f', 2)
+                .arg(s.averageMs(), 0, 'f', 2)
+                .arg(s.calls);
+  }
+
+  QPainter painter(this);
+  painter.setPen(Qt::green);
+  painter.setFont(QFont("monospace", 9));
+  painter.drawText(rect().adjusted(8, 8, -8, -8),
+                   Qt::AlignLeft | Qt::AlignTop, text);
 }
 
-}  // namespace s21
\ No newline at end of file
+}  // namespace s21
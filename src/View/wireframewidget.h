@@ -3,6 +3,7 @@
 #include <QOpenGLFunctions>
 #include <QOpenGLWidget>
 
+#include "View/wireframeRenderer.h"
 #include "model/model.h"
 
 namespace s21 {
@@ -12,15 +13,49 @@ class WireframeWidget : public QOpenGLWidget, protected QOpenGLFunctions {
 
  public:
   explicit WireframeWidget(QWidget *parent = nullptr);
+  ~WireframeWidget() override;
   void setModel(Model *m);
+  // A non-empty scene is drawn instead of the model.
+  void setScene(const Scene *scene);
+  // Immediate mode stays available as a fallback and for comparisons.
+  void setRenderMode(WireframeRenderer::Mode mode);
+  // View-volume and sub-pixel culling (WireframeRenderer); on by default.
+  void setCullingEnabled(bool enabled);
+  bool cullingEnabled() const { return renderer_.cullingEnabled(); }
+  // Draws the Profiler statistics over the model. The profiler has to be
+  // enabled separately.
+  void setStatsOverlayVisible(bool visible);
+  bool statsOverlayVisible() const { return statsOverlay_; }
+  // Ring drawn around a picked point, in normalized device coordinates.
+  void setMarker(bool visible, float x = 0.f, float y = 0.f);
+
+ signals:
+  // Left click at (x, y) in normalized device coordinates; radius covers
+  // kPickPixels in the same units.
+  void clicked(float x, float y, float radius);
+  // Emitted at the start of paintGL(), before the model is drawn.
+  void frameStarted();
 
  protected:
   void initializeGL() override;
   void resizeGL(int w, int h) override;
   void paintGL() override;
+  void mousePressEvent(QMouseEvent *event) override;
 
  private:
+  void releaseGL();
+  bool drawsScene() const { return scene_ && !scene_->empty(); }
+  void drawStatsOverlay();
+  void drawMarker();
+
+  static constexpr float kPickPixels = 6.f;
+
   Model *model_ = nullptr;
+  const Scene *scene_ = nullptr;
+  WireframeRenderer renderer_;
+  bool statsOverlay_ = false;
+  bool marker_ = false;
+  float markerX_ = 0.f, markerY_ = 0.f;
 };
 
-}  // namespace s21
\ No newline at end of file
+}  // namespace s21
@@ -0,0 +1,642 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../model/affineTransformer.h"
+#include "../model/edgeBuilder.h"
+#include "../model/edgeClusters.h"
+#include "../model/localityReorder.h"
+#include "../model/meshCache.h"
+#include "../model/model.h"
+#include "../model/profiler.h"
+#include "../model/scene.h"
+#include "../model/softwareRasterizer.h"
+#include "../model/spatialIndex.h"
+#include "../model/transformCoalescer.h"
+#include "memoryProbe.h"
+#include "meshGenerator.h"
+
+// Run from src/benchmarks (make bench does), so objModels is one level up.
+// Synthetic sizes go from 1K to 10M vertices; benchmarks that need an OBJ
+// file on disk stop at 1M to keep the temporary files below ~100 MB.
+
+namespace {
+
+constexpr int64_t kMinVertices = 1 << 10;
+constexpr int64_t kMaxVertices = 10'000'000;
+constexpr int64_t kMaxFileVertices = 1'000'000;
+
+const s21::Mesh &syntheticMesh(s21::MeshKind kind, size_t vertices) {
+  static std::map<std::pair<s21::MeshKind, size_t>, s21::Mesh> meshes;
+  auto it = meshes.find({kind, vertices});
+  if (it == meshes.end())
+    it = meshes
+             .emplace(std::make_pair(kind, vertices),
+                      s21::MeshGenerator::generate(kind, vertices))
+             .first;
+  return it->second;
+}
+
+std::vector<std::filesystem::path> &temporaryFiles() {
+  static std::vector<std::filesystem::path> files;
+  return files;
+}
+
+std::string syntheticFile(s21::MeshKind kind, size_t vertices) {
+  static std::map<std::pair<s21::MeshKind, size_t>, std::string> paths;
+  auto it = paths.find({kind, vertices});
+  if (it != paths.end()) return it->second;
+
+  auto path = std::filesystem::temp_directory_path() /
+              ("s21_bench_" + std::string(s21::MeshGenerator::name(kind)) +
+               "_" + std::to_string(vertices) + ".obj");
+  s21::MeshGenerator::writeObj(syntheticMesh(kind, vertices), path.string());
+  temporaryFiles().push_back(path);
+  return paths.emplace(std::make_pair(kind, vertices), path.string())
+      .first->second;
+}
+
+void setCounters(benchmark::State &state, size_t items, size_t bytes) {
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+// allocations and peak_rss_mb describe one load into an empty Model (the
+// pages of the mapped file count towards the peak), clear_frees the
+// Model::clear() that drops it.
+void loadFile(benchmark::State &state, const std::string &filename) {
+  {
+    s21::Model fresh;
+    s21::MemoryProbe probe;
+    fresh.loadFromFile(filename);
+    state.counters["allocations"] = static_cast<double>(probe.allocations());
+    state.counters["peak_rss_mb"] =
+        static_cast<double>(probe.peakRssGrowth()) / (1 << 20);
+    s21::MemoryProbe clearProbe;
+    fresh.clear();
+    state.counters["clear_frees"] =
+        static_cast<double>(clearProbe.releases());
+  }
+  s21::Model model;
+  model.loadFromFile(filename);  // warms the page cache
+  const size_t bytes = std::filesystem::file_size(filename);
+  for (auto _ : state) {
+    model.loadFromFile(filename);
+    benchmark::DoNotOptimize(model.vertexCount());
+  }
+  state.counters["vertices"] = static_cast<double>(model.vertexCount());
+  setCounters(state, model.vertexCount(), bytes);
+}
+
+void BM_LoadFromFile(benchmark::State &state, const char *filename) {
+  loadFile(state, filename);
+}
+
+void BM_LoadSynthetic(benchmark::State &state, s21::MeshKind kind) {
+  loadFile(state, syntheticFile(kind, static_cast<size_t>(state.range(0))));
+}
+
+void BM_Normalize(benchmark::State &state, s21::MeshKind kind) {
+  std::vector<s21::Vertex> vertices =
+      syntheticMesh(kind, static_cast<size_t>(state.range(0))).vertices;
+  // Normalizing already normalized data does the same amount of work.
+  for (auto _ : state) {
+    s21::Bounds bounds = s21::normalizeVertices(vertices);
+    benchmark::DoNotOptimize(bounds);
+  }
+  setCounters(state, vertices.size(), vertices.size() * sizeof(s21::Vertex));
+}
+
+// Model::rebuildFromTransform is private; a transform change followed by
+// getVertices() runs exactly one rebuild.
+void BM_RebuildFromTransform(benchmark::State &state, s21::MeshKind kind,
+                             s21::VertexLayout layout) {
+  s21::Model model;
+  model.setVertexLayout(layout);
+  model.setMesh(syntheticMesh(kind, static_cast<size_t>(state.range(0))));
+  model.getVertices();  // allocates the output buffers
+  float angle = 0.f;
+  for (auto _ : state) {
+    angle += 0.01f;
+    model.setRotation(angle, angle * 0.5f, 0.f);
+    benchmark::DoNotOptimize(model.getVertices().data());
+  }
+  setCounters(state, model.vertexCount(),
+              model.vertexCount() * sizeof(s21::Vertex) * 2);
+  const s21::GeometryFootprint f = model.footprint();
+  state.counters["bytes/vertex"] = f.bytesPerVertex;
+  state.counters["bytes/face"] = f.bytesPerFace;
+  state.counters["max_error"] = f.maxError;
+}
+
+// edgeCount() itself is a size() call; the work happens in EdgeBuilder at
+// load time.
+void BM_EdgeCount(benchmark::State &state, s21::MeshKind kind) {
+  const s21::Mesh &mesh =
+      syntheticMesh(kind, static_cast<size_t>(state.range(0)));
+  size_t edges = 0;
+  for (auto _ : state) {
+    edges = s21::EdgeBuilder::build(mesh.polygons, mesh.vertices.size()).size();
+    benchmark::DoNotOptimize(edges);
+  }
+  state.counters["edges"] = static_cast<double>(edges);
+  setCounters(state, mesh.polygons.indices().size(),
+              mesh.polygons.indices().size() * sizeof(unsigned));
+}
+
+void BM_BuildSpatialIndex(benchmark::State &state, s21::MeshKind kind) {
+  const s21::Mesh &mesh =
+      syntheticMesh(kind, static_cast<size_t>(state.range(0)));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    s21::SpatialIndex index(mesh.vertices, mesh.polygons);
+    bytes = index.memoryBytes();
+    benchmark::DoNotOptimize(bytes);
+  }
+  state.counters["index_bytes"] = static_cast<double>(bytes);
+  setCounters(state, mesh.vertices.size(), 0);
+}
+
+enum class PickQuery { kVertex, kEdge, kRaycast };
+
+// One query per iteration through Model, so the inverse matrix and ray
+// setup are included. Query points sweep the middle of the view, where the
+// normalized mesh is.
+void BM_Pick(benchmark::State &state, s21::MeshKind kind, PickQuery query) {
+  s21::Mesh mesh = syntheticMesh(kind, static_cast<size_t>(state.range(0)));
+  s21::normalizeVertices(mesh.vertices);
+  mesh.edges = s21::EdgeBuilder::build(mesh.polygons, mesh.vertices.size());
+  s21::Model model;
+  model.setMesh(std::move(mesh));
+  model.setRotation(0.4f, 0.7f, 0.f);
+  model.spatialIndex();
+  size_t hits = 0, queries = 0;
+  for (auto _ : state) {
+    const float x = -0.4f + 0.8f * static_cast<float>(queries % 97) / 97.f;
+    const float y = -0.4f + 0.8f * static_cast<float>(queries % 89) / 89.f;
+    ++queries;
+    s21::PickResult result;
+    if (query == PickQuery::kVertex)
+      result = model.pickVertex(x, y, 0.01f);
+    else if (query == PickQuery::kEdge)
+      result = model.pickEdge(x, y, 0.01f);
+    else
+      result = model.raycast(x, y);
+    hits += result.found;
+    benchmark::DoNotOptimize(result);
+  }
+  state.counters["hit_rate"] =
+      queries ? static_cast<double>(hits) / static_cast<double>(queries) : 0.0;
+  state.SetItemsProcessed(static_cast<int64_t>(queries));
+}
+
+void BM_BuildEdgeClusters(benchmark::State &state, s21::MeshKind kind) {
+  const s21::Mesh &mesh =
+      syntheticMesh(kind, static_cast<size_t>(state.range(0)));
+  const std::vector<s21::Edge> edges =
+      s21::EdgeBuilder::build(mesh.polygons, mesh.vertices.size());
+  for (auto _ : state) {
+    s21::EdgeClusters clusters(mesh.vertices, edges);
+    benchmark::DoNotOptimize(clusters.clusters().data());
+  }
+  setCounters(state, edges.size(), 0);
+}
+
+// Per-frame culling with the model half out of view (ty = 1) at full size
+// and zoomed out to scale 0.01; counters report the share of edges drawn.
+void BM_CullEdges(benchmark::State &state, s21::MeshKind kind, float scale) {
+  s21::Mesh mesh = syntheticMesh(kind, static_cast<size_t>(state.range(0)));
+  s21::normalizeVertices(mesh.vertices);
+  mesh.edges = s21::EdgeBuilder::build(mesh.polygons, mesh.vertices.size());
+  s21::Model model;
+  model.setMesh(std::move(mesh));
+  model.setTranslation(0.f, 1.f, 0.f);
+  model.setScale(scale);
+  const s21::EdgeClusters &clusters = model.edgeClusters(0);
+  std::vector<s21::EdgeClusters::Range> ranges;
+  s21::CullStats stats;
+  for (auto _ : state) {
+    stats = clusters.cull(model.transformMatrix(), 512.f, ranges);
+    benchmark::DoNotOptimize(ranges.data());
+  }
+  state.counters["drawn"] =
+      stats.edges ? static_cast<double>(stats.drawnEdges) / stats.edges : 0.0;
+  state.counters["draw_calls"] = static_cast<double>(ranges.size());
+  setCounters(state, clusters.clusters().size(), 0);
+}
+
+// One displayed frame of a slider drag on a 5M-vertex sphere that delivers
+// range(0) valueChanged signals per frame, drawn through the CPU transform
+// path. Without coalescing every signal updates the model and rebuilds the
+// vertices; with it the frame applies the last state once.
+void BM_SliderDragFrame(benchmark::State &state, bool coalesced) {
+  s21::Model model;
+  model.setMesh(syntheticMesh(s21::MeshKind::kSphere, 5'000'000));
+  model.getVertices();
+  s21::TransformCoalescer coalescer(model);
+  const int64_t signals = state.range(0);
+  float angle = 0.f;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < signals; ++i) {
+      angle += 0.001f;
+      if (coalesced) {
+        coalescer.post([angle](s21::Transform &t) { t.ry = angle; });
+      } else {
+        model.setRotation(0.f, angle, 0.f);
+        benchmark::DoNotOptimize(model.getVertices().data());
+      }
+    }
+    if (coalesced) {
+      coalescer.apply();
+      benchmark::DoNotOptimize(model.getVertices().data());
+      coalescer.presented();
+    }
+  }
+  state.counters["rebuilds_per_frame"] =
+      coalesced ? 1.0 : static_cast<double>(signals);
+}
+
+// 1024x1024 software frame of `instances` copies of one 100K-vertex part
+// on a grid. With lod, each copy is drawn at the level its size on screen
+// calls for; without, every copy draws the full mesh.
+void BM_SceneFrame(benchmark::State &state, bool lod) {
+  s21::LoadOptions options;
+  options.buildLods = true;
+  s21::Scene scene;
+  scene.setLoadOptions(options);
+  if (!lod) scene.setLodThreshold(0.f);
+  scene.addFromFile(syntheticFile(s21::MeshKind::kSphere, 100'000));
+  const size_t partBytes = scene.memoryBytes();
+  for (int64_t i = 1; i < state.range(0); ++i) scene.addInstance(0);
+  scene.arrangeGrid();
+  s21::RasterOptions raster;
+  s21::Framebuffer image(1024, 1024);
+  for (auto _ : state) {
+    s21::SoftwareRasterizer::render(scene, raster, image);
+    benchmark::DoNotOptimize(image.rgb().data());
+  }
+  std::vector<s21::EdgeClusters::Range> ranges;
+  s21::CullStats total, stats;
+  for (size_t i = 0; i < scene.size(); ++i) {
+    scene.cull(i, 512.f, ranges, stats);
+    total += stats;
+  }
+  state.counters["edges"] = static_cast<double>(total.edges);
+  state.counters["drawn_edges"] = static_cast<double>(total.drawnEdges);
+  state.counters["scene_bytes"] = static_cast<double>(scene.memoryBytes());
+  state.counters["unshared_bytes"] =
+      static_cast<double>(partBytes * scene.size());
+}
+
+// 1024x1024 software frame of a 1M-vertex model split into 200 groups, as
+// a CAD assembly exported with one "o" per part, showing every
+// `show_every`-th group. Hiding groups only shortens the list of edge
+// ranges drawn.
+void BM_GroupFrame(benchmark::State &state) {
+  s21::Mesh mesh =
+      s21::MeshGenerator::generate(s21::MeshKind::kSphere, 1'000'000);
+  const size_t faces = mesh.polygons.size();
+  constexpr size_t kParts = 200;
+  for (size_t g = 0; g < kParts; ++g) {
+    s21::FaceGroup group;
+    group.object = "part" + std::to_string(g);
+    group.firstFace = static_cast<unsigned>(faces * g / kParts);
+    group.faceCount =
+        static_cast<unsigned>(faces * (g + 1) / kParts) - group.firstFace;
+    mesh.groups.push_back(group);
+  }
+  mesh.edges = s21::EdgeBuilder::build(mesh.polygons, mesh.vertices.size(),
+                                       mesh.groups);
+  mesh.bounds = s21::normalizeVertices(mesh.vertices);
+  s21::Model model;
+  model.setMesh(std::move(mesh));
+  const auto every = static_cast<size_t>(state.range(0));
+  for (size_t g = 0; g < kParts; ++g) model.setGroupVisible(g, g % every == 0);
+  s21::RasterOptions raster;
+  s21::Framebuffer image(1024, 1024);
+  for (auto _ : state) {
+    s21::SoftwareRasterizer::render(model, raster, image);
+    benchmark::DoNotOptimize(image.rgb().data());
+  }
+  size_t drawn = 0;
+  for (const auto &r : model.visibleEdgeRanges()) drawn += r.count;
+  state.counters["drawn_edges"] = static_cast<double>(drawn);
+}
+
+// Alternating between two 1M-vertex files: parsed each time, or swapped in
+// from MeshCache.
+void BM_SwitchModel(benchmark::State &state, bool cached) {
+  const std::string files[2] = {
+      syntheticFile(s21::MeshKind::kSphere, kMaxFileVertices),
+      syntheticFile(s21::MeshKind::kGrid, kMaxFileVertices)};
+  s21::Model model;
+  s21::MeshCache cache;
+  s21::FileStamp stamps[2];
+  for (int i = 0; i < 2; ++i) s21::fileStamp(files[i], stamps[i]);
+  if (cached) {
+    model.loadFromFile(files[0]);
+    cache.put(files[0], stamps[0], model.takeMesh());
+  }
+  model.loadFromFile(files[1]);
+  int current = 1;
+  for (auto _ : state) {
+    const int next = 1 - current;
+    if (cached) {
+      std::optional<s21::Mesh> mesh = cache.take(files[next]);
+      cache.put(files[current], stamps[current], model.takeMesh());
+      model.setMesh(std::move(*mesh), files[next]);
+    } else {
+      model.loadFromFile(files[next]);
+    }
+    benchmark::DoNotOptimize(model.vertexCount());
+    current = next;
+  }
+  cache.waitReclaimed();
+  const s21::MeshCacheStats stats = cache.stats();
+  state.counters["hits"] = static_cast<double>(stats.hits);
+  state.counters["cache_bytes"] = static_cast<double>(stats.bytes);
+}
+
+void BM_MatrixMultiplication(benchmark::State &state) {
+  s21::AffineTransformer transformer;
+  s21::AffineTransformer::Matrix m = {{{0.9f, -0.1f, 0.f, 0.01f},
+                                       {0.1f, 0.9f, 0.f, 0.f},
+                                       {0.f, 0.f, 1.f, -0.01f},
+                                       {0.f, 0.f, 0.f, 1.f}}};
+  for (auto _ : state) {
+    transformer.multiplication(m);
+    benchmark::DoNotOptimize(transformer.matrix());
+  }
+  setCounters(state, 1, sizeof(m));
+}
+
+void BM_ApplyToVertex(benchmark::State &state) {
+  const s21::Mesh &mesh = syntheticMesh(s21::MeshKind::kSphere,
+                                        static_cast<size_t>(state.range(0)));
+  s21::AffineTransformer transformer;
+  transformer.rotateY(0.3f);
+  transformer.scale(1.5f, 1.5f, 1.5f);
+  std::vector<s21::Vertex> out(mesh.vertices.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < out.size(); ++i) {
+      out[i] = mesh.vertices[i];
+      transformer.applyToVertex(out[i]);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  setCounters(state, out.size(), out.size() * sizeof(s21::Vertex) * 2);
+}
+
+// 256x256 wireframe thumbnail of an already transformed model (items are
+// thumbnails).
+void BM_RasterizeThumbnail(benchmark::State &state, const char *filename) {
+  s21::Model model;
+  model.loadFromFile(filename);
+  model.setRotation(0.4f, 0.6f, 0.f);
+  const std::vector<s21::Vertex> &vertices = model.getVertices();
+  s21::RasterOptions options;
+  options.depthTest = state.range(0) != 0;
+  s21::Framebuffer image(256, 256);
+  for (auto _ : state) {
+    s21::SoftwareRasterizer::render(vertices, model.getEdges(), options,
+                                    image);
+    benchmark::DoNotOptimize(image.rgb().data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Cost of an instrumented scope, with the profiler off and on.
+void BM_ScopedTimer(benchmark::State &state) {
+  s21::Profiler &profiler = s21::Profiler::instance();
+  profiler.setEnabled(state.range(0) != 0);
+  for (auto _ : state) {
+    s21::ScopedTimer timer(s21::Stage::kParse);
+    benchmark::ClobberMemory();
+  }
+  profiler.setEnabled(false);
+  profiler.reset();
+  state.SetItemsProcessed(state.iterations());
+}
+
+// A synthetic mesh as MeshLoader leaves it: normalized, with edges, and
+// renumbered by LocalityReorder if asked to.
+s21::Mesh loadedMesh(s21::MeshKind kind, size_t vertices, bool reordered) {
+  s21::Mesh mesh = syntheticMesh(kind, vertices);
+  mesh.edges = s21::EdgeBuilder::build(mesh.polygons, mesh.vertices.size());
+  mesh.bounds = s21::normalizeVertices(mesh.vertices);
+  if (reordered) s21::LocalityReorder::apply(mesh);
+  return mesh;
+}
+
+// Mean index distance between the ends of an edge, a proxy for how far
+// apart in memory an edge pass reads.
+void setEdgeSpan(benchmark::State &state, const std::vector<s21::Edge> &edges) {
+  double span = 0.0;
+  for (const s21::Edge &e : edges) span += e.b - e.a;
+  state.counters["edge_span"] = edges.empty() ? 0.0 : span / edges.size();
+}
+
+// The LocalityReorder pass alone (items are vertices).
+void BM_Reorder(benchmark::State &state, s21::MeshKind kind) {
+  const s21::Mesh mesh =
+      loadedMesh(kind, static_cast<size_t>(state.range(0)), false);
+  for (auto _ : state) {
+    state.PauseTiming();
+    s21::Mesh copy = mesh;
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(s21::LocalityReorder::apply(copy).data());
+  }
+  state.SetItemsProcessed(
+      static_cast<int64_t>(state.iterations() * mesh.vertices.size()));
+}
+
+// The index-chasing loop of immediate-mode drawing: both ends of every
+// edge, in edge order (items are edges).
+void BM_EdgeTraversal(benchmark::State &state, s21::MeshKind kind,
+                      bool reordered) {
+  const s21::Mesh mesh =
+      loadedMesh(kind, static_cast<size_t>(state.range(0)), reordered);
+  for (auto _ : state) {
+    float sum = 0.f;
+    for (const s21::Edge &e : mesh.edges) {
+      const s21::Vertex &a = mesh.vertices[e.a];
+      const s21::Vertex &b = mesh.vertices[e.b];
+      sum += a.x + a.y + a.z + b.x + b.y + b.z;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(
+      static_cast<int64_t>(state.iterations() * mesh.edges.size()));
+  setEdgeSpan(state, mesh.edges);
+}
+
+// A software-drawn frame: rebuildFromTransform, then the edge pass over
+// the transformed vertices (items are edges).
+void BM_TransformAndTraverse(benchmark::State &state, s21::MeshKind kind,
+                             bool reordered) {
+  s21::Model model;
+  model.setMesh(
+      loadedMesh(kind, static_cast<size_t>(state.range(0)), reordered));
+  const std::vector<s21::Edge> &edges = model.getEdges();
+  float angle = 0.f;
+  for (auto _ : state) {
+    angle += 0.01f;
+    model.setRotation(angle, angle * 0.5f, 0.f);
+    const std::vector<s21::Vertex> &vertices = model.getVertices();
+    float sum = 0.f;
+    for (const s21::Edge &e : edges)
+      sum += vertices[e.a].x + vertices[e.b].y;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(
+      static_cast<int64_t>(state.iterations() * edges.size()));
+  setEdgeSpan(state, edges);
+}
+
+void registerSynthetic() {
+  using s21::MeshKind;
+  for (MeshKind kind : {MeshKind::kGrid, MeshKind::kSphere, MeshKind::kSoup}) {
+    const std::string name = s21::MeshGenerator::name(kind);
+    benchmark::RegisterBenchmark(("LoadFromFile/" + name).c_str(),
+                                 BM_LoadSynthetic, kind)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxFileVertices)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("Normalize/" + name).c_str(), BM_Normalize,
+                                 kind)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxVertices);
+    benchmark::RegisterBenchmark(("RebuildFromTransform/aos/" + name).c_str(),
+                                 BM_RebuildFromTransform, kind,
+                                 s21::VertexLayout::kArrayOfStructs)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxVertices);
+    benchmark::RegisterBenchmark(("RebuildFromTransform/soa/" + name).c_str(),
+                                 BM_RebuildFromTransform, kind,
+                                 s21::VertexLayout::kStructOfArrays)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxVertices);
+    benchmark::RegisterBenchmark(
+        ("RebuildFromTransform/quantized/" + name).c_str(),
+        BM_RebuildFromTransform, kind, s21::VertexLayout::kQuantized)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxVertices);
+    benchmark::RegisterBenchmark(("EdgeCount/" + name).c_str(), BM_EdgeCount,
+                                 kind)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxVertices)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("BuildSpatialIndex/" + name).c_str(),
+                                 BM_BuildSpatialIndex, kind)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxVertices)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("BuildEdgeClusters/" + name).c_str(),
+                                 BM_BuildEdgeClusters, kind)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxVertices)
+        ->Unit(benchmark::kMillisecond);
+    for (float scale : {1.f, 0.01f})
+      benchmark::RegisterBenchmark(
+          ("CullEdges/" + name + "/scale:" + (scale < 1.f ? "0.01" : "1"))
+              .c_str(),
+          BM_CullEdges, kind, scale)
+          ->RangeMultiplier(10)
+          ->Range(kMinVertices, kMaxVertices)
+          ->Unit(benchmark::kMicrosecond);
+    const std::pair<const char *, PickQuery> queries[] = {
+        {"PickVertex/", PickQuery::kVertex},
+        {"PickEdge/", PickQuery::kEdge},
+        {"Raycast/", PickQuery::kRaycast}};
+    for (const auto &[prefix, query] : queries)
+      benchmark::RegisterBenchmark((prefix + name).c_str(), BM_Pick, kind,
+                                   query)
+          ->RangeMultiplier(10)
+          ->Range(kMinVertices, kMaxVertices)
+          ->Unit(benchmark::kMicrosecond);
+  }
+
+  for (MeshKind kind : {MeshKind::kSphere, MeshKind::kScrambled}) {
+    const std::string name = s21::MeshGenerator::name(kind);
+    benchmark::RegisterBenchmark(("Reorder/" + name).c_str(), BM_Reorder,
+                                 kind)
+        ->RangeMultiplier(10)
+        ->Range(kMinVertices, kMaxVertices)
+        ->Unit(benchmark::kMillisecond);
+    for (bool reordered : {false, true}) {
+      const std::string order = reordered ? "reordered/" : "file/";
+      benchmark::RegisterBenchmark(
+          ("EdgeTraversal/" + order + name).c_str(), BM_EdgeTraversal, kind,
+          reordered)
+          ->RangeMultiplier(10)
+          ->Range(kMinVertices, kMaxVertices)
+          ->Unit(benchmark::kMillisecond);
+      benchmark::RegisterBenchmark(
+          ("TransformAndTraverse/" + order + name).c_str(),
+          BM_TransformAndTraverse, kind, reordered)
+          ->RangeMultiplier(10)
+          ->Range(kMinVertices, kMaxVertices)
+          ->Unit(benchmark::kMillisecond);
+    }
+  }
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_LoadFromFile, pumpkin, "../objModels/pumpkin.obj")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadFromFile, skull, "../objModels/skull.obj")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MatrixMultiplication);
+BENCHMARK_CAPTURE(BM_RasterizeThumbnail, skull, "../objModels/skull.obj")
+    ->ArgName("depth")
+    ->Arg(0)
+    ->Arg(1);
+BENCHMARK_CAPTURE(BM_SliderDragFrame, immediate, false)
+    ->ArgName("signals")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SliderDragFrame, coalesced, true)
+    ->ArgName("signals")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SwitchModel, parse, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SwitchModel, cached, true)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SceneFrame, lod, true)
+    ->ArgName("instances")
+    ->RangeMultiplier(4)
+    ->Range(1, 256)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SceneFrame, full, false)
+    ->ArgName("instances")
+    ->RangeMultiplier(4)
+    ->Range(1, 256)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GroupFrame)
+    ->ArgName("show_every")
+    ->Arg(1)
+    ->Arg(10)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ScopedTimer)->ArgName("enabled")->Arg(0)->Arg(1);
+BENCHMARK(BM_ApplyToVertex)->RangeMultiplier(10)->Range(kMinVertices,
+                                                         kMaxVertices);
+
+int main(int argc, char **argv) {
+  registerSynthetic();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  for (const auto &path : temporaryFiles()) std::filesystem::remove(path);
+  return 0;
+}
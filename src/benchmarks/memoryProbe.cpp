@@ -0,0 +1,71 @@
+#include "memoryProbe.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+
+namespace {
+
+std::atomic<size_t> allocationCount{0};
+std::atomic<size_t> releaseCount{0};
+
+void release(void *p) {
+  if (!p) return;
+  releaseCount.fetch_add(1, std::memory_order_relaxed);
+  std::free(p);
+}
+
+// Value of a "Name:   1234 kB" line of /proc/self/status, in bytes.
+size_t statusBytes(const std::string &name) {
+  std::ifstream status("/proc/self/status");
+  std::string key;
+  size_t kb = 0;
+  while (status >> key) {
+    if (key == name + ":") {
+      status >> kb;
+      return kb * 1024;
+    }
+    status.ignore(256, '\n');
+  }
+  return 0;
+}
+
+}  // namespace
+
+// The array and nothrow forms forward to these by default.
+void *operator new(size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { release(p); }
+
+void operator delete(void *p, size_t) noexcept { release(p); }
+
+namespace s21 {
+
+MemoryProbe::MemoryProbe() {
+  // Writing 5 resets VmHWM to the current RSS (Linux 4.0 and later).
+  std::ofstream("/proc/self/clear_refs") << "5";
+  rss_ = statusBytes("VmRSS");
+  allocations_ = allocationCount.load(std::memory_order_relaxed);
+  releases_ = releaseCount.load(std::memory_order_relaxed);
+}
+
+size_t MemoryProbe::allocations() const {
+  return allocationCount.load(std::memory_order_relaxed) - allocations_;
+}
+
+size_t MemoryProbe::releases() const {
+  return releaseCount.load(std::memory_order_relaxed) - releases_;
+}
+
+size_t MemoryProbe::peakRssGrowth() const {
+  const size_t peak = statusBytes("VmHWM");
+  return peak > rss_ ? peak - rss_ : 0;
+}
+
+}  // namespace s21
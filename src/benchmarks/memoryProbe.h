@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+namespace s21 {
+
+// Heap allocations and resident memory of the benchmark process over a
+// stretch of code. The bench binary replaces the global operator new and
+// delete to count allocations and frees (direct malloc calls are not seen;
+// the model code makes none). Peak RSS comes from /proc/self/status; on
+// Linux the constructor resets the high-water mark, elsewhere it reads 0.
+class MemoryProbe {
+ public:
+  MemoryProbe();
+
+  // operator new calls since construction.
+  size_t allocations() const;
+  // operator delete calls on non-null pointers since construction.
+  size_t releases() const;
+  // Highest resident set size since construction minus the one at
+  // construction, in bytes. Mapped file pages that were touched count.
+  size_t peakRssGrowth() const;
+
+ private:
+  size_t allocations_;
+  size_t releases_;
+  size_t rss_;
+};
+
+}  // namespace s21
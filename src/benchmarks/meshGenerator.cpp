@@ -0,0 +1,170 @@
+#include "meshGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <numbers>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace s21 {
+
+namespace {
+
+Mesh grid(size_t vertices) {
+  const size_t n = std::max<size_t>(
+      2, static_cast<size_t>(std::lround(std::sqrt(double(vertices)))));
+  Mesh mesh;
+  mesh.vertices.reserve(n * n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      const float x = float(j) / float(n - 1);
+      const float y = float(i) / float(n - 1);
+      mesh.vertices.push_back(
+          {x, y, 0.1f * std::sin(8.f * x) * std::cos(8.f * y)});
+    }
+  }
+  mesh.polygons.reserve((n - 1) * (n - 1), (n - 1) * (n - 1) * 4);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    for (size_t j = 0; j + 1 < n; ++j) {
+      const auto v = static_cast<unsigned>(i * n + j);
+      const auto w = static_cast<unsigned>(n);
+      const unsigned quad[] = {v, v + 1, v + w + 1, v + w};
+      mesh.polygons.addPolygon(quad);
+    }
+  }
+  return mesh;
+}
+
+Mesh sphere(size_t vertices) {
+  // rings * segments grid plus the two poles, with segments = 2 * rings.
+  const size_t rings = std::max<size_t>(
+      2, static_cast<size_t>(std::lround(std::sqrt(double(vertices) / 2.0))));
+  const size_t segments = 2 * rings;
+  const auto pi = std::numbers::pi_v<float>;
+  Mesh mesh;
+  mesh.vertices.reserve(rings * segments + 2);
+  mesh.vertices.push_back({0.f, 1.f, 0.f});
+  for (size_t r = 1; r <= rings; ++r) {
+    const float theta = pi * float(r) / float(rings + 1);
+    for (size_t s = 0; s < segments; ++s) {
+      const float phi = 2.f * pi * float(s) / float(segments);
+      mesh.vertices.push_back({std::sin(theta) * std::cos(phi),
+                               std::cos(theta),
+                               std::sin(theta) * std::sin(phi)});
+    }
+  }
+  const auto south = static_cast<unsigned>(mesh.vertices.size());
+  mesh.vertices.push_back({0.f, -1.f, 0.f});
+
+  auto at = [segments](size_t r, size_t s) {
+    return static_cast<unsigned>(1 + (r - 1) * segments + s % segments);
+  };
+  mesh.polygons.reserve(2 * rings * segments, 6 * rings * segments);
+  for (size_t s = 0; s < segments; ++s) {
+    const unsigned top[] = {0, at(1, s + 1), at(1, s)};
+    const unsigned bottom[] = {south, at(rings, s), at(rings, s + 1)};
+    mesh.polygons.addPolygon(top);
+    mesh.polygons.addPolygon(bottom);
+  }
+  for (size_t r = 1; r < rings; ++r) {
+    for (size_t s = 0; s < segments; ++s) {
+      const unsigned a[] = {at(r, s), at(r, s + 1), at(r + 1, s + 1)};
+      const unsigned b[] = {at(r, s), at(r + 1, s + 1), at(r + 1, s)};
+      mesh.polygons.addPolygon(a);
+      mesh.polygons.addPolygon(b);
+    }
+  }
+  return mesh;
+}
+
+Mesh soup(size_t vertices, uint32_t seed) {
+  vertices = std::max<size_t>(vertices, 3);
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> coord(-1.f, 1.f);
+  std::uniform_int_distribution<unsigned> index(
+      0, static_cast<unsigned>(vertices - 1));
+  Mesh mesh;
+  mesh.vertices.resize(vertices);
+  for (auto &v : mesh.vertices) v = {coord(rng), coord(rng), coord(rng)};
+  const size_t faces = 2 * vertices;
+  mesh.polygons.reserve(faces, 3 * faces);
+  for (size_t f = 0; f < faces; ++f) {
+    const unsigned tri[] = {index(rng), index(rng), index(rng)};
+    mesh.polygons.addPolygon(tri);
+  }
+  return mesh;
+}
+
+Mesh scrambled(size_t vertices, uint32_t seed) {
+  Mesh mesh = sphere(vertices);
+  std::mt19937 rng(seed);
+  std::vector<unsigned> remap(mesh.vertices.size());
+  std::iota(remap.begin(), remap.end(), 0u);
+  std::shuffle(remap.begin(), remap.end(), rng);
+  std::vector<Vertex> shuffled(mesh.vertices.size());
+  for (size_t i = 0; i < remap.size(); ++i)
+    shuffled[remap[i]] = mesh.vertices[i];
+  mesh.vertices.swap(shuffled);
+
+  std::vector<unsigned> faces(mesh.polygons.size());
+  std::iota(faces.begin(), faces.end(), 0u);
+  std::shuffle(faces.begin(), faces.end(), rng);
+  PolygonList polygons;
+  polygons.reserve(faces.size(), mesh.polygons.indices().size());
+  for (unsigned f : faces) {
+    for (unsigned index : mesh.polygons[f]) polygons.appendIndex(remap[index]);
+    polygons.commitPolygon();
+  }
+  mesh.polygons = std::move(polygons);
+  return mesh;
+}
+
+}  // namespace
+
+const char *MeshGenerator::name(MeshKind kind) {
+  switch (kind) {
+    case MeshKind::kGrid:
+      return "grid";
+    case MeshKind::kSphere:
+      return "sphere";
+    case MeshKind::kSoup:
+      return "soup";
+    case MeshKind::kScrambled:
+      return "scrambled";
+  }
+  return "";
+}
+
+Mesh MeshGenerator::generate(MeshKind kind, size_t vertices, uint32_t seed) {
+  switch (kind) {
+    case MeshKind::kGrid:
+      return grid(vertices);
+    case MeshKind::kSphere:
+      return sphere(vertices);
+    case MeshKind::kSoup:
+      return soup(vertices, seed);
+    case MeshKind::kScrambled:
+      return scrambled(vertices, seed);
+  }
+  return Mesh{};
+}
+
+void MeshGenerator::writeObj(const Mesh &mesh, const std::string &filename) {
+  std::unique_ptr<FILE, int (*)(FILE *)> file(std::fopen(filename.c_str(), "w"),
+                                              &std::fclose);
+  if (!file) throw std::runtime_error("Cannot create file: " + filename);
+  for (const auto &v : mesh.vertices)
+    std::fprintf(file.get(), "v %.6f %.6f %.6f\n", v.x, v.y, v.z);
+  for (Polygon polygon : mesh.polygons) {
+    std::fputc('f', file.get());
+    for (unsigned index : polygon) std::fprintf(file.get(), " %u", index + 1);
+    std::fputc('\n', file.get());
+  }
+  if (std::fflush(file.get()) != 0)
+    throw std::runtime_error("Cannot write file: " + filename);
+}
+
+}  // namespace s21
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../model/mesh.h"
+
+namespace s21 {
+
+// Synthetic meshes of a requested size for benchmarks.
+//   kGrid:   a square height field made of quads;
+//   kSphere: a UV sphere made of triangles;
+//   kSoup:   uniformly random points joined by random triangles (no
+//            locality at all, the worst case for caches);
+//   kScrambled: kSphere with its vertices and faces shuffled, as written
+//            by exporters that keep no spatial order.
+enum class MeshKind { kGrid, kSphere, kSoup, kScrambled };
+
+class MeshGenerator {
+ public:
+  static const char *name(MeshKind kind);
+  // Raw (not normalized) vertices and faces, no edges. The vertex count is
+  // `vertices` rounded to the nearest size the shape can be built with.
+  static Mesh generate(MeshKind kind, size_t vertices, uint32_t seed = 1);
+  // Writes mesh as an OBJ file, as exported by common tools ("%.6f").
+  static void writeObj(const Mesh &mesh, const std::string &filename);
+};
+
+}  // namespace s21
@@ -0,0 +1,340 @@
+// Headless batch front end of the model pipeline: loads OBJ files, applies
+// one Transform to each, and writes the transformed models, wireframe
+// thumbnails and/or statistics. Builds without Qt (make cli).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "model/model.h"
+#include "model/objWriter.h"
+#include "model/softwareRasterizer.h"
+#include "model/threadPool.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::vector<std::string> inputs;
+  s21::Transform transform;
+  std::string outDir;
+  std::string thumbnailDir;
+  int thumbnailSize = 256;
+  bool depthTest = false;
+  unsigned threads = 0;
+  bool json = false;
+};
+
+struct FileResult {
+  std::string path;
+  size_t bytes = 0;
+  size_t vertices = 0;
+  size_t polygons = 0;
+  size_t edges = 0;
+  double loadMs = 0.0;
+  double transformMs = 0.0;
+  double writeMs = 0.0;
+  double renderMs = 0.0;
+  std::string error;
+};
+
+double msSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+double mbPerSecond(size_t bytes, double ms) {
+  return ms > 0.0 ? bytes / 1048576.0 / (ms * 1e-3) : 0.0;
+}
+
+void usage() {
+  std::fputs(
+      "usage: s21_batch [options] <file.obj | directory | @list.txt>...\n"
+      "  --tx X --ty Y --tz Z  translation\n"
+      "  --rx A --ry B --rz C  rotation around the model center, radians\n"
+      "  --s S                 uniform scale\n"
+      "  --out DIR             write the transformed models to DIR\n"
+      "  --thumbnails DIR      render wireframe PNG thumbnails to DIR\n"
+      "  --size N              thumbnail size in pixels (default 256)\n"
+      "  --depth               depth-test thumbnail edges\n"
+      "  --threads N           threads in total (default: all cores)\n"
+      "  --json                print statistics as JSON\n"
+      "Directories are searched recursively for *.obj; @list.txt names one\n"
+      "input per line.\n",
+      stderr);
+}
+
+bool isObj(const fs::path &path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return ext == ".obj";
+}
+
+void collect(const std::string &input, std::vector<std::string> &files) {
+  if (!input.empty() && input[0] == '@') {
+    std::ifstream list(input.substr(1));
+    if (!list) throw std::runtime_error("Cannot open file: " + input.substr(1));
+    for (std::string line; std::getline(list, line);) {
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (!line.empty()) collect(line, files);
+    }
+  } else if (fs::is_directory(input)) {
+    for (const auto &entry : fs::recursive_directory_iterator(input))
+      if (entry.is_regular_file() && isObj(entry.path()))
+        files.push_back(entry.path().string());
+  } else {
+    files.push_back(input);
+  }
+}
+
+bool parseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> const char * {
+      if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+      return argv[++i];
+    };
+    auto number = [&] {
+      const char *text = value();
+      char *end = nullptr;
+      float f = std::strtof(text, &end);
+      if (end == text || *end != '\0')
+        throw std::runtime_error("Invalid number for " + arg + ": " + text);
+      return f;
+    };
+    s21::Transform &t = options.transform;
+    if (arg == "--tx") {
+      t.tx = number();
+    } else if (arg == "--ty") {
+      t.ty = number();
+    } else if (arg == "--tz") {
+      t.tz = number();
+    } else if (arg == "--rx") {
+      t.rx = number();
+    } else if (arg == "--ry") {
+      t.ry = number();
+    } else if (arg == "--rz") {
+      t.rz = number();
+    } else if (arg == "--s") {
+      t.s = number();
+    } else if (arg == "--out") {
+      options.outDir = value();
+    } else if (arg == "--thumbnails") {
+      options.thumbnailDir = value();
+    } else if (arg == "--size") {
+      options.thumbnailSize = static_cast<int>(number());
+      if (options.thumbnailSize <= 0 || options.thumbnailSize > 16384)
+        throw std::runtime_error("Invalid thumbnail size");
+    } else if (arg == "--depth") {
+      options.depthTest = true;
+    } else if (arg == "--threads") {
+      options.threads = static_cast<unsigned>(std::max(0.f, number()));
+    } else if (arg == "--json") {
+      options.json = true;
+    } else if (arg == "--help" || arg == "-h") {
+      return false;
+    } else if (arg.size() > 1 && arg[0] == '-' && arg[1] == '-') {
+      throw std::runtime_error("Unknown option: " + arg);
+    } else {
+      options.inputs.push_back(arg);
+    }
+  }
+  return !options.inputs.empty();
+}
+
+// Output names keep the input's base name; the index keeps inputs with the
+// same base name in different directories apart.
+std::string outputPath(const std::string &dir, const std::string &input,
+                       size_t index, const char *extension) {
+  const fs::path name = fs::path(input).filename();
+  return (fs::path(dir) /
+          (name.stem().string() + "_" + std::to_string(index) + extension))
+      .string();
+}
+
+void processFile(const Options &options, size_t index, FileResult &result) {
+  s21::Model model;
+  model.setVertexLayout(s21::VertexLayout::kStructOfArrays);
+  model.setLoadThreads(options.threads);
+
+  auto start = Clock::now();
+  result.bytes = fs::file_size(result.path);
+  model.loadFromFile(result.path);
+  result.loadMs = msSince(start);
+  result.vertices = model.vertexCount();
+  result.polygons = model.getPolygons().size();
+  result.edges = model.edgeCount();
+
+  start = Clock::now();
+  const s21::Transform &t = options.transform;
+  model.setTranslation(t.tx, t.ty, t.tz);
+  model.setRotation(t.rx, t.ry, t.rz);
+  model.setScale(t.s);
+  const std::vector<s21::Vertex> &vertices = model.getVertices();
+  result.transformMs = msSince(start);
+
+  if (!options.outDir.empty()) {
+    start = Clock::now();
+    s21::ObjWriter::write(outputPath(options.outDir, result.path, index,
+                                     ".obj"),
+                          vertices, model.getPolygons());
+    result.writeMs = msSince(start);
+  }
+
+  if (!options.thumbnailDir.empty()) {
+    start = Clock::now();
+    s21::RasterOptions raster;
+    raster.depthTest = options.depthTest;
+    raster.threads = options.threads;
+    s21::Framebuffer image(options.thumbnailSize, options.thumbnailSize);
+    s21::SoftwareRasterizer::render(vertices, model.getEdges(), raster, image);
+    image.writePng(
+        outputPath(options.thumbnailDir, result.path, index, ".png"));
+    result.renderMs = msSince(start);
+  }
+}
+
+void printText(const std::vector<FileResult> &results, double wallMs,
+               unsigned threads) {
+  size_t bytes = 0, vertices = 0, failed = 0;
+  for (const auto &r : results) {
+    if (!r.error.empty()) {
+      ++failed;
+      std::printf("FAIL %s: %s\n", r.path.c_str(), r.error.c_str());
+      continue;
+    }
+    bytes += r.bytes;
+    vertices += r.vertices;
+    std::printf(
+        "%s: %zu vertices, %zu faces, %zu edges; load %.1f ms (%.1f MB/s), "
+        "transform %.2f ms, write %.1f ms, thumbnail %.2f ms\n",
+        r.path.c_str(), r.vertices, r.polygons, r.edges, r.loadMs,
+        mbPerSecond(r.bytes, r.loadMs), r.transformMs, r.writeMs,
+        r.renderMs);
+  }
+  std::printf(
+      "total: %zu files (%zu failed), %.1f MB in %.1f ms on %u threads: "
+      "%.1f MB/s, %.1f files/s, %.2f Mvertices/s\n",
+      results.size(), failed, bytes / 1048576.0, wallMs, threads,
+      mbPerSecond(bytes, wallMs), results.size() / (wallMs * 1e-3),
+      vertices / (wallMs * 1e-3) * 1e-6);
+}
+
+std::string jsonString(const std::string &s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+void printJson(const std::vector<FileResult> &results, double wallMs,
+               unsigned threads) {
+  size_t bytes = 0, vertices = 0, failed = 0;
+  std::printf("{\"files\":[");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const FileResult &r = results[i];
+    std::printf("%s\n{\"path\":%s", i ? "," : "", jsonString(r.path).c_str());
+    if (!r.error.empty()) {
+      ++failed;
+      std::printf(",\"error\":%s}", jsonString(r.error).c_str());
+      continue;
+    }
+    bytes += r.bytes;
+    vertices += r.vertices;
+    std::printf(
+        ",\"bytes\":%zu,\"vertices\":%zu,\"polygons\":%zu,\"edges\":%zu,"
+        "\"load_ms\":%.3f,\"transform_ms\":%.3f,\"write_ms\":%.3f,"
+        "\"thumbnail_ms\":%.3f,\"load_mb_per_s\":%.3f}",
+        r.bytes, r.vertices, r.polygons, r.edges, r.loadMs, r.transformMs,
+        r.writeMs, r.renderMs, mbPerSecond(r.bytes, r.loadMs));
+  }
+  std::printf(
+      "\n],\"total\":{\"files\":%zu,\"failed\":%zu,\"bytes\":%zu,"
+      "\"vertices\":%zu,\"wall_ms\":%.3f,\"threads\":%u,"
+      "\"mb_per_s\":%.3f,\"files_per_s\":%.3f,\"vertices_per_s\":%.1f}}\n",
+      results.size(), failed, bytes, vertices, wallMs, threads,
+      mbPerSecond(bytes, wallMs), results.size() / (wallMs * 1e-3),
+      vertices / (wallMs * 1e-3));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  std::vector<FileResult> results;
+  try {
+    if (!parseArgs(argc, argv, options)) {
+      usage();
+      return 2;
+    }
+    std::vector<std::string> files;
+    for (const auto &input : options.inputs) collect(input, files);
+    if (!options.outDir.empty()) fs::create_directories(options.outDir);
+    if (!options.thumbnailDir.empty())
+      fs::create_directories(options.thumbnailDir);
+    results.resize(files.size());
+    for (size_t i = 0; i < files.size(); ++i) results[i].path = files[i];
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "s21_batch: %s\n", e.what());
+    return 2;
+  }
+
+  // Files are handed out largest first from the shared pool's atomic
+  // index, so a big file starts early instead of finishing last. Threads
+  // that run out of files pick up the chunk loops of the files still
+  // parsing, so one large file still loads in parallel.
+  std::vector<size_t> order(results.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::vector<size_t> sizes(results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    std::error_code ec;
+    sizes[i] = fs::file_size(results[i].path, ec);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+  s21::ThreadPool &pool = s21::ThreadPool::shared();
+  const unsigned threads =
+      options.threads == 0 ? pool.concurrency()
+                           : std::min(options.threads, pool.concurrency());
+  const auto start = Clock::now();
+  pool.parallelFor(order.size(), threads, [&](size_t i) {
+    const size_t index = order[i];
+    try {
+      processFile(options, index, results[index]);
+    } catch (const std::exception &e) {
+      results[index].error = e.what();
+    }
+  });
+  const double wallMs = msSince(start);
+
+  if (options.json)
+    printJson(results, wallMs, threads);
+  else
+    printText(results, wallMs, threads);
+
+  return std::any_of(results.begin(), results.end(),
+                     [](const FileResult &r) { return !r.error.empty(); })
+             ? 1
+             : 0;
+}
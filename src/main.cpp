@@ -13,7 +13,12 @@ int main(int argc, char *argv[]) {
 
   QApplication app(argc, argv);
   s21::Model model;
+  model.setBinaryCacheEnabled(true);
+  model.setLodEnabled(true);
+  model.setPickIndexEnabled(true);
+  model.setEdgeClustersEnabled(true);
   s21::Controller controller(&model);
+  controller.SetStreamingLoad(true);
   s21::MainWindow w(&controller);
 
   w.show();
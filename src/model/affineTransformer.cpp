@@ -81,4 +81,34 @@ void AffineTransformer::resetMatrix() {
   }
 }
 
+const AffineTransformer::Matrix &AffineTransformer::matrix() const {
+  return matrix_;
+}
+
+AffineTransformer::Matrix AffineTransformer::inverse(const Matrix &m) {
+  // Inverse of the 3x3 part by cofactors, then R^-1 * -t for the
+  // translation.
+  const float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+  const float c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+  const float c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+  const float det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+  Matrix res = {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+  if (det == 0.0f) return res;
+  const float inv = 1.0f / det;
+  res[0][0] = c00 * inv;
+  res[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inv;
+  res[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inv;
+  res[1][0] = c01 * inv;
+  res[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inv;
+  res[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inv;
+  res[2][0] = c02 * inv;
+  res[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inv;
+  res[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inv;
+  for (int i = 0; i < 3; i++) {
+    res[i][3] = -(res[i][0] * m[0][3] + res[i][1] * m[1][3] +
+                  res[i][2] * m[2][3]);
+  }
+  return res;
+}
+
 }  // namespace s21
\ No newline at end of file
@@ -21,6 +21,10 @@ class AffineTransformer {
   void rotateZ(float angle);
   void applyToVertex(Vertex &ver);
   void resetMatrix();
+  const Matrix &matrix() const;
+  // Inverse of an affine matrix (last row 0 0 0 1); a singular linear part
+  // yields the identity.
+  static Matrix inverse(const Matrix &m);
 
  private:
   Matrix matrix_;
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+// Threads of cancellable background jobs, of which at most one is
+// current. Starting a job or retiring the current one cancels it and lets
+// it wind down on its own; such jobs are joined once they report back, so
+// the owner never blocks on them. Job needs std::atomic<bool> members
+// `cancelled` (read by the work) and `finished` (set here).
+//
+// All members are called from one owner thread (the GUI thread); the
+// work runs on the job's own thread.
+template <typename Job>
+class BackgroundJobs {
+ public:
+  BackgroundJobs() = default;
+  BackgroundJobs(const BackgroundJobs &) = delete;
+  BackgroundJobs &operator=(const BackgroundJobs &) = delete;
+  // Cancels every job and waits for them.
+  ~BackgroundJobs() {
+    retire();
+    for (Worker &w : retired_) {
+      w.job->cancelled = true;
+      w.thread.join();
+    }
+  }
+
+  // Retires the current job and runs work() on a new thread as the current
+  // one. Once work returns, the job is marked finished and done() runs on
+  // the same thread; it should hand the job back to the owner's finish().
+  void start(std::shared_ptr<Job> job, std::function<void()> work,
+             std::function<void()> done) {
+    retire();
+    current_.job = job;
+    current_.thread = std::thread([job, work = std::move(work),
+                                   done = std::move(done)] {
+      work();
+      job->finished = true;
+      done();
+    });
+  }
+
+  // Cancels the current job, if any; afterwards no job is current.
+  // Finished retired jobs are joined.
+  void retire() {
+    if (current_.job) current_.job->cancelled = true;
+    if (current_.thread.joinable()) retired_.push_back(std::move(current_));
+    current_ = Worker{};
+    reap();
+  }
+
+  // Called with a job that has finished. Joins its thread and returns true
+  // if it was the current job, which then stops being current; returns
+  // false for a retired (superseded or cancelled) one.
+  bool finish(const std::shared_ptr<Job> &job) {
+    if (!job || job != current_.job) {
+      reap();
+      return false;
+    }
+    current_.thread.join();
+    current_ = Worker{};
+    return true;
+  }
+
+  const std::shared_ptr<Job> &current() const { return current_.job; }
+  // Retired jobs not joined yet.
+  size_t retiredCount() const { return retired_.size(); }
+
+ private:
+  struct Worker {
+    std::thread thread;
+    std::shared_ptr<Job> job;
+  };
+
+  // Joining a finished thread is instant, so this never blocks the caller.
+  void reap() {
+    for (auto it = retired_.begin(); it != retired_.end();) {
+      if (it->job->finished) {
+        it->thread.join();
+        it = retired_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  Worker current_;
+  std::vector<Worker> retired_;
+};
+
+}  // namespace s21
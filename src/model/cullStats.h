@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace s21 {
+
+// What EdgeClusters::cull() kept and skipped in one frame.
+struct CullStats {
+  size_t clusters = 0;
+  // Entirely outside the view volume.
+  size_t culledClusters = 0;
+  // All edges below a pixel; drawn as an evenly spread subset.
+  size_t thinnedClusters = 0;
+  size_t edges = 0;
+  size_t drawnEdges = 0;
+
+  size_t skippedEdges() const { return edges - drawnEdges; }
+  CullStats &operator+=(const CullStats &other) {
+    clusters += other.clusters;
+    culledClusters += other.culledClusters;
+    thinnedClusters += other.thinnedClusters;
+    edges += other.edges;
+    drawnEdges += other.drawnEdges;
+    return *this;
+  }
+};
+
+}  // namespace s21
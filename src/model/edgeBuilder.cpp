@@ -0,0 +1,142 @@
+#include "edgeBuilder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "profiler.h"
+
+namespace s21 {
+
+namespace {
+
+template <typename F>
+void forEachHalfEdge(Polygon p, F &&fn) {
+  for (size_t i = 0; i < p.size(); ++i) {
+    unsigned a = p[i];
+    unsigned b = p[i + 1 < p.size() ? i + 1 : 0];
+    if (a == b) continue;
+    if (a > b) std::swap(a, b);
+    fn(a, b);
+  }
+}
+
+template <typename F>
+void forEachHalfEdge(const PolygonList &polygons, F &&fn) {
+  for (Polygon p : polygons) forEachHalfEdge(p, fn);
+}
+
+void checkIndices(const PolygonList &polygons, size_t vertexCount) {
+  for (unsigned idx : polygons.indices()) {
+    if (idx >= vertexCount)
+      throw std::runtime_error("Polygon references missing vertex " +
+                               std::to_string(idx + 1ull));
+  }
+}
+
+}  // namespace
+
+std::vector<Edge> EdgeBuilder::build(const PolygonList &polygons,
+                                     size_t vertexCount) {
+  ScopedTimer timer(Stage::kEdges);
+  checkIndices(polygons, vertexCount);
+
+  // start[a]..start[a + 1] will hold the far ends of the edges whose smaller
+  // vertex is a.
+  std::vector<unsigned> start(vertexCount + 1, 0);
+  forEachHalfEdge(polygons, [&](unsigned a, unsigned) { ++start[a + 1]; });
+  for (size_t v = 0; v < vertexCount; ++v) start[v + 1] += start[v];
+
+  std::vector<unsigned> far(start.back());
+  {
+    std::vector<unsigned> fill(start.begin(), start.end() - 1);
+    forEachHalfEdge(polygons,
+                    [&](unsigned a, unsigned b) { far[fill[a]++] = b; });
+  }
+
+  std::vector<Edge> edges;
+  edges.reserve(far.size() / 2 + 1);
+  for (size_t a = 0; a < vertexCount; ++a) {
+    auto first = far.begin() + start[a];
+    auto last = far.begin() + start[a + 1];
+    std::sort(first, last);
+    last = std::unique(first, last);
+    for (auto it = first; it != last; ++it)
+      edges.push_back({static_cast<unsigned>(a), *it});
+  }
+  edges.shrink_to_fit();
+  return edges;
+}
+
+std::vector<Edge> EdgeBuilder::build(const PolygonList &polygons,
+                                     size_t vertexCount,
+                                     std::vector<FaceGroup> &groups) {
+  if (groups.empty()) return build(polygons, vertexCount);
+  ScopedTimer timer(Stage::kEdges);
+  checkIndices(polygons, vertexCount);
+
+  // The same counting sort as build(), with the far end in the high half
+  // of each entry and the group in the low one, so a bucket sorts by
+  // (b, group) and the copies of an edge in several groups are adjacent,
+  // lowest group first.
+  auto forEachGroupHalfEdge = [&](auto &&fn) {
+    for (size_t g = 0; g < groups.size(); ++g) {
+      const FaceGroup &group = groups[g];
+      for (size_t f = group.firstFace; f < group.firstFace + group.faceCount;
+           ++f)
+        forEachHalfEdge(polygons[f], [&](unsigned a, unsigned b) {
+          fn(a, (uint64_t{b} << 32) | g);
+        });
+    }
+  };
+  std::vector<unsigned> start(vertexCount + 1, 0);
+  forEachGroupHalfEdge([&](unsigned a, uint64_t) { ++start[a + 1]; });
+  for (size_t v = 0; v < vertexCount; ++v) start[v + 1] += start[v];
+
+  std::vector<uint64_t> far(start.back());
+  {
+    std::vector<unsigned> fill(start.begin(), start.end() - 1);
+    forEachGroupHalfEdge([&](unsigned a, uint64_t b) { far[fill[a]++] = b; });
+  }
+
+  // Sort and deduplicate every bucket while counting each group's own and
+  // shared edges, then place them at the group's offsets in a second pass.
+  // An entry is shared if the one before it is the same edge.
+  auto shared = [&](size_t a, size_t i) {
+    return i > start[a] && far[i - 1] >> 32 == far[i] >> 32;
+  };
+  std::vector<unsigned> end(vertexCount);
+  std::vector<unsigned> own(groups.size(), 0);
+  std::vector<unsigned> copies(groups.size(), 0);
+  for (size_t a = 0; a < vertexCount; ++a) {
+    auto first = far.begin() + start[a];
+    auto last = far.begin() + start[a + 1];
+    std::sort(first, last);
+    last = std::unique(first, last);
+    end[a] = static_cast<unsigned>(last - far.begin());
+    for (size_t i = start[a]; i < end[a]; ++i)
+      ++(shared(a, i) ? copies : own)[far[i] & 0xffffffffu];
+  }
+  unsigned offset = 0;
+  for (size_t g = 0; g < groups.size(); ++g) {
+    groups[g].firstEdge = offset;
+    groups[g].edgeCount = own[g] + copies[g];
+    groups[g].sharedEdgeCount = copies[g];
+    own[g] = offset;
+    copies[g] = offset + groups[g].edgeCount - copies[g];
+    offset += groups[g].edgeCount;
+  }
+
+  std::vector<Edge> edges(offset);
+  for (size_t a = 0; a < vertexCount; ++a) {
+    for (size_t i = start[a]; i < end[a]; ++i) {
+      const size_t g = far[i] & 0xffffffffu;
+      edges[(shared(a, i) ? copies : own)[g]++] = {
+          static_cast<unsigned>(a), static_cast<unsigned>(far[i] >> 32)};
+    }
+  }
+  return edges;
+}
+
+}  // namespace s21
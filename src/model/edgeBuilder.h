@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "geometry.h"
+
+namespace s21 {
+
+// Extracts the unique undirected edges of a face list. Edges are bucketed by
+// their smaller vertex with a counting sort, so the pass is linear in the
+// number of half-edges and only needs one extra index per half-edge. The
+// result is ordered by (a, b).
+class EdgeBuilder {
+ public:
+  // Throws std::runtime_error if a face references a vertex outside
+  // [0, vertexCount).
+  static std::vector<Edge> build(const PolygonList &polygons,
+                                 size_t vertexCount);
+  // Edges per group: the edges of each group's faces are unique within the
+  // group and stored contiguously in group order, and firstEdge, edgeCount
+  // and sharedEdgeCount of every group are set. An edge shared by several
+  // groups is stored once for each, so hiding one leaves the others whole;
+  // the copies are placed after a group's own edges, which are the first
+  // group's copy, so the own parts of all groups hold every edge once.
+  // Both parts are ordered by (a, b). The groups must cover the faces in
+  // order; with none this is build().
+  static std::vector<Edge> build(const PolygonList &polygons,
+                                 size_t vertexCount,
+                                 std::vector<FaceGroup> &groups);
+};
+
+}  // namespace s21
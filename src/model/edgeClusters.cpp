@@ -0,0 +1,170 @@
+#include "edgeClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "morton.h"
+#include "profiler.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr float kInf = std::numeric_limits<float>::infinity();
+
+void expand(Bounds &b, const Vertex &v) {
+  b.min = {std::min(b.min.x, v.x), std::min(b.min.y, v.y),
+           std::min(b.min.z, v.z)};
+  b.max = {std::max(b.max.x, v.x), std::max(b.max.y, v.y),
+           std::max(b.max.z, v.z)};
+}
+
+unsigned reverseBits(unsigned v, int bits) {
+  unsigned r = 0;
+  for (int i = 0; i < bits; ++i, v >>= 1) r = (r << 1) | (v & 1u);
+  return r;
+}
+
+}  // namespace
+
+ViewBox viewBox(const Bounds &box, const AffineTransformer::Matrix &m) {
+  const Vertex center{(box.min.x + box.max.x) * 0.5f,
+                      (box.min.y + box.max.y) * 0.5f,
+                      (box.min.z + box.max.z) * 0.5f};
+  const Vertex half{(box.max.x - box.min.x) * 0.5f,
+                    (box.max.y - box.min.y) * 0.5f,
+                    (box.max.z - box.min.z) * 0.5f};
+  ViewBox out;
+  for (int i = 0; i < 3; ++i) {
+    out.center[i] = m[i][0] * center.x + m[i][1] * center.y +
+                    m[i][2] * center.z + m[i][3];
+    out.extent[i] = std::abs(m[i][0]) * half.x + std::abs(m[i][1]) * half.y +
+                    std::abs(m[i][2]) * half.z;
+  }
+  return out;
+}
+
+EdgeClusters::EdgeClusters(const std::vector<Vertex> &vertices,
+                           const std::vector<Edge> &edges,
+                           const std::vector<FaceGroup> &groups) {
+  if (edges.empty()) return;
+  Bounds range{{kInf, kInf, kInf}, {-kInf, -kInf, -kInf}};
+  for (const Vertex &v : vertices) expand(range, v);
+  std::vector<uint32_t> codes(edges.size());
+  for (size_t i = 0; i < edges.size(); ++i) {
+    const Vertex &a = vertices[edges[i].a], &b = vertices[edges[i].b];
+    codes[i] = mortonCode(
+        {(a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f}, range);
+  }
+  // Segments that clusters must not straddle: the own and the shared edges
+  // of every group, or all edges.
+  std::vector<Range> segments;
+  for (const FaceGroup &g : groups) {
+    if (g.ownEdgeCount()) segments.push_back({g.firstEdge, g.ownEdgeCount()});
+    if (g.sharedEdgeCount)
+      segments.push_back(
+          {g.firstEdge + g.ownEdgeCount(), g.sharedEdgeCount});
+  }
+  if (segments.empty())
+    segments.push_back({0, static_cast<unsigned>(edges.size())});
+
+  order_.resize(edges.size());
+  clusters_.reserve((edges.size() + kClusterEdges - 1) / kClusterEdges +
+                    segments.size());
+  std::vector<unsigned> sorted;
+  for (const Range &segment : segments) {
+    if (segments.size() == 1) {
+      sorted = sortByCode(codes);
+    } else {
+      std::vector<uint32_t> part(codes.begin() + segment.first,
+                                 codes.begin() + segment.first + segment.count);
+      sorted = sortByCode(part);
+      for (unsigned &i : sorted) i += segment.first;
+    }
+    const size_t segmentEnd = size_t{segment.first} + segment.count;
+    for (size_t first = segment.first; first < segmentEnd;
+         first += kClusterEdges) {
+      Cluster c;
+      c.first = static_cast<unsigned>(first);
+      c.count = static_cast<unsigned>(
+          std::min<size_t>(kClusterEdges, segmentEnd - first));
+      c.box = Bounds{{kInf, kInf, kInf}, {-kInf, -kInf, -kInf}};
+      int bits = 0;
+      while ((1u << bits) < c.count) ++bits;
+      // Bit-reversed positions of a partial last cluster skip the values at
+      // or above count.
+      unsigned slot = c.first;
+      for (unsigned j = 0; j < (1u << bits); ++j) {
+        const unsigned source = reverseBits(j, bits);
+        if (source >= c.count) continue;
+        const unsigned edge = sorted[c.first - segment.first + source];
+        order_[slot++] = edge;
+        const Vertex &a = vertices[edges[edge].a];
+        const Vertex &b = vertices[edges[edge].b];
+        expand(c.box, a);
+        expand(c.box, b);
+        c.maxEdgeLength = std::max(
+            c.maxEdgeLength, std::hypot(a.x - b.x, a.y - b.y, a.z - b.z));
+      }
+      clusters_.push_back(c);
+    }
+  }
+}
+
+size_t EdgeClusters::memoryBytes() const {
+  return clusters_.capacity() * sizeof(Cluster) +
+         order_.capacity() * sizeof(unsigned);
+}
+
+CullStats EdgeClusters::cull(const AffineTransformer::Matrix &m,
+                             float pixelsPerUnit,
+                             std::vector<Range> &ranges,
+                             const std::vector<Range> *visible) const {
+  ScopedTimer timer(Stage::kCull);
+  CullStats stats;
+  ranges.clear();
+  // The model matrix scales uniformly; lengths scale by its column norm.
+  const float scale =
+      std::sqrt(m[0][0] * m[0][0] + m[1][0] * m[1][0] + m[2][0] * m[2][0]);
+  size_t next = 0;  // first visible range not entirely before c
+  for (const Cluster &c : clusters_) {
+    if (visible) {
+      // Clusters lie inside one group, so c.first decides.
+      while (next < visible->size() &&
+             (*visible)[next].first + (*visible)[next].count <= c.first)
+        ++next;
+      if (next == visible->size()) break;
+      if (c.first < (*visible)[next].first) continue;
+    }
+    ++stats.clusters;
+    stats.edges += c.count;
+    const ViewBox box = viewBox(c.box, m);
+    if (box.outsideView()) {
+      ++stats.culledClusters;
+      continue;
+    }
+    const float *extent = box.extent;
+
+    unsigned count = c.count;
+    if (c.maxEdgeLength * scale * pixelsPerUnit < 1.f) {
+      // Sub-pixel edges can light at most the pixels under the box.
+      const float pixels = (2.f * extent[0] * pixelsPerUnit + 1.f) *
+                           (2.f * extent[1] * pixelsPerUnit + 1.f);
+      if (pixels < static_cast<float>(count)) {
+        count = std::max(1u, static_cast<unsigned>(std::ceil(pixels)));
+        ++stats.thinnedClusters;
+      }
+    }
+    stats.drawnEdges += count;
+    if (!ranges.empty() &&
+        ranges.back().first + ranges.back().count == c.first)
+      ranges.back().count += count;
+    else
+      ranges.push_back(Range{c.first, count});
+  }
+  return stats;
+}
+
+}  // namespace s21
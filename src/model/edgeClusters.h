@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "affineTransformer.h"
+#include "cullStats.h"
+#include "geometry.h"
+
+namespace s21 {
+
+// Enclosing box of a model space box under model matrix m: the center
+// moves with m, the half extent grows by |m|.
+struct ViewBox {
+  float center[3];
+  float extent[3];
+
+  // Entirely outside the glOrtho(-1, 1, -1, 1, -10, 10) volume.
+  bool outsideView() const {
+    return center[0] + extent[0] < -1.f || center[0] - extent[0] > 1.f ||
+           center[1] + extent[1] < -1.f || center[1] - extent[1] > 1.f ||
+           center[2] + extent[2] < -10.f || center[2] - extent[2] > 10.f;
+  }
+};
+ViewBox viewBox(const Bounds &box, const AffineTransformer::Matrix &m);
+
+// Spatially coherent groups of up to kClusterEdges edges with their model
+// space bounds, so a renderer can skip whole groups per frame. Edges are
+// grouped in Morton order of their midpoints. Within a group they are
+// stored in bit-reversed Morton order, which makes every prefix of a group
+// an evenly spread sample of it.
+//
+// Given FaceGroup edge ranges, clusters are formed inside the own and the
+// shared part of each group, so order() only permutes edges within a part
+// and a part's range of edges is also its range of order().
+class EdgeClusters {
+ public:
+  static constexpr unsigned kClusterEdges = 4096;
+
+  struct Cluster {
+    Bounds box;
+    unsigned first = 0;  // position in order()
+    unsigned count = 0;
+    float maxEdgeLength = 0.f;
+  };
+  // order()[first, first + count) is drawn.
+  struct Range {
+    unsigned first = 0;
+    unsigned count = 0;
+  };
+
+  EdgeClusters() = default;
+  EdgeClusters(const std::vector<Vertex> &vertices,
+               const std::vector<Edge> &edges,
+               const std::vector<FaceGroup> &groups = {});
+
+  const std::vector<Cluster> &clusters() const { return clusters_; }
+  // Edge indices, cluster by cluster.
+  const std::vector<unsigned> &order() const { return order_; }
+  size_t memoryBytes() const;
+
+  // Ranges of order() to draw under model matrix m in the
+  // glOrtho(-1, 1, -1, 1, -10, 10) volume, `pixelsPerUnit` pixels per
+  // normalized device unit. Clusters whose box misses the volume are
+  // skipped. In clusters whose longest edge projects below a pixel, only
+  // as many edges as the box covers pixels are kept. Adjacent ranges are
+  // merged; ranges is overwritten. If `visible` is set (ascending, disjoint
+  // group ranges), clusters outside it are skipped without a test and left
+  // out of the stats.
+  CullStats cull(const AffineTransformer::Matrix &m, float pixelsPerUnit,
+                 std::vector<Range> &ranges,
+                 const std::vector<Range> *visible = nullptr) const;
+
+ private:
+  std::vector<Cluster> clusters_;
+  std::vector<unsigned> order_;
+};
+
+}  // namespace s21
@@ -0,0 +1,160 @@
+#include "framebuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+namespace s21 {
+
+namespace {
+
+using File = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+File create(const std::string &filename) {
+  File file(std::fopen(filename.c_str(), "wb"), &std::fclose);
+  if (!file) throw std::runtime_error("Cannot create file: " + filename);
+  return file;
+}
+
+void finish(File &file, const std::string &filename) {
+  if (std::ferror(file.get()) || std::fflush(file.get()) != 0)
+    throw std::runtime_error("Cannot write file: " + filename);
+}
+
+uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      t[i] = c;
+    }
+    return t;
+  }();
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i)
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+uint32_t adler32(const uint8_t *data, size_t size) {
+  // 5552 is the longest run whose sums cannot overflow 32 bits.
+  uint32_t a = 1, b = 0;
+  while (size > 0) {
+    const size_t n = std::min<size_t>(size, 5552);
+    for (size_t i = 0; i < n; ++i) {
+      a += data[i];
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+    data += n;
+    size -= n;
+  }
+  return (b << 16) | a;
+}
+
+void putBigEndian(std::vector<uint8_t> &out, uint32_t v) {
+  out.push_back(uint8_t(v >> 24));
+  out.push_back(uint8_t(v >> 16));
+  out.push_back(uint8_t(v >> 8));
+  out.push_back(uint8_t(v));
+}
+
+void writeChunk(std::FILE *file, const char type[4],
+                const std::vector<uint8_t> &data) {
+  std::vector<uint8_t> chunk;
+  chunk.reserve(data.size() + 12);
+  putBigEndian(chunk, static_cast<uint32_t>(data.size()));
+  chunk.insert(chunk.end(), type, type + 4);
+  chunk.insert(chunk.end(), data.begin(), data.end());
+  putBigEndian(chunk, crc32(chunk.data() + 4, data.size() + 4));
+  std::fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+}  // namespace
+
+Framebuffer::Framebuffer(int width, int height) { resize(width, height); }
+
+void Framebuffer::resize(int width, int height) {
+  if (width <= 0 || height <= 0)
+    throw std::runtime_error("Invalid framebuffer size");
+  width_ = width;
+  height_ = height;
+  rgb_.assign(size_t(width) * height * 3, 0);
+  depth_.assign(size_t(width) * height, 1.f);
+}
+
+void Framebuffer::clear(Color color) {
+  for (size_t i = 0; i < rgb_.size(); i += 3) {
+    rgb_[i] = color.r;
+    rgb_[i + 1] = color.g;
+    rgb_[i + 2] = color.b;
+  }
+  std::fill(depth_.begin(), depth_.end(), 1.f);
+}
+
+void Framebuffer::writePpm(const std::string &filename) const {
+  File file = create(filename);
+  std::fprintf(file.get(), "P6\n%d %d\n255\n", width_, height_);
+  std::fwrite(rgb_.data(), 1, rgb_.size(), file.get());
+  finish(file, filename);
+}
+
+void Framebuffer::writePng(const std::string &filename) const {
+  File file = create(filename);
+  static const uint8_t kSignature[] = {0x89, 'P',  'N',  'G',
+                                       '\r', '\n', 0x1A, '\n'};
+  std::fwrite(kSignature, 1, sizeof(kSignature), file.get());
+
+  std::vector<uint8_t> header;
+  putBigEndian(header, static_cast<uint32_t>(width_));
+  putBigEndian(header, static_cast<uint32_t>(height_));
+  // 8-bit RGB, deflate, adaptive filtering, no interlace.
+  header.insert(header.end(), {8, 2, 0, 0, 0});
+  writeChunk(file.get(), "IHDR", header);
+
+  // Scanlines with filter type 0, wrapped in a zlib stream of stored
+  // blocks.
+  const size_t rowBytes = size_t(width_) * 3;
+  std::vector<uint8_t> raw;
+  raw.reserve((rowBytes + 1) * height_);
+  for (int y = 0; y < height_; ++y) {
+    raw.push_back(0);
+    raw.insert(raw.end(), rgb_.begin() + y * rowBytes,
+               rgb_.begin() + (y + 1) * rowBytes);
+  }
+  std::vector<uint8_t> zlib = {0x78, 0x01};
+  zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+  for (size_t pos = 0; pos < raw.size() || pos == 0;) {
+    const size_t len = std::min<size_t>(65535, raw.size() - pos);
+    const bool last = pos + len == raw.size();
+    zlib.push_back(last ? 1 : 0);
+    zlib.push_back(uint8_t(len));
+    zlib.push_back(uint8_t(len >> 8));
+    zlib.push_back(uint8_t(~len));
+    zlib.push_back(uint8_t(~len >> 8));
+    zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + len);
+    pos += len;
+    if (last) break;
+  }
+  putBigEndian(zlib, adler32(raw.data(), raw.size()));
+  writeChunk(file.get(), "IDAT", zlib);
+  writeChunk(file.get(), "IEND", {});
+  finish(file, filename);
+}
+
+void Framebuffer::write(const std::string &filename) const {
+  const size_t dot = filename.rfind('.');
+  std::string ext = dot == std::string::npos ? "" : filename.substr(dot);
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (ext == ".png")
+    writePng(filename);
+  else
+    writePpm(filename);
+}
+
+}  // namespace s21
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace s21 {
+
+struct Color {
+  uint8_t r = 0, g = 0, b = 0;
+
+  bool operator==(const Color &) const = default;
+};
+
+// 8-bit RGB image with a float depth buffer, rows stored top to bottom.
+class Framebuffer {
+ public:
+  Framebuffer() = default;
+  Framebuffer(int width, int height);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  void resize(int width, int height);
+  // Fills the color buffer and resets depth to 1 (the far plane), like
+  // glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT).
+  void clear(Color color);
+
+  Color pixel(int x, int y) const {
+    const uint8_t *p = &rgb_[(size_t(y) * width_ + x) * 3];
+    return Color{p[0], p[1], p[2]};
+  }
+  void setPixel(int x, int y, Color c) {
+    uint8_t *p = &rgb_[(size_t(y) * width_ + x) * 3];
+    p[0] = c.r;
+    p[1] = c.g;
+    p[2] = c.b;
+  }
+  float &depth(int x, int y) { return depth_[size_t(y) * width_ + x]; }
+  const std::vector<uint8_t> &rgb() const { return rgb_; }
+
+  // Both throw std::runtime_error on I/O errors. PNG output is uncompressed
+  // (stored deflate blocks), so no zlib is needed.
+  void writePpm(const std::string &filename) const;
+  void writePng(const std::string &filename) const;
+  // Picks the format from the extension: ".png", anything else is PPM.
+  void write(const std::string &filename) const;
+
+ private:
+  int width_ = 0;
+  int height_ = 0;
+  std::vector<uint8_t> rgb_;
+  std::vector<float> depth_;
+};
+
+}  // namespace s21
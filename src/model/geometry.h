@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace s21 {
+
+struct Vertex {
+  float x, y, z;
+};
+
+// Axis-aligned bounding box.
+struct Bounds {
+  Vertex min{0.f, 0.f, 0.f};
+  Vertex max{0.f, 0.f, 0.f};
+};
+
+// Undirected edge between two vertices, stored with a < b. Arrays of edges
+// are laid out as packed index pairs and can be drawn as GL_LINES directly.
+struct Edge {
+  unsigned int a, b;
+};
+
+// Vertex indices of one face; a view into the PolygonList that owns them.
+using Polygon = std::span<const unsigned int>;
+
+// Face topology in CSR form: the indices of all faces back to back, plus
+// offsets_[i]..offsets_[i + 1] delimiting face i. A mesh of any size costs
+// two allocations and 4 bytes per face on top of its indices.
+class PolygonList {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Polygon;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Polygon;
+
+    const_iterator() = default;
+    const_iterator(const unsigned int *indices, const unsigned int *offset)
+        : indices_(indices), offset_(offset) {}
+
+    Polygon operator*() const {
+      return {indices_ + offset_[0], offset_[1] - offset_[0]};
+    }
+    const_iterator &operator++() {
+      ++offset_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++offset_;
+      return tmp;
+    }
+    bool operator==(const const_iterator &other) const {
+      return offset_ == other.offset_;
+    }
+
+   private:
+    const unsigned int *indices_ = nullptr;
+    const unsigned int *offset_ = nullptr;
+  };
+
+  size_t size() const { return offsets_.size() - 1; }
+  bool empty() const { return size() == 0; }
+  Polygon operator[](size_t i) const {
+    return {indices_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]};
+  }
+  const_iterator begin() const {
+    return {indices_.data(), offsets_.data()};
+  }
+  const_iterator end() const {
+    return {indices_.data(), offsets_.data() + size()};
+  }
+
+  const std::vector<unsigned int> &indices() const { return indices_; }
+  const std::vector<unsigned int> &offsets() const { return offsets_; }
+
+  void addPolygon(Polygon polygon) {
+    indices_.insert(indices_.end(), polygon.begin(), polygon.end());
+    commitPolygon();
+  }
+
+  // Incremental construction used by the parser: indices are appended to a
+  // pending face that is then either committed or discarded.
+  void appendIndex(unsigned int index) { indices_.push_back(index); }
+  // Overwrites a stored index, for indices the parser resolves late.
+  void setIndex(size_t position, unsigned int index) {
+    indices_[position] = index;
+  }
+  size_t pendingSize() const { return indices_.size() - offsets_.back(); }
+  void commitPolygon() {
+    offsets_.push_back(static_cast<unsigned int>(indices_.size()));
+  }
+  void discardPending() { indices_.resize(offsets_.back()); }
+
+  // Appends every face of other, rebasing its offsets.
+  void append(const PolygonList &other) {
+    const unsigned int base = offsets_.back();
+    indices_.insert(indices_.end(), other.indices_.begin(),
+                    other.indices_.end());
+    offsets_.reserve(offsets_.size() + other.size());
+    for (size_t i = 1; i < other.offsets_.size(); ++i)
+      offsets_.push_back(base + other.offsets_[i]);
+  }
+
+  // Replaces the contents with raw CSR arrays; offsets has size() + 1
+  // entries and starts at 0.
+  void assign(const unsigned int *indices, size_t indexCount,
+              const unsigned int *offsets, size_t offsetCount) {
+    indices_.assign(indices, indices + indexCount);
+    offsets_.assign(offsets, offsets + offsetCount);
+  }
+
+  void reserve(size_t polygons, size_t indices) {
+    offsets_.reserve(polygons + 1);
+    indices_.reserve(indices);
+  }
+  void clear() {
+    indices_.clear();
+    offsets_.assign(1, 0);
+  }
+
+ private:
+  std::vector<unsigned int> indices_;
+  std::vector<unsigned int> offsets_{0};
+};
+
+// A part of an OBJ file: a run of faces under the same "o", "g" and
+// "usemtl" statements, stored as ranges instead of copies. Faces
+// [firstFace, firstFace + faceCount) of the PolygonList belong to it, and
+// once edges are built per group (EdgeBuilder), so do edges
+// [firstEdge, firstEdge + edgeCount). The last sharedEdgeCount of them
+// are copies of edges stored by an earlier group as well, and are left
+// out when every group is drawn.
+struct FaceGroup {
+  std::string object;
+  std::string group;
+  std::string material;
+  unsigned int firstFace = 0;
+  unsigned int faceCount = 0;
+  unsigned int firstEdge = 0;
+  unsigned int edgeCount = 0;
+  unsigned int sharedEdgeCount = 0;
+
+  unsigned int ownEdgeCount() const { return edgeCount - sharedEdgeCount; }
+};
+
+}  // namespace s21
@@ -0,0 +1,51 @@
+#include "hash.h"
+
+#include <cstring>
+
+namespace s21 {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const unsigned char *p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+  acc += input * kPrime2;
+  return rotl(acc, 31) * kPrime1;
+}
+
+}  // namespace
+
+uint64_t hashBytes(const void *data, size_t size, uint64_t seed) {
+  const auto *p = static_cast<const unsigned char *>(data);
+  const unsigned char *end = p + size;
+
+  uint64_t lanes[4] = {seed + kPrime1 + kPrime2, seed + kPrime2, seed,
+                       seed - kPrime1};
+  for (; end - p >= 32; p += 32) {
+    for (int i = 0; i < 4; ++i) lanes[i] = round(lanes[i], read64(p + 8 * i));
+  }
+
+  uint64_t h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) +
+               rotl(lanes[3], 18) + static_cast<uint64_t>(size);
+  for (; end - p >= 8; p += 8) h = rotl(h ^ round(0, read64(p)), 27) * kPrime1;
+  for (; p < end; ++p) h = rotl(h ^ (*p * kPrime3), 11) * kPrime1;
+
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+}  // namespace s21
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace s21 {
+
+// Fast non-cryptographic 64-bit hash used to fingerprint model files and
+// cache payloads. Four independent multiply-rotate lanes over 8-byte words
+// keep it at memory speed on large buffers.
+uint64_t hashBytes(const void *data, size_t size, uint64_t seed = 0);
+
+}  // namespace s21
@@ -0,0 +1,83 @@
+#include "localityReorder.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "edgeBuilder.h"
+#include "morton.h"
+
+namespace s21 {
+
+std::vector<unsigned> LocalityReorder::apply(Mesh &mesh) {
+  const size_t count = mesh.vertices.size();
+  std::vector<uint32_t> codes(count);
+  for (size_t i = 0; i < count; ++i)
+    codes[i] = mortonCode(mesh.vertices[i], mesh.bounds);
+  const std::vector<unsigned> order = sortByCode(codes);
+  codes = {};
+
+  std::vector<unsigned> remap(count);
+  {
+    std::vector<Vertex> vertices(count);
+    for (size_t i = 0; i < count; ++i) {
+      vertices[i] = mesh.vertices[order[i]];
+      remap[order[i]] = static_cast<unsigned>(i);
+    }
+    mesh.vertices.swap(vertices);
+  }
+
+  // Renumber the face indices in file order, then order the faces by
+  // their lowest new vertex with the radix sort used for the codes (keys
+  // below 2^30, so up to a billion vertices). Faces of a group stay inside
+  // its range.
+  const PolygonList &polygons = mesh.polygons;
+  const std::vector<unsigned> &offsets = polygons.offsets();
+  const size_t faces = polygons.size();
+  std::vector<unsigned> renumbered(polygons.indices().size());
+  for (size_t i = 0; i < renumbered.size(); ++i)
+    renumbered[i] = remap[polygons.indices()[i]];
+  std::vector<uint32_t> keys(faces, 0);
+  for (size_t f = 0; f < faces; ++f) {
+    if (offsets[f] == offsets[f + 1]) continue;
+    keys[f] = *std::min_element(renumbered.begin() + offsets[f],
+                                renumbered.begin() + offsets[f + 1]);
+  }
+  std::vector<unsigned> faceOrder;
+  if (mesh.groups.empty()) {
+    faceOrder = sortByCode(keys);
+  } else {
+    faceOrder.reserve(faces);
+    for (const FaceGroup &g : mesh.groups) {
+      std::vector<uint32_t> part(keys.begin() + g.firstFace,
+                                 keys.begin() + g.firstFace + g.faceCount);
+      for (unsigned f : sortByCode(part)) faceOrder.push_back(g.firstFace + f);
+    }
+  }
+  keys = {};
+
+  std::vector<unsigned> newOffsets(faces + 1, 0);
+  for (size_t i = 0; i < faces; ++i) {
+    const unsigned f = faceOrder[i];
+    newOffsets[i + 1] = newOffsets[i] + (offsets[f + 1] - offsets[f]);
+  }
+  std::vector<unsigned> indices(renumbered.size());
+  for (size_t i = 0; i < faces; ++i) {
+    const unsigned f = faceOrder[i];
+    std::copy(renumbered.begin() + offsets[f],
+              renumbered.begin() + offsets[f + 1],
+              indices.begin() + newOffsets[i]);
+  }
+  renumbered = {};
+  mesh.polygons.assign(indices.data(), indices.size(), newOffsets.data(),
+                       newOffsets.size());
+  indices = {};
+
+  if (!mesh.edges.empty())
+    mesh.edges = EdgeBuilder::build(mesh.polygons, count, mesh.groups);
+  mesh.lods.clear();
+  mesh.pickIndex.reset();
+  mesh.edgeClusters.clear();
+  return remap;
+}
+
+}  // namespace s21
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "mesh.h"
+
+namespace s21 {
+
+// Renumbers a mesh for memory locality. OBJ exporters write vertices and
+// faces in arbitrary order, so passes that chase indices (edge drawing,
+// picking, per-face work) jump all over the vertex array. Here vertices are
+// sorted along a Morton curve over mesh.bounds, faces by their lowest vertex
+// in the new order and edges are rebuilt, which leaves them ordered by
+// (a, b) as well: consecutive edges then touch neighbouring vertices.
+// FaceGroup ranges are kept: faces are only sorted within their group.
+//
+// The pass is linear in the mesh size (radix sorts only); while it runs
+// it holds a second copy of the vertices and two of the face indices.
+class LocalityReorder {
+ public:
+  // Returns the new index of every old vertex. LODs, the picking index and
+  // edge clusters are built over the old numbering and are dropped; build
+  // them afterwards.
+  static std::vector<unsigned> apply(Mesh &mesh);
+};
+
+}  // namespace s21
@@ -0,0 +1,138 @@
+#include "lodBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "profiler.h"
+
+namespace s21 {
+
+namespace {
+
+// Vertices with their cluster weights and the edges between them.
+struct Cluster {
+  std::vector<Vertex> vertices;
+  std::vector<unsigned> weights;
+  std::vector<Edge> edges;
+};
+
+// Merges the vertices of `in` sharing a cell of a grid x grid x grid lattice
+// over bounds.
+Cluster cluster(const Cluster &in, const Bounds &bounds, unsigned grid) {
+  const float extent = std::max({bounds.max.x - bounds.min.x,
+                                 bounds.max.y - bounds.min.y,
+                                 bounds.max.z - bounds.min.z, 1e-20f});
+  const float toCell = grid / extent;
+  auto cellOf = [&](float v, float min) {
+    return std::min<uint64_t>(grid - 1, uint64_t((v - min) * toCell));
+  };
+
+  // Open-addressing table from cell key to cluster index; clusters are
+  // numbered in order of first appearance.
+  const size_t n = in.vertices.size();
+  size_t capacity = 16;
+  while (capacity < n * 2) capacity *= 2;
+  constexpr uint64_t kEmpty = ~uint64_t{0};
+  std::vector<uint64_t> keys(capacity, kEmpty);
+  std::vector<unsigned> slots(capacity);
+  std::vector<unsigned> remap(n);
+  std::vector<double> sums;
+  sums.reserve(n);  // grows to 3 per cluster
+
+  Cluster out;
+  for (size_t i = 0; i < n; ++i) {
+    const Vertex &v = in.vertices[i];
+    const uint64_t key =
+        (cellOf(v.x, bounds.min.x) * grid + cellOf(v.y, bounds.min.y)) * grid +
+        cellOf(v.z, bounds.min.z);
+    size_t slot = (key * 0x9E3779B97F4A7C15ull >> 32) & (capacity - 1);
+    while (keys[slot] != kEmpty && keys[slot] != key)
+      slot = (slot + 1) & (capacity - 1);
+    if (keys[slot] == kEmpty) {
+      keys[slot] = key;
+      slots[slot] = static_cast<unsigned>(out.weights.size());
+      out.weights.push_back(0);
+      sums.insert(sums.end(), {0.0, 0.0, 0.0});
+    }
+    const unsigned c = slots[slot];
+    const double w = in.weights[i];
+    sums[c * 3] += v.x * w;
+    sums[c * 3 + 1] += v.y * w;
+    sums[c * 3 + 2] += v.z * w;
+    out.weights[c] += in.weights[i];
+    remap[i] = c;
+  }
+  out.vertices.resize(out.weights.size());
+  for (size_t c = 0; c < out.vertices.size(); ++c) {
+    const double inv = 1.0 / out.weights[c];
+    out.vertices[c] = {float(sums[c * 3] * inv), float(sums[c * 3 + 1] * inv),
+                       float(sums[c * 3 + 2] * inv)};
+  }
+
+  // Remapped edges, deduplicated with the counting sort EdgeBuilder uses:
+  // bucket by the smaller end, then sort each (short) bucket.
+  const size_t clusters = out.vertices.size();
+  std::vector<unsigned> start(clusters + 1, 0);
+  auto forEachEdge = [&](auto &&fn) {
+    for (const Edge &e : in.edges) {
+      unsigned a = remap[e.a], b = remap[e.b];
+      if (a == b) continue;
+      if (a > b) std::swap(a, b);
+      fn(a, b);
+    }
+  };
+  forEachEdge([&](unsigned a, unsigned) { ++start[a + 1]; });
+  for (size_t c = 0; c < clusters; ++c) start[c + 1] += start[c];
+  std::vector<unsigned> far(start.back());
+  {
+    std::vector<unsigned> fill(start.begin(), start.end() - 1);
+    forEachEdge([&](unsigned a, unsigned b) { far[fill[a]++] = b; });
+  }
+  out.edges.reserve(far.size());
+  for (size_t a = 0; a < clusters; ++a) {
+    auto first = far.begin() + start[a];
+    auto last = far.begin() + start[a + 1];
+    std::sort(first, last);
+    last = std::unique(first, last);
+    for (auto it = first; it != last; ++it)
+      out.edges.push_back({static_cast<unsigned>(a), *it});
+  }
+  return out;
+}
+
+}  // namespace
+
+std::vector<LodLevel> LodBuilder::build(const Mesh &mesh) {
+  ScopedTimer timer(Stage::kLod);
+  std::vector<LodLevel> levels;
+  if (mesh.vertices.empty() || mesh.edges.empty()) return levels;
+
+  const Bounds &b = mesh.bounds;
+  const float extent = std::max(
+      {b.max.x - b.min.x, b.max.y - b.min.y, b.max.z - b.min.z, 1e-20f});
+
+  Cluster current{mesh.vertices, std::vector<unsigned>(mesh.vertices.size(), 1),
+                  mesh.edges};
+  size_t lastEdges = uniqueEdgeCount(mesh);
+  for (unsigned grid = kFinestGrid; grid >= kCoarsestGrid; grid /= 2) {
+    current = cluster(current, b, grid);
+    if (current.edges.empty()) break;
+    if (current.edges.size() * 4 > lastEdges * 3) continue;
+    // A cluster mean stays inside its cell, so no vertex moves further
+    // than the cell diagonal.
+    const float error = extent / grid * std::sqrt(3.f);
+    levels.push_back(LodLevel{current.vertices, current.edges, error});
+    lastEdges = current.edges.size();
+  }
+  return levels;
+}
+
+size_t LodBuilder::select(const std::vector<LodLevel> &lods,
+                          float pixelsPerError, float threshold) {
+  for (size_t level = lods.size(); level > 0; --level)
+    if (lods[level - 1].error * pixelsPerError <= threshold) return level;
+  return 0;
+}
+
+}  // namespace s21
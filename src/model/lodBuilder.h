@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mesh.h"
+
+namespace s21 {
+
+// Builds a level-of-detail pyramid by vertex clustering: vertices are
+// snapped to a uniform grid over the normalized bounding box and every
+// occupied cell is replaced by the mean of its vertices. Grids halve in
+// resolution from level to level and nest, so each level is clustered from
+// the previous one (weighted by vertex counts) and costs time proportional
+// to that level, not to the full mesh.
+class LodBuilder {
+ public:
+  // Finest grid tried; coarser ones are kFinestGrid / 2, / 4, ...
+  static constexpr unsigned kFinestGrid = 512;
+  static constexpr unsigned kCoarsestGrid = 8;
+
+  // Levels keeping less than 3/4 of the previous level's edges are kept,
+  // others are skipped (they would cost nearly as much to draw).
+  static std::vector<LodLevel> build(const Mesh &mesh);
+  // Coarsest level (0 = full mesh, i = lods[i - 1]) whose error stays
+  // within threshold pixels when one normalized unit covers
+  // pixelsPerError pixels.
+  static size_t select(const std::vector<LodLevel> &lods, float pixelsPerError,
+                       float threshold);
+};
+
+}  // namespace s21
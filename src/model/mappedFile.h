@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace s21 {
+
+// Size and modification time of a file, to tell whether it changed since
+// something was derived from it.
+struct FileStamp {
+  uint64_t size = 0;
+  int64_t mtimeNs = 0;
+
+  bool operator==(const FileStamp &other) const = default;
+};
+
+// Returns false if the file cannot be stat'ed.
+bool fileStamp(const std::string &filename, FileStamp &stamp);
+
+// Read-only memory mapping of a whole file. The contents stay valid for the
+// lifetime of the object; an empty file maps to an empty view.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  std::string_view view() const;
+  const char *data() const;
+  size_t size() const;
+
+ private:
+  void release();
+
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace s21
@@ -0,0 +1,116 @@
+#include "mesh.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "edgeClusters.h"
+#include "profiler.h"
+#include "spatialIndex.h"
+#include "threadPool.h"
+
+namespace s21 {
+
+Bounds normalizeVertices(std::vector<Vertex> &vertices, unsigned threads) {
+  ScopedTimer timer(Stage::kNormalize);
+  if (vertices.empty()) return Bounds{};
+
+  // Min and max are exact, so the blocks merge to the serial result.
+  constexpr float kMax = std::numeric_limits<float>::max();
+  constexpr float kLowest = std::numeric_limits<float>::lowest();
+  ThreadPool &pool = ThreadPool::shared();
+  std::vector<Bounds> blocks(ThreadPool::blockCount(vertices.size()));
+  pool.parallelBlocks(
+      vertices.size(), threads, [&](size_t block, size_t begin, size_t end) {
+        Bounds b{{kMax, kMax, kMax}, {kLowest, kLowest, kLowest}};
+        for (size_t i = begin; i < end; ++i) {
+          const Vertex &v = vertices[i];
+          b.min = {std::min(b.min.x, v.x), std::min(b.min.y, v.y),
+                   std::min(b.min.z, v.z)};
+          b.max = {std::max(b.max.x, v.x), std::max(b.max.y, v.y),
+                   std::max(b.max.z, v.z)};
+        }
+        blocks[block] = b;
+      });
+  Bounds box = blocks.front();
+  for (const Bounds &b : blocks) {
+    box.min = {std::min(box.min.x, b.min.x), std::min(box.min.y, b.min.y),
+               std::min(box.min.z, b.min.z)};
+    box.max = {std::max(box.max.x, b.max.x), std::max(box.max.y, b.max.y),
+               std::max(box.max.z, b.max.z)};
+  }
+  const float minX = box.min.x, minY = box.min.y, minZ = box.min.z;
+  const float maxX = box.max.x, maxY = box.max.y, maxZ = box.max.z;
+
+  float scale = std::max({maxX - minX, maxY - minY, maxZ - minZ});
+  if (scale == 0.f) scale = 1.f;
+
+  float cx = (maxX + minX) * 0.5f;
+  float cy = (maxY + minY) * 0.5f;
+  float cz = (maxZ + minZ) * 0.5f;
+
+  pool.parallelBlocks(
+      vertices.size(), threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          Vertex &v = vertices[i];
+          v.x = (v.x - cx) / scale;
+          v.y = (v.y - cy) / scale;
+          v.z = (v.z - cz) / scale;
+        }
+      });
+
+  // The mapping is monotonic per axis, so the old extremes map exactly onto
+  // the new ones.
+  Bounds b;
+  b.min = {(minX - cx) / scale, (minY - cy) / scale, (minZ - cz) / scale};
+  b.max = {(maxX - cx) / scale, (maxY - cy) / scale, (maxZ - cz) / scale};
+  return b;
+}
+
+size_t uniqueEdgeCount(const Mesh &mesh) {
+  size_t shared = 0;
+  for (const FaceGroup &g : mesh.groups) shared += g.sharedEdgeCount;
+  return mesh.edges.size() - shared;
+}
+
+size_t memoryBytes(const Mesh &mesh) {
+  auto bytes = [](const auto &v) { return v.capacity() * sizeof(v[0]); };
+  size_t total = bytes(mesh.vertices) + bytes(mesh.polygons.indices()) +
+                 bytes(mesh.polygons.offsets()) + bytes(mesh.edges) +
+                 bytes(mesh.groups);
+  if (mesh.pickIndex) total += mesh.pickIndex->memoryBytes();
+  for (const auto &clusters : mesh.edgeClusters)
+    if (clusters) total += clusters->memoryBytes();
+  for (const LodLevel &l : mesh.lods)
+    total += bytes(l.vertices) + bytes(l.edges);
+  return total;
+}
+
+Vertex centroid(const std::vector<Vertex> &vertices, unsigned threads) {
+  if (vertices.empty()) return Vertex{0.f, 0.f, 0.f};
+  struct Sum {
+    double x = 0.0, y = 0.0, z = 0.0;
+  };
+  std::vector<Sum> blocks(ThreadPool::blockCount(vertices.size()));
+  ThreadPool::shared().parallelBlocks(
+      vertices.size(), threads, [&](size_t block, size_t begin, size_t end) {
+        Sum s;
+        for (size_t i = begin; i < end; ++i) {
+          s.x += vertices[i].x;
+          s.y += vertices[i].y;
+          s.z += vertices[i].z;
+        }
+        blocks[block] = s;
+      });
+  Sum total;
+  for (const Sum &s : blocks) {
+    total.x += s.x;
+    total.y += s.y;
+    total.z += s.z;
+  }
+  const double inv = 1.0 / static_cast<double>(vertices.size());
+  return Vertex{static_cast<float>(total.x * inv),
+                static_cast<float>(total.y * inv),
+                static_cast<float>(total.z * inv)};
+}
+
+}  // namespace s21
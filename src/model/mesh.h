@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "geometry.h"
+
+namespace s21 {
+
+class EdgeClusters;
+class SpatialIndex;
+
+// Simplified copy of a mesh, for drawing when the full one would be
+// smaller than a pixel per edge.
+struct LodLevel {
+  std::vector<Vertex> vertices;
+  std::vector<Edge> edges;
+  // Upper bound on how far a vertex moved, in normalized model units.
+  float error = 0.f;
+};
+
+// Geometry of a loaded model after parsing and normalization. It does not
+// depend on the current transform.
+struct Mesh {
+  std::vector<Vertex> vertices;
+  PolygonList polygons;
+  std::vector<Edge> edges;
+  // Parts named by "o", "g" and "usemtl" statements, in face order; empty
+  // if the file has none. When present, edges are stored group by group.
+  std::vector<FaceGroup> groups;
+  Bounds bounds;
+  // hashBytes() of the source file, 0 if it was not computed.
+  uint64_t sourceHash = 0;
+  // Coarser versions, finest first; empty unless requested at load time.
+  std::vector<LodLevel> lods;
+  // Picking index over vertices and polygons; built on demand when null.
+  std::shared_ptr<const SpatialIndex> pickIndex;
+  // Culling clusters of the full mesh and of each LOD level (finest first);
+  // a missing or null entry is built on demand.
+  std::vector<std::shared_ptr<const EdgeClusters>> edgeClusters;
+
+  // Releases the storage too. Every array is a single block (faces are in
+  // CSR form), so this is a handful of frees whatever the mesh size.
+  void clear() { *this = Mesh{}; }
+};
+
+// Centers the vertices on the origin and scales them uniformly so the
+// largest extent becomes 1. Returns the bounding box after the mapping.
+// Large inputs run on up to `threads` threads of ThreadPool::shared() (0
+// uses every core) with the same result as one thread.
+Bounds normalizeVertices(std::vector<Vertex> &vertices, unsigned threads = 0);
+
+// Mean of the vertices (the origin for an empty list); models rotate and
+// scale about it. Summed in double per ThreadPool block and the blocks in
+// order, so the result does not depend on the thread count.
+Vertex centroid(const std::vector<Vertex> &vertices, unsigned threads = 0);
+
+// Distinct edges of the full mesh: edges shared by several groups are
+// stored once per group but counted once.
+size_t uniqueEdgeCount(const Mesh &mesh);
+
+// Heap bytes held by the mesh, including its LODs and indices.
+size_t memoryBytes(const Mesh &mesh);
+
+}  // namespace s21
@@ -0,0 +1,123 @@
+#include "meshCache.h"
+
+#include <utility>
+
+namespace s21 {
+
+MeshCache::MeshCache(size_t budgetBytes)
+    : budget_(budgetBytes), reclaimer_([this] { reclaimLoop(); }) {}
+
+MeshCache::~MeshCache() {
+  {
+    std::lock_guard<std::mutex> lock(reclaimMutex_);
+    stop_ = true;
+  }
+  reclaimWake_.notify_one();
+  reclaimer_.join();
+}
+
+void MeshCache::setBudget(size_t bytes) {
+  budget_ = bytes;
+  evictToBudget();
+}
+
+size_t MeshCache::budget() const { return budget_; }
+
+std::optional<Mesh> MeshCache::take(const std::string &filename,
+                                    FileStamp *stamp) {
+  auto it = entries_.find(filename);
+  if (it == entries_.end()) {
+    ++stats_.misses;
+    return std::nullopt;
+  }
+  FileStamp now;
+  if (!fileStamp(filename, now) || !(now == it->second.stamp)) {
+    ++stats_.misses;
+    ++stats_.invalidations;
+    erase(it);
+    return std::nullopt;
+  }
+  ++stats_.hits;
+  if (stamp) *stamp = now;
+  Mesh mesh = std::move(it->second.mesh);
+  bytes_ -= it->second.bytes;
+  lru_.erase(it->second.use);
+  entries_.erase(it);
+  return mesh;
+}
+
+void MeshCache::put(const std::string &filename, const FileStamp &stamp,
+                    Mesh mesh) {
+  if (auto it = entries_.find(filename); it != entries_.end()) erase(it);
+  const size_t bytes = memoryBytes(mesh);
+  if (bytes > budget_) {
+    reclaim(std::move(mesh));
+    return;
+  }
+  lru_.push_front(filename);
+  entries_.emplace(filename,
+                   Entry{stamp, std::move(mesh), bytes, lru_.begin()});
+  bytes_ += bytes;
+  evictToBudget();
+}
+
+bool MeshCache::contains(const std::string &filename) const {
+  return entries_.count(filename) != 0;
+}
+
+void MeshCache::clear() {
+  while (!entries_.empty()) erase(entries_.begin());
+}
+
+MeshCacheStats MeshCache::stats() const {
+  MeshCacheStats s = stats_;
+  s.entries = entries_.size();
+  s.bytes = bytes_;
+  s.budgetBytes = budget_;
+  return s;
+}
+
+void MeshCache::waitReclaimed() {
+  std::unique_lock<std::mutex> lock(reclaimMutex_);
+  reclaimDone_.wait(lock, [this] { return garbage_.empty() && !reclaiming_; });
+}
+
+void MeshCache::erase(std::unordered_map<std::string, Entry>::iterator it) {
+  bytes_ -= it->second.bytes;
+  lru_.erase(it->second.use);
+  reclaim(std::move(it->second.mesh));
+  entries_.erase(it);
+}
+
+void MeshCache::evictToBudget() {
+  while (bytes_ > budget_ && !lru_.empty()) {
+    ++stats_.evictions;
+    erase(entries_.find(lru_.back()));
+  }
+}
+
+void MeshCache::reclaim(Mesh mesh) {
+  {
+    std::lock_guard<std::mutex> lock(reclaimMutex_);
+    garbage_.push_back(std::move(mesh));
+  }
+  reclaimWake_.notify_one();
+}
+
+void MeshCache::reclaimLoop() {
+  std::unique_lock<std::mutex> lock(reclaimMutex_);
+  for (;;) {
+    reclaimWake_.wait(lock, [this] { return stop_ || !garbage_.empty(); });
+    if (garbage_.empty()) return;  // stop_ with nothing left to free
+    std::vector<Mesh> batch;
+    batch.swap(garbage_);
+    reclaiming_ = true;
+    lock.unlock();
+    batch.clear();
+    lock.lock();
+    reclaiming_ = false;
+    reclaimDone_.notify_all();
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "mappedFile.h"
+#include "mesh.h"
+
+namespace s21 {
+
+struct MeshCacheStats {
+  size_t hits = 0;
+  // Lookups of files not cached, including stale entries.
+  size_t misses = 0;
+  // Entries dropped because the file changed.
+  size_t invalidations = 0;
+  // Entries dropped to stay within the budget.
+  size_t evictions = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+  size_t budgetBytes = 0;
+};
+
+// In-memory LRU cache of loaded meshes, keyed by path and valid only while
+// the file keeps the size and modification time it had when it was loaded.
+// Meshes are moved in and out, never copied, so switching back to a cached
+// file costs O(1) plus a stat() call.
+//
+// The total memoryBytes() of the cached meshes stays within the budget;
+// least recently stored entries go first, and a mesh larger than the whole
+// budget is not kept. Dropped meshes are freed on a background thread, so
+// neither take() nor put() waits for large deallocations. Not thread-safe:
+// use from one thread.
+class MeshCache {
+ public:
+  static constexpr size_t kDefaultBudget = size_t{1} << 30;
+
+  explicit MeshCache(size_t budgetBytes = kDefaultBudget);
+  ~MeshCache();
+
+  MeshCache(const MeshCache &) = delete;
+  MeshCache &operator=(const MeshCache &) = delete;
+
+  // Shrinking the budget evicts right away.
+  void setBudget(size_t bytes);
+  size_t budget() const;
+
+  // Removes and returns the mesh of filename if the file is unchanged since
+  // put(), and its stamp if requested; a stale entry is dropped and
+  // reported as a miss.
+  std::optional<Mesh> take(const std::string &filename,
+                           FileStamp *stamp = nullptr);
+  // Stores the mesh loaded from filename while it had the given stamp,
+  // replacing any older entry for the file.
+  void put(const std::string &filename, const FileStamp &stamp, Mesh mesh);
+  bool contains(const std::string &filename) const;
+  void clear();
+
+  MeshCacheStats stats() const;
+  // Blocks until the background thread has freed everything dropped so
+  // far; for tests and shutdown.
+  void waitReclaimed();
+
+ private:
+  struct Entry {
+    FileStamp stamp;
+    Mesh mesh;
+    size_t bytes = 0;
+    // Position in lru_.
+    std::list<std::string>::iterator use;
+  };
+
+  void erase(std::unordered_map<std::string, Entry>::iterator it);
+  void evictToBudget();
+  void reclaim(Mesh mesh);
+  void reclaimLoop();
+
+  size_t budget_;
+  size_t bytes_ = 0;
+  std::unordered_map<std::string, Entry> entries_;
+  // Most recently stored first.
+  std::list<std::string> lru_;
+  MeshCacheStats stats_;
+
+  // Meshes waiting to be freed by reclaimer_.
+  std::mutex reclaimMutex_;
+  std::condition_variable reclaimWake_;
+  std::condition_variable reclaimDone_;
+  std::vector<Mesh> garbage_;
+  bool reclaiming_ = false;
+  bool stop_ = false;
+  std::thread reclaimer_;
+};
+
+}  // namespace s21
@@ -0,0 +1,69 @@
+#include "meshLoader.h"
+
+#include "edgeBuilder.h"
+#include "edgeClusters.h"
+#include "hash.h"
+#include "localityReorder.h"
+#include "lodBuilder.h"
+#include "mappedFile.h"
+#include "modelCache.h"
+#include "profiler.h"
+#include "spatialIndex.h"
+
+namespace s21 {
+
+namespace {
+
+// Optional acceleration structures over the finished mesh.
+void buildIndices(Mesh &mesh, const LoadOptions &options) {
+  if (options.buildPickIndex)
+    mesh.pickIndex =
+        std::make_shared<SpatialIndex>(mesh.vertices, mesh.polygons);
+  if (options.buildEdgeClusters) {
+    mesh.edgeClusters.push_back(std::make_shared<EdgeClusters>(
+        mesh.vertices, mesh.edges, mesh.groups));
+    for (const LodLevel &level : mesh.lods)
+      mesh.edgeClusters.push_back(
+          std::make_shared<EdgeClusters>(level.vertices, level.edges));
+  }
+}
+
+}  // namespace
+
+Mesh MeshLoader::load(const std::string &filename, const LoadOptions &options,
+                      bool *fromCache) {
+  ScopedTimer timer(Stage::kLoad);
+  Mesh mesh;
+  if (fromCache) *fromCache = false;
+
+  if (options.useCache && ModelCache::load(filename, mesh)) {
+    if (fromCache) *fromCache = true;
+    if (options.reorder) LocalityReorder::apply(mesh);
+    if (options.buildLods) mesh.lods = LodBuilder::build(mesh);
+    buildIndices(mesh, options);
+    return mesh;
+  }
+
+  {
+    // The touched pages of the mapping count as resident memory, as much
+    // as the text itself; unmapping before the edges are built keeps them
+    // out of the load's peak.
+    MappedFile file(filename);
+    if (options.useCache) mesh.sourceHash = hashBytes(file.data(), file.size());
+    ObjParser::parseParallel(file.view(), options.threads, mesh.vertices,
+                             mesh.polygons, &options.progress,
+                             ObjParser::kMinChunkBytes, &mesh.groups);
+  }
+  if (options.progress.isCancelled()) throw LoadCancelled();
+  mesh.edges =
+      EdgeBuilder::build(mesh.polygons, mesh.vertices.size(), mesh.groups);
+  mesh.bounds = normalizeVertices(mesh.vertices, options.threads);
+
+  if (options.useCache) ModelCache::store(filename, mesh);
+  if (options.reorder) LocalityReorder::apply(mesh);
+  if (options.buildLods) mesh.lods = LodBuilder::build(mesh);
+  buildIndices(mesh, options);
+  return mesh;
+}
+
+}  // namespace s21
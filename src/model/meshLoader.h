@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+
+#include "mesh.h"
+#include "objParser.h"
+
+namespace s21 {
+
+struct LoadOptions {
+  // Parser threads: 0 uses every core, 1 forces the serial parser.
+  unsigned threads = 0;
+  // Reuse/write a ModelCache sidecar next to the source file.
+  bool useCache = false;
+  // Renumber vertices and faces for locality (see LocalityReorder).
+  bool reorder = false;
+  // Build Mesh::lods (see LodBuilder).
+  bool buildLods = false;
+  // Build Mesh::pickIndex here instead of on the first pick.
+  bool buildPickIndex = false;
+  // Build Mesh::edgeClusters here instead of on the first frame.
+  bool buildEdgeClusters = false;
+  LoadProgress progress;
+};
+
+// Builds a ready-to-display Mesh from an OBJ file: binary cache lookup,
+// parsing, edge extraction and normalization. Touches no Model state, so it
+// can run on a background thread while the previous model is still shown.
+class MeshLoader {
+ public:
+  // Throws std::runtime_error on I/O or format errors and LoadCancelled if
+  // options.progress.cancelled was set.
+  static Mesh load(const std::string &filename, const LoadOptions &options,
+                   bool *fromCache = nullptr);
+};
+
+}  // namespace s21
@@ -1,187 +1,634 @@
 #include "model.h"
 
+#include "lodBuilder.h"
+#include "profiler.h"
+#include "threadPool.h"
+
 namespace s21 {
 
+namespace {
+
+// The model matrix scales uniformly, so a screen radius maps to model units
+// through the length of any column of its linear part.
+float modelRadius(const AffineTransformer::Matrix &m, float radius) {
+  const float scale =
+      std::sqrt(m[0][0] * m[0][0] + m[1][0] * m[1][0] + m[2][0] * m[2][0]);
+  return scale > 0.f ? radius / scale : radius;
+}
+
+Vertex applyMatrix(const AffineTransformer::Matrix &m, const Vertex &v) {
+  return Vertex{m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3],
+                m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3],
+                m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3]};
+}
+
+}  // namespace
+
+void composeTransform(const Transform &t, const Vertex &pivot,
+                      AffineTransformer &out) {
+  out.resetMatrix();
+  out.translate(t.tx, t.ty, t.tz);
+  out.translate(pivot.x, pivot.y, pivot.z);
+  out.rotateZ(t.rz);
+  out.rotateY(t.ry);
+  out.rotateX(t.rx);
+  out.scale(t.s, t.s, t.s);
+  out.translate(-pivot.x, -pivot.y, -pivot.z);
+}
+
 void Model::loadFromFile(const std::string &filename) {
+  bool fromCache = false;
+  Mesh mesh = MeshLoader::load(filename, loadOptions(), &fromCache);
+  setMesh(std::move(mesh), filename);
+  loadedFromCache_ = fromCache;
+}
+
+void Model::setMesh(Mesh mesh, const std::string &filename) {
+  clear();
+  mesh_ = std::move(mesh);
+  filename_ = filename;
+  if (layout_ == VertexLayout::kStructOfArrays)
+    originalArrays_.assign(mesh_.vertices);
+  center_ = centroid(mesh_.vertices, loadThreads_);
+  groupHidden_.assign(mesh_.groups.size(), 0);
+  updateVisibleEdges();
+  if (layout_ == VertexLayout::kQuantized) compact();
+  invalidateTransform();
+  Profiler::instance().setModelBytes(memoryBytes());
+}
+
+Mesh Model::takeMesh() {
+  if (compact_) expand();
+  Mesh mesh = std::move(mesh_);
+  clear();
+  return mesh;
+}
+
+const std::string &Model::filename() const { return filename_; }
+
+void Model::beginPreview(const std::string &filename) {
   clear();
   filename_ = filename;
+  preview_ = true;
+}
 
-  std::ifstream file(filename);
-  if (!file.is_open())
-    throw std::runtime_error("Cannot open file: " + filename);
-
-  std::string line;
-  while (std::getline(file, line)) {
-    if (line.empty() || line[0] == '#') continue;
-    std::istringstream iss(line);
-    std::string prefix;
-    iss >> prefix;
-    if (prefix == "v")
-      parseVertex(line);
-    else if (prefix == "f")
-      parsePolygon(line);
+void Model::appendPreview(const std::vector<Vertex> &vertices,
+                          const PolygonList &polygons) {
+  if (!preview_) beginPreview(filename_);
+  Preview &p = previewState_;
+  if (mesh_.vertices.empty() && !vertices.empty())
+    p.raw = Bounds{vertices.front(), vertices.front()};
+  for (const auto &v : vertices) {
+    p.raw.min = {std::min(p.raw.min.x, v.x), std::min(p.raw.min.y, v.y),
+                 std::min(p.raw.min.z, v.z)};
+    p.raw.max = {std::max(p.raw.max.x, v.x), std::max(p.raw.max.y, v.y),
+                 std::max(p.raw.max.z, v.z)};
+    p.sum[0] += v.x;
+    p.sum[1] += v.y;
+    p.sum[2] += v.z;
   }
-  if (!vertices_.empty()) normalize();
+  mesh_.vertices.insert(mesh_.vertices.end(), vertices.begin(),
+                        vertices.end());
+  if (layout_ == VertexLayout::kStructOfArrays)
+    originalArrays_.append(vertices);
 
-  originalVertices_ = vertices_;
-  current_ = Transform{};
-  rebuildFromTransform();
+  // Faces may reference vertices that have not arrived yet; their edges
+  // only show up with the final mesh.
+  const size_t count = mesh_.vertices.size();
+  for (Polygon polygon : polygons) {
+    for (size_t i = 0; i < polygon.size(); ++i) {
+      unsigned a = polygon[i];
+      unsigned b = polygon[(i + 1) % polygon.size()];
+      if (a == b || a >= count || b >= count) continue;
+      mesh_.edges.push_back(Edge{std::min(a, b), std::max(a, b)});
+    }
+  }
+  mesh_.polygons.append(polygons);
+  mesh_.pickIndex.reset();
+  mesh_.edgeClusters.clear();
+  updateVisibleEdges();
+
+  if (count == 0) return;
+  const Bounds &r = p.raw;
+  p.scale = std::max({r.max.x - r.min.x, r.max.y - r.min.y, r.max.z - r.min.z});
+  if (p.scale == 0.f) p.scale = 1.f;
+  p.center = {(r.max.x + r.min.x) * 0.5f, (r.max.y + r.min.y) * 0.5f,
+              (r.max.z + r.min.z) * 0.5f};
+  auto toNormalized = [&p](Vertex v) {
+    return Vertex{(v.x - p.center.x) / p.scale, (v.y - p.center.y) / p.scale,
+                  (v.z - p.center.z) / p.scale};
+  };
+  mesh_.bounds = Bounds{toNormalized(r.min), toNormalized(r.max)};
+  const double inv = 1.0 / static_cast<double>(count);
+  center_ = toNormalized(Vertex{static_cast<float>(p.sum[0] * inv),
+                                static_cast<float>(p.sum[1] * inv),
+                                static_cast<float>(p.sum[2] * inv)});
+  ++previewVersion_;
+  invalidateTransform();
+  Profiler::instance().setModelBytes(memoryBytes());
 }
 
-void Model::parseVertex(const std::string &line) {
-  std::istringstream iss(line);
-  std::string prefix;
-  iss >> prefix;
-  Vertex v{};
-  if (iss >> v.x >> v.y >> v.z)
-    vertices_.push_back(v);
-  else
-    throw std::runtime_error("Invalid vertex line: " + line);
+bool Model::isPreview() const { return preview_; }
+
+LoadOptions Model::loadOptions() const {
+  LoadOptions options;
+  options.threads = loadThreads_;
+  options.useCache = cacheEnabled_;
+  options.reorder = reorderEnabled_;
+  options.buildLods = lodEnabled_;
+  options.buildPickIndex = pickIndexEnabled_;
+  options.buildEdgeClusters = edgeClustersEnabled_;
+  return options;
+}
+
+void Model::setLoadThreads(unsigned threads) { loadThreads_ = threads; }
+unsigned Model::loadThreads() const { return loadThreads_; }
+
+void Model::setBinaryCacheEnabled(bool enabled) { cacheEnabled_ = enabled; }
+bool Model::binaryCacheEnabled() const { return cacheEnabled_; }
+bool Model::loadedFromCache() const { return loadedFromCache_; }
+
+void Model::setReorderEnabled(bool enabled) { reorderEnabled_ = enabled; }
+bool Model::reorderEnabled() const { return reorderEnabled_; }
+
+void Model::setLodEnabled(bool enabled) { lodEnabled_ = enabled; }
+bool Model::lodEnabled() const { return lodEnabled_; }
+size_t Model::lodCount() const { return mesh_.lods.size() + 1; }
+float Model::lodError(size_t level) const {
+  return level == 0 ? 0.f : mesh_.lods[level - 1].error;
 }
+void Model::setLodThreshold(float pixels) { lodThreshold_ = pixels; }
+float Model::lodThreshold() const { return lodThreshold_; }
+void Model::setForcedLod(int level) { forcedLod_ = level; }
+int Model::forcedLod() const { return forcedLod_; }
 
-void Model::parsePolygon(const std::string &line) {
-  std::istringstream iss(line);
-  std::string prefix;
-  iss >> prefix;
+size_t Model::selectLod(float pixelsPerUnit) const {
+  if (hiddenGroups_) return 0;
+  if (forcedLod_ >= 0) return std::min<size_t>(forcedLod_, lodCount() - 1);
+  // Rotation and translation keep lengths, so only the scale matters.
+  return LodBuilder::select(mesh_.lods, current_.s * pixelsPerUnit,
+                            lodThreshold_);
+}
+
+const std::vector<Vertex> &Model::getLodOriginalVertices(size_t level) const {
+  return level == 0 ? getOriginalVertices() : mesh_.lods[level - 1].vertices;
+}
 
-  Polygon polygon;
-  std::string token;
-  while (iss >> token) {
-    size_t pos = token.find('/');
-    if (pos != std::string::npos) token = token.substr(0, pos);
-    unsigned idx = static_cast<unsigned>(std::stoul(token));
-    polygon.vertexIndices.push_back(idx - 1);
+void Model::appendLodOriginalVertices(size_t level,
+                                      std::vector<Vertex> &out) const {
+  if (level == 0 && compact_) {
+    quantized_.appendTo(out);
+    return;
   }
+  const std::vector<Vertex> &vertices = getLodOriginalVertices(level);
+  out.insert(out.end(), vertices.begin(), vertices.end());
+}
+const std::vector<Edge> &Model::getLodEdges(size_t level) const {
+  return level == 0 ? mesh_.edges : mesh_.lods[level - 1].edges;
+}
 
-  if (polygon.vertexIndices.size() >= 3) {
-    polygons_.push_back(std::move(polygon));
-  } else {
-    throw std::runtime_error("Invalid polygon (less than 3 vertices): " + line);
+const std::vector<Vertex> &Model::getLodVertices(size_t level) {
+  if (level == 0) return getVertices();
+  if (level != lodVerticesLevel_) {
+    const std::vector<Vertex> &original = mesh_.lods[level - 1].vertices;
+    transformMatrix();
+    lodVertices_.resize(original.size());
+    for (size_t i = 0; i < original.size(); ++i) {
+      Vertex v = original[i];
+      transformer_.applyToVertex(v);
+      lodVertices_[i] = v;
+    }
+    lodVerticesLevel_ = level;
   }
+  return lodVertices_;
 }
 
-void Model::normalize() {
-  float minX = std::numeric_limits<float>::max();
-  float minY = std::numeric_limits<float>::max();
-  float minZ = std::numeric_limits<float>::max();
-  float maxX = std::numeric_limits<float>::lowest();
-  float maxY = std::numeric_limits<float>::lowest();
-  float maxZ = std::numeric_limits<float>::lowest();
-
-  for (const auto &v : vertices_) {
-    minX = std::min(minX, v.x);
-    minY = std::min(minY, v.y);
-    minZ = std::min(minZ, v.z);
-    maxX = std::max(maxX, v.x);
-    maxY = std::max(maxY, v.y);
-    maxZ = std::max(maxZ, v.z);
+void Model::setPickIndexEnabled(bool enabled) { pickIndexEnabled_ = enabled; }
+bool Model::pickIndexEnabled() const { return pickIndexEnabled_; }
+
+const SpatialIndex &Model::spatialIndex() {
+  if (!mesh_.pickIndex)
+    mesh_.pickIndex =
+        std::make_shared<SpatialIndex>(getOriginalVertices(), getPolygons());
+  return *mesh_.pickIndex;
+}
+
+Ray Model::pickRay(float x, float y) {
+  // The view volume spans z in [-10, 10]; the camera looks down -z.
+  const AffineTransformer::Matrix inv =
+      AffineTransformer::inverse(transformMatrix());
+  const Vertex near = applyMatrix(inv, Vertex{x, y, 10.f});
+  const Vertex far = applyMatrix(inv, Vertex{x, y, -10.f});
+  return Ray{near, Vertex{far.x - near.x, far.y - near.y, far.z - near.z}};
+}
+
+PickFilter Model::visibleFaces() const {
+  if (hiddenGroups_ == 0) return {};
+  // Groups cover the faces in order, so the last one starting at or before
+  // a face holds it.
+  return [this](unsigned face) {
+    const auto it = std::upper_bound(
+        mesh_.groups.begin(), mesh_.groups.end(), face,
+        [](unsigned f, const FaceGroup &g) { return f < g.firstFace; });
+    return it == mesh_.groups.begin() ||
+           !groupHidden_[it - mesh_.groups.begin() - 1];
+  };
+}
+
+PickFilter Model::visibleVertices() {
+  if (hiddenGroups_ == 0) return {};
+  if (visibleVertices_.empty()) {
+    visibleVertices_.assign(vertexCount(), 0);
+    const PolygonList &polygons = getPolygons();
+    const PickFilter faces = visibleFaces();
+    for (size_t f = 0; f < polygons.size(); ++f) {
+      if (!faces(static_cast<unsigned>(f))) continue;
+      for (unsigned v : polygons[f]) visibleVertices_[v] = 1;
+    }
   }
+  return [this](unsigned vertex) { return visibleVertices_[vertex] != 0; };
+}
 
-  float scale = std::max({maxX - minX, maxY - minY, maxZ - minZ});
-  if (scale == 0.f) scale = 1.f;
+PickResult Model::pickVertex(float x, float y, float radius) {
+  if (preview_ || vertexCount() == 0) return PickResult{};
+  return spatialIndex().pickVertex(getOriginalVertices(), pickRay(x, y),
+                                   modelRadius(transformMatrix(), radius),
+                                   visibleVertices());
+}
 
-  float cx = (maxX + minX) * 0.5f;
-  float cy = (maxY + minY) * 0.5f;
-  float cz = (maxZ + minZ) * 0.5f;
+PickResult Model::pickEdge(float x, float y, float radius) {
+  if (preview_ || vertexCount() == 0) return PickResult{};
+  Edge edge{0, 0};
+  PickResult result = spatialIndex().pickEdge(
+      getOriginalVertices(), getPolygons(), pickRay(x, y),
+      modelRadius(transformMatrix(), radius), edge, visibleFaces());
+  if (!result.found) return result;
+  // EdgeBuilder output is sorted by (a, b); with groups, each group's own
+  // edges and its shared copies are sorted separately.
+  auto find = [&](size_t first, size_t count) {
+    const auto begin = mesh_.edges.begin() + first;
+    const auto end = begin + count;
+    auto it = std::lower_bound(begin, end, edge,
+                               [](const Edge &l, const Edge &r) {
+                                 return l.a < r.a || (l.a == r.a && l.b < r.b);
+                               });
+    if (it == end || it->a != edge.a || it->b != edge.b) return false;
+    result.index = static_cast<size_t>(it - mesh_.edges.begin());
+    return true;
+  };
+  if (mesh_.groups.empty())
+    return find(0, mesh_.edges.size()) ? result : PickResult{};
+  // An edge's owner comes before the groups holding copies of it, so with
+  // every group shown the drawn (own) entry is found.
+  for (size_t g = 0; g < mesh_.groups.size(); ++g) {
+    const FaceGroup &group = mesh_.groups[g];
+    if (groupHidden_[g]) continue;
+    if (find(group.firstEdge, group.ownEdgeCount()) ||
+        find(group.firstEdge + group.ownEdgeCount(), group.sharedEdgeCount))
+      return result;
+  }
+  return PickResult{};
+}
 
-  for (auto &v : vertices_) {
-    v.x = (v.x - cx) / scale;
-    v.y = (v.y - cy) / scale;
-    v.z = (v.z - cz) / scale;
+PickResult Model::raycast(float x, float y) {
+  if (preview_ || vertexCount() == 0) return PickResult{};
+  return spatialIndex().raycast(getOriginalVertices(), getPolygons(),
+                                pickRay(x, y), visibleFaces());
+}
+
+PickResult Model::nearestVertex(const Vertex &point, float maxDistance) {
+  if (preview_ || vertexCount() == 0) return PickResult{};
+  const Vertex p =
+      applyMatrix(AffineTransformer::inverse(transformMatrix()), point);
+  return spatialIndex().nearestVertex(
+      getOriginalVertices(), p, modelRadius(transformMatrix(), maxDistance),
+      visibleVertices());
+}
+
+void Model::setEdgeClustersEnabled(bool enabled) {
+  edgeClustersEnabled_ = enabled;
+}
+bool Model::edgeClustersEnabled() const { return edgeClustersEnabled_; }
+
+const EdgeClusters &Model::edgeClusters(size_t level) {
+  if (mesh_.edgeClusters.size() < lodCount())
+    mesh_.edgeClusters.resize(lodCount());
+  auto &clusters = mesh_.edgeClusters[level];
+  if (clusters) return *clusters;
+  if (level == 0 && compact_) {
+    // A temporary decode keeps the compact mode compact.
+    std::vector<Vertex> vertices;
+    quantized_.appendTo(vertices);
+    clusters =
+        std::make_shared<EdgeClusters>(vertices, mesh_.edges, mesh_.groups);
+  } else if (level == 0) {
+    clusters = std::make_shared<EdgeClusters>(getOriginalVertices(),
+                                              mesh_.edges, mesh_.groups);
+  } else {
+    clusters = std::make_shared<EdgeClusters>(getLodOriginalVertices(level),
+                                              getLodEdges(level));
   }
+  return *clusters;
 }
 
+void Model::setVertexLayout(VertexLayout layout) {
+  if (layout == layout_) return;
+  // Every layout change is followed by a full rebuild.
+  verticesStale_ = false;
+  layout_ = layout;
+  if (compact_) expand();
+  if (layout_ == VertexLayout::kStructOfArrays)
+    originalArrays_.assign(mesh_.vertices);
+  else
+    originalArrays_.clear();
+  if (layout_ == VertexLayout::kArrayOfStructs) transformedArrays_.clear();
+  if (layout_ == VertexLayout::kQuantized && !preview_) compact();
+  transformDirty_ = vertexCount() != 0;
+}
+VertexLayout Model::vertexLayout() const { return layout_; }
+
 void Model::translate(float dx, float dy, float dz) {
   current_.tx += dx;
   current_.ty += dy;
   current_.tz += dz;
-  rebuildFromTransform();
+  invalidateTransform();
 }
 void Model::rotateX(float angle) {
   current_.rx += angle;
-  rebuildFromTransform();
+  invalidateTransform();
 }
 void Model::rotateY(float angle) {
   current_.ry += angle;
-  rebuildFromTransform();
+  invalidateTransform();
 }
 void Model::rotateZ(float angle) {
   current_.rz += angle;
-  rebuildFromTransform();
+  invalidateTransform();
 }
 void Model::scale(float sx, float sy, float sz) {
   (void)sy;
   (void)sz;
   current_.s *= sx;
   if (current_.s <= 0.f) current_.s = 1.f;
-  rebuildFromTransform();
+  invalidateTransform();
 }
 
 void Model::setTranslation(float tx, float ty, float tz) {
   current_.tx = tx;
   current_.ty = ty;
   current_.tz = tz;
-  rebuildFromTransform();
+  invalidateTransform();
 }
 void Model::setRotation(float rx, float ry, float rz) {
   current_.rx = rx;
   current_.ry = ry;
   current_.rz = rz;
-  rebuildFromTransform();
+  invalidateTransform();
 }
 void Model::setScale(float s) {
   current_.s = (s > 0.f ? s : 1.f);
-  rebuildFromTransform();
+  invalidateTransform();
 }
 
-Vertex Model::centerOfOriginal() const {
-  Vertex c{0.f, 0.f, 0.f};
-  if (originalVertices_.empty()) return c;
-  for (const auto &v : originalVertices_) {
-    c.x += v.x;
-    c.y += v.y;
-    c.z += v.z;
+void Model::invalidateTransform() {
+  matrixDirty_ = true;
+  lodVerticesLevel_ = 0;
+  transformDirty_ = vertexCount() != 0;
+}
+
+const AffineTransformer::Matrix &Model::transformMatrix() {
+  if (matrixDirty_) {
+    composeTransform(current_, center_, transformer_);
+    if (preview_) {
+      const Preview &p = previewState_;
+      transformer_.scale(1.f / p.scale, 1.f / p.scale, 1.f / p.scale);
+      transformer_.translate(-p.center.x, -p.center.y, -p.center.z);
+    }
+    matrixDirty_ = false;
   }
-  float inv = 1.f / static_cast<float>(originalVertices_.size());
-  c.x *= inv;
-  c.y *= inv;
-  c.z *= inv;
-  return c;
+  return transformer_.matrix();
 }
 
+const Transform &Model::transform() const { return current_; }
+
 void Model::rebuildFromTransform() {
-  transformer_.resetMatrix();
-  const Vertex c = centerOfOriginal();
+  ScopedTimer timer(Stage::kTransform);
+  const AffineTransformer::Matrix &m = transformMatrix();
 
-  transformer_.translate(current_.tx, current_.ty, current_.tz);
-  transformer_.translate(c.x, c.y, c.z);
-  transformer_.rotateZ(current_.rz);
-  transformer_.rotateY(current_.ry);
-  transformer_.rotateX(current_.rx);
-  transformer_.scale(current_.s, current_.s, current_.s);
-  transformer_.translate(-c.x, -c.y, -c.z);
+  const TransformKernel::Isa isa = TransformKernel::bestIsa();
+  if (compact_) {
+    quantized_.transform(m, transformedArrays_, isa, loadThreads_);
+    verticesStale_ = true;
+  } else if (layout_ == VertexLayout::kStructOfArrays) {
+    TransformKernel::transform(m, originalArrays_, transformedArrays_, isa,
+                               loadThreads_);
+    verticesStale_ = true;
+  } else {
+    vertices_.resize(mesh_.vertices.size());
+    ThreadPool::shared().parallelBlocks(
+        vertices_.size(), loadThreads_, [&](size_t, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            Vertex v = mesh_.vertices[i];
+            transformer_.applyToVertex(v);
+            vertices_[i] = v;
+          }
+        });
+  }
+  transformDirty_ = false;
+  Profiler::instance().addTransformedVertices(vertexCount());
+  Profiler::instance().setModelBytes(memoryBytes());
+}
+
+std::vector<Vertex> &Model::getVertices() {
+  if (transformDirty_) rebuildFromTransform();
+  if (verticesStale_) {
+    transformedArrays_.storeTo(vertices_);
+    verticesStale_ = false;
+  }
+  return vertices_;
+}
+const VertexArrays &Model::getVertexArrays() {
+  if (transformDirty_) rebuildFromTransform();
+  return transformedArrays_;
+}
+const std::vector<Vertex> &Model::getOriginalVertices() const {
+  if (!compact_) return mesh_.vertices;
+  if (decodedVertices_.empty()) quantized_.appendTo(decodedVertices_);
+  return decodedVertices_;
+}
+const PolygonList &Model::getPolygons() const {
+  if (!compact_) return mesh_.polygons;
+  if (decodedPolygons_.empty() && polygonOffsets_.size() > 1) {
+    std::vector<unsigned int> indices;
+    polygonIndices_.widenTo(indices);
+    decodedPolygons_.assign(indices.data(), indices.size(),
+                            polygonOffsets_.data(), polygonOffsets_.size());
+  }
+  return decodedPolygons_;
+}
+const std::vector<Edge> &Model::getEdges() const { return mesh_.edges; }
 
-  vertices_ = originalVertices_;
-  for (auto &v : vertices_) transformer_.applyToVertex(v);
+const std::vector<FaceGroup> &Model::groups() const { return mesh_.groups; }
 
-  transformer_.resetMatrix();
+void Model::setGroupVisible(size_t group, bool visible) {
+  char &hidden = groupHidden_.at(group);
+  if (hidden == !visible) return;
+  hidden = !visible;
+  if (visible)
+    --hiddenGroups_;
+  else
+    ++hiddenGroups_;
+  updateVisibleEdges();
 }
-std::vector<Vertex> &Model::getVertices() { return vertices_; }
-std::vector<Polygon> &Model::getPolygons() { return polygons_; }
 
-size_t Model::vertexCount() const { return vertices_.size(); }
+bool Model::groupVisible(size_t group) const {
+  return !groupHidden_.at(group);
+}
 
-size_t Model::edgeCount() const {
-  size_t edges = 0;
-  for (const auto &p : polygons_) edges += p.vertexIndices.size();
-  return edges / 2;
+void Model::isolateGroup(size_t group) {
+  if (group >= groupHidden_.size()) throw std::out_of_range("No such group");
+  std::fill(groupHidden_.begin(), groupHidden_.end(), 1);
+  groupHidden_[group] = 0;
+  hiddenGroups_ = groupHidden_.size() - 1;
+  updateVisibleEdges();
 }
 
+void Model::showAllGroups() {
+  std::fill(groupHidden_.begin(), groupHidden_.end(), 0);
+  hiddenGroups_ = 0;
+  updateVisibleEdges();
+}
+
+bool Model::allGroupsVisible() const { return hiddenGroups_ == 0; }
+
+const std::vector<EdgeClusters::Range> &Model::visibleEdgeRanges() const {
+  return visibleEdges_;
+}
+
+void Model::updateVisibleEdges() {
+  visibleVertices_ = {};
+  visibleEdges_.clear();
+  if (mesh_.groups.empty()) {
+    visibleEdges_.push_back({0, static_cast<unsigned>(mesh_.edges.size())});
+    return;
+  }
+  // With every group shown, each shared edge is drawn from the group that
+  // owns it. Otherwise visible groups are drawn whole, so an edge between
+  // two of them is drawn twice, but none goes missing with its owner.
+  for (size_t g = 0; g < mesh_.groups.size(); ++g) {
+    const FaceGroup &group = mesh_.groups[g];
+    const unsigned count =
+        hiddenGroups_ == 0 ? group.ownEdgeCount() : group.edgeCount;
+    if (groupHidden_[g] || count == 0) continue;
+    if (!visibleEdges_.empty() &&
+        visibleEdges_.back().first + visibleEdges_.back().count ==
+            group.firstEdge)
+      visibleEdges_.back().count += count;
+    else
+      visibleEdges_.push_back({group.firstEdge, count});
+  }
+}
+
+size_t Model::vertexCount() const {
+  return compact_ ? quantized_.size() : mesh_.vertices.size();
+}
+
+size_t Model::edgeCount() const { return uniqueEdgeCount(mesh_); }
+
+const Bounds &Model::bounds() const { return mesh_.bounds; }
+
+size_t Model::memoryBytes() const {
+  auto bytes = [](const auto &v) { return v.capacity() * sizeof(v[0]); };
+  auto arrayBytes = [&bytes](const VertexArrays &a) {
+    return bytes(a.x) + bytes(a.y) + bytes(a.z);
+  };
+  return s21::memoryBytes(mesh_) + bytes(vertices_) +
+         arrayBytes(originalArrays_) + arrayBytes(transformedArrays_) +
+         bytes(lodVertices_) + quantized_.memoryBytes() +
+         polygonIndices_.memoryBytes() + bytes(polygonOffsets_) +
+         bytes(decodedVertices_) + bytes(decodedPolygons_.indices()) +
+         bytes(decodedPolygons_.offsets()) + bytes(visibleVertices_);
+}
+
+GeometryFootprint Model::footprint() const {
+  auto bytes = [](const auto &v) { return v.capacity() * sizeof(v[0]); };
+  size_t positions = bytes(mesh_.vertices) + bytes(originalArrays_.x) +
+                     bytes(originalArrays_.y) + bytes(originalArrays_.z) +
+                     quantized_.memoryBytes() + bytes(decodedVertices_);
+  size_t faces = bytes(mesh_.polygons.indices()) +
+                 bytes(mesh_.polygons.offsets()) +
+                 polygonIndices_.memoryBytes() + bytes(polygonOffsets_) +
+                 bytes(decodedPolygons_.indices()) +
+                 bytes(decodedPolygons_.offsets());
+  const size_t faceCount =
+      compact_ ? polygonOffsets_.size() - 1 : mesh_.polygons.size();
+  GeometryFootprint f;
+  if (vertexCount() > 0)
+    f.bytesPerVertex = static_cast<double>(positions) / vertexCount();
+  if (faceCount > 0) f.bytesPerFace = static_cast<double>(faces) / faceCount;
+  f.maxError = compact_ ? quantized_.maxError() : 0.f;
+  f.narrowIndices = compact_ && polygonIndices_.narrow();
+  return f;
+}
+
+void Model::compact() {
+  if (mesh_.vertices.empty()) return;
+  quantized_.encode(mesh_.vertices);
+  polygonIndices_.assign(mesh_.polygons.indices());
+  polygonOffsets_ = mesh_.polygons.offsets();
+  std::vector<Vertex>().swap(mesh_.vertices);
+  mesh_.polygons = PolygonList{};
+  compact_ = true;
+  ++geometryVersion_;
+}
+
+void Model::expand() {
+  mesh_.vertices.clear();
+  quantized_.appendTo(mesh_.vertices);
+  std::vector<unsigned int> indices;
+  polygonIndices_.widenTo(indices);
+  mesh_.polygons.assign(indices.data(), indices.size(),
+                        polygonOffsets_.data(), polygonOffsets_.size());
+  compact_ = false;
+  quantized_.clear();
+  polygonIndices_.clear();
+  polygonOffsets_.clear();
+  decodedVertices_.clear();
+  decodedPolygons_.clear();
+  ++geometryVersion_;
+}
+
+unsigned long long Model::geometryVersion() const { return geometryVersion_; }
+
+unsigned long long Model::previewVersion() const { return previewVersion_; }
+
 void Model::clear() {
-  vertices_.clear();
-  originalVertices_.clear();
-  polygons_.clear();
+  // Assigning empty buffers frees them; clear() would keep the capacity.
+  vertices_ = {};
+  mesh_.clear();
+  originalArrays_ = {};
+  transformedArrays_ = {};
+  lodVertices_ = {};
+  lodVerticesLevel_ = 0;
+  verticesStale_ = false;
+  compact_ = false;
+  quantized_ = {};
+  polygonIndices_ = {};
+  polygonOffsets_ = {};
+  decodedVertices_ = {};
+  decodedPolygons_ = {};
+  groupHidden_ = {};
+  hiddenGroups_ = 0;
+  updateVisibleEdges();
+  loadedFromCache_ = false;
+  filename_.clear();
+  preview_ = false;
+  previewState_ = Preview{};
+  center_ = Vertex{0.f, 0.f, 0.f};
   current_ = Transform{};
+  matrixDirty_ = true;
+  transformDirty_ = false;
+  ++geometryVersion_;
 }
 
 }  // namespace s21
\ No newline at end of file
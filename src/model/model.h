@@ -2,38 +2,166 @@
 
 #include <algorithm>
 #include <array>
-#include <fstream>
 #include <limits>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "affineTransformer.h"
+#include "edgeClusters.h"
+#include "geometry.h"
+#include "mesh.h"
+#include "meshLoader.h"
+#include "quantize.h"
+#include "spatialIndex.h"
+#include "transformKernel.h"
 
 namespace s21 {
 
-struct Vertex {
-  float x, y, z;
-};
-struct Polygon {
-  std::vector<unsigned int> vertexIndices;
-};
-
 struct Transform {
   float tx{0.f}, ty{0.f}, tz{0.f};
   float rx{0.f}, ry{0.f}, rz{0.f};
   float s{1.f};
 };
 
+// Model matrix of t: scale and rotate about pivot, then translate.
+void composeTransform(const Transform &t, const Vertex &pivot,
+                      AffineTransformer &out);
+
+// How the untransformed and transformed positions are kept in memory.
+// kStructOfArrays runs rebuildFromTransform through the vectorized
+// TransformKernel; getVertices() then interleaves on demand.
+//
+// kQuantized is the compact mode: the untransformed positions of the full
+// mesh are kept only as QuantizedVertices (6 bytes instead of 12 or 24 per
+// vertex) and face indices in 16 bits when the vertex count allows.
+// Decoding is folded into the transform matrix, so rebuildFromTransform
+// costs the same as kStructOfArrays. getOriginalVertices() and
+// getPolygons() decode a full copy on first use (picking does), which is
+// then kept with the geometry. Leaving kQuantized keeps the quantized
+// positions. Previews and levels of detail stay in floats.
+enum class VertexLayout { kArrayOfStructs, kStructOfArrays, kQuantized };
+
+// Storage cost of the untransformed geometry, see Model::footprint().
+struct GeometryFootprint {
+  // Bytes held for positions, and for face indices and offsets.
+  double bytesPerVertex = 0.0;
+  double bytesPerFace = 0.0;
+  // Largest per-axis error of the stored positions in normalized units;
+  // 0 unless quantized.
+  float maxError = 0.f;
+  bool narrowIndices = false;
+};
+
 class Model {
  public:
   Model() = default;
 
+  // On failure the previously loaded geometry is kept.
   void loadFromFile(const std::string &filename);
-  void parseVertex(const std::string &line);
-  void parsePolygon(const std::string &line);
-  void normalize();
+  // Replaces the geometry with an already loaded mesh (for example one built
+  // by MeshLoader on a worker thread) and resets the transform. O(1) apart
+  // from the centroid pass.
+  void setMesh(Mesh mesh, const std::string &filename = {});
+  // Moves the geometry out, with any picking index and edge clusters built
+  // for it, and leaves the model empty. O(1).
+  Mesh takeMesh();
+  // File the geometry came from; empty if it was set without one.
+  const std::string &filename() const;
+  // Streaming preview of a file that is still loading. beginPreview() drops
+  // the current geometry; appendPreview() adds a batch of raw, not yet
+  // normalized geometry as delivered by LoadProgress::onBatch. It is shown
+  // through a provisional normalization computed from the bounding box seen
+  // so far and folded into transformMatrix(), so a batch costs O(batch size)
+  // however much has already arrived. Preview edges are per face and not
+  // deduplicated. setMesh() with the finished mesh ends the preview.
+  void beginPreview(const std::string &filename);
+  void appendPreview(const std::vector<Vertex> &vertices,
+                     const PolygonList &polygons);
+  bool isPreview() const;
+  // Load settings of this model, for callers running MeshLoader themselves.
+  LoadOptions loadOptions() const;
+
+  // Threads used to parse large files and for the normalize, centroid and
+  // transform passes over large meshes: 0 uses every core, 1 forces the
+  // serial paths. Results do not depend on the setting.
+  void setLoadThreads(unsigned threads);
+  unsigned loadThreads() const;
+
+  // Reuse/write a ModelCache sidecar next to each loaded file. Off by
+  // default.
+  void setBinaryCacheEnabled(bool enabled);
+  bool binaryCacheEnabled() const;
+  // Whether the last loadFromFile() was served from the binary cache.
+  bool loadedFromCache() const;
+
+  // Renumber vertices and faces for memory locality after loading
+  // (LocalityReorder). Off by default; indices then differ from the file.
+  void setReorderEnabled(bool enabled);
+  bool reorderEnabled() const;
+
+  // Level-of-detail pyramid (LodBuilder), built by loadFromFile and
+  // loadOptions() users when enabled. Off by default. Level 0 is the full
+  // mesh and higher levels are coarser.
+  void setLodEnabled(bool enabled);
+  bool lodEnabled() const;
+  size_t lodCount() const;
+  // Largest vertex displacement of a level in normalized units.
+  float lodError(size_t level) const;
+  // Largest on-screen error selectLod() accepts, in pixels (default 1).
+  void setLodThreshold(float pixels);
+  float lodThreshold() const;
+  // Forces selectLod() to return `level` (clamped); -1 selects by size.
+  void setForcedLod(int level);
+  int forcedLod() const;
+  // Coarsest level whose error at the current scale stays within the
+  // threshold, for a view showing `pixelsPerUnit` pixels per normalized
+  // device unit (half the viewport width for the glOrtho(-1, 1) volume).
+  size_t selectLod(float pixelsPerUnit) const;
+  const std::vector<Vertex> &getLodOriginalVertices(size_t level) const;
+  // Appends the untransformed vertices of a level to out without keeping a
+  // decoded copy in VertexLayout::kQuantized.
+  void appendLodOriginalVertices(size_t level,
+                                 std::vector<Vertex> &out) const;
+  const std::vector<Edge> &getLodEdges(size_t level) const;
+  // Transformed vertices of a level, rebuilt lazily like getVertices();
+  // level 0 is getVertices().
+  const std::vector<Vertex> &getLodVertices(size_t level);
+
+  // Build the picking index at load time rather than on the first pick.
+  // Off by default.
+  void setPickIndexEnabled(bool enabled);
+  bool pickIndexEnabled() const;
+  // Picking at (x, y) in normalized device coordinates of the glOrtho(-1, 1)
+  // view; radius is in the same units. The view ray is mapped into model
+  // space with the inverse model matrix, so the SpatialIndex built over the
+  // untransformed mesh serves every transform. Results carry distances in
+  // model units; t runs from the near (0) to the far plane (1). Nothing is
+  // found while a preview is loading.
+  PickResult pickVertex(float x, float y, float radius);
+  // index is the position of the edge in getEdges().
+  PickResult pickEdge(float x, float y, float radius);
+  // First face under (x, y); index is the polygon.
+  PickResult raycast(float x, float y);
+  // Vertex nearest to `point`, given in view space like getVertices(),
+  // within maxDistance (view units); distance is in model units as above.
+  PickResult nearestVertex(
+      const Vertex &point,
+      float maxDistance = std::numeric_limits<float>::infinity());
+  // The index for the current geometry, built on first use (O(n log n)).
+  // Not for previews, whose faces may reference vertices still loading.
+  const SpatialIndex &spatialIndex();
+
+  // Build the culling clusters at load time rather than on the first
+  // frame. Off by default.
+  void setEdgeClustersEnabled(bool enabled);
+  bool edgeClustersEnabled() const;
+  // Edge clusters of a level of detail for view culling, built on first use
+  // in O(edges). Not for previews, whose edges change with every batch.
+  const EdgeClusters &edgeClusters(size_t level);
+
+  void setVertexLayout(VertexLayout layout);
+  VertexLayout vertexLayout() const;
 
   void translate(float dx, float dy, float dz);
   void rotateX(float angle);
@@ -45,22 +173,127 @@ class Model {
   void setRotation(float rx, float ry, float rz);
   void setScale(float s);
 
+  // Transform setters only record the new state. The transformed vertices
+  // are rebuilt in a single pass the next time getVertices() or
+  // getVertexArrays() is called, however many setters ran in between.
+  const Transform &transform() const;
+  // Composed model matrix for the current Transform (cheap, no vertex pass).
+  const AffineTransformer::Matrix &transformMatrix();
+
   std::vector<Vertex> &getVertices();
-  std::vector<Polygon> &getPolygons();
+  // Normalized, untransformed positions (raw file coordinates during a
+  // preview); pair with transformMatrix() to transform on the GPU instead of
+  // calling getVertices().
+  const std::vector<Vertex> &getOriginalVertices() const;
+  const PolygonList &getPolygons() const;
+  // Unique undirected edges, built once per load (unique per group when
+  // the model has groups).
+  const std::vector<Edge> &getEdges() const;
+
+  // Parts of the model from the OBJ "o", "g" and "usemtl" statements, in
+  // file order; empty for files without them. Each is a range of
+  // getPolygons() and of getEdges().
+  const std::vector<FaceGroup> &groups() const;
+  // Group visibility only changes which edge ranges are drawn: nothing is
+  // reparsed, copied or uploaded again. Every group is visible after a
+  // load. While one is hidden, selectLod() keeps the full mesh (levels of
+  // detail span all groups) and picking skips hidden groups: their faces,
+  // their edges and the vertices only they use.
+  void setGroupVisible(size_t group, bool visible);
+  bool groupVisible(size_t group) const;
+  // Shows `group` alone.
+  void isolateGroup(size_t group);
+  void showAllGroups();
+  bool allGroupsVisible() const;
+  // Ranges of getEdges() to draw, adjacent ones merged: a single range over
+  // every edge without groups; the own edges of every group when all are
+  // shown, so each edge appears once; else the visible groups whole.
+  const std::vector<EdgeClusters::Range> &visibleEdgeRanges() const;
+  // Transformed positions; only populated in VertexLayout::kStructOfArrays
+  // and kQuantized.
+  const VertexArrays &getVertexArrays();
   size_t vertexCount() const;
+  // Distinct edges, see uniqueEdgeCount().
   size_t edgeCount() const;
+  // Bounding box of the normalized, untransformed vertices.
+  const Bounds &bounds() const;
+  // Bumped whenever the geometry (not the transform) changes, so renderers
+  // know when cached GPU buffers have to be uploaded again. appendPreview()
+  // bumps previewVersion() instead.
+  unsigned long long geometryVersion() const;
+  // Bumped by every appendPreview(). A preview only grows: vertices and
+  // edges are appended and the ones already there stay as they are, so a
+  // renderer holding the first N of them only has to add the rest.
+  unsigned long long previewVersion() const;
+  // Heap bytes held by the geometry buffers (capacity, not size).
+  size_t memoryBytes() const;
+  GeometryFootprint footprint() const;
+  // Drops the model and frees its geometry buffers.
   void clear();
 
  private:
+  void invalidateTransform();
   void rebuildFromTransform();
-  Vertex centerOfOriginal() const;
+  void updateVisibleEdges();
+  // Moves the full mesh into the compact storage and back.
+  void compact();
+  void expand();
+  Ray pickRay(float x, float y);
+  // Picking filters for the shown groups; empty while every group is shown.
+  PickFilter visibleFaces() const;
+  PickFilter visibleVertices();
+
+  // Running state of a streaming preview, in raw file coordinates.
+  struct Preview {
+    Bounds raw;
+    double sum[3] = {0.0, 0.0, 0.0};
+    Vertex center{0.f, 0.f, 0.f};
+    float scale = 1.f;
+  };
 
   AffineTransformer transformer_;
   std::vector<Vertex> vertices_;
-  std::vector<Vertex> originalVertices_;
-  std::vector<Polygon> polygons_;
+  Mesh mesh_;
+  VertexArrays originalArrays_;
+  VertexArrays transformedArrays_;
   std::string filename_;
+  bool preview_ = false;
+  Preview previewState_;
   Transform current_{};
+  Vertex center_{0.f, 0.f, 0.f};
+  bool matrixDirty_ = true;
+  bool transformDirty_ = false;
+  unsigned long long geometryVersion_ = 0;
+  unsigned long long previewVersion_ = 0;
+  unsigned loadThreads_ = 0;
+  bool cacheEnabled_ = false;
+  bool reorderEnabled_ = false;
+  bool lodEnabled_ = false;
+  float lodThreshold_ = 1.f;
+  int forcedLod_ = -1;
+  std::vector<Vertex> lodVertices_;
+  size_t lodVerticesLevel_ = 0;
+  bool pickIndexEnabled_ = false;
+  bool edgeClustersEnabled_ = false;
+  bool loadedFromCache_ = false;
+  // Per entry of mesh_.groups.
+  std::vector<char> groupHidden_;
+  size_t hiddenGroups_ = 0;
+  std::vector<EdgeClusters::Range> visibleEdges_;
+  // Per vertex, whether a shown face uses it; built by the first
+  // pickVertex() while a group is hidden, dropped on visibility changes.
+  std::vector<char> visibleVertices_;
+  VertexLayout layout_ = VertexLayout::kArrayOfStructs;
+  bool verticesStale_ = false;
+  // Compact storage of the full mesh; mesh_.vertices and mesh_.polygons are
+  // empty while compact_ is set.
+  bool compact_ = false;
+  QuantizedVertices quantized_;
+  CompactIndices polygonIndices_;
+  std::vector<unsigned int> polygonOffsets_;
+  // Decoded on demand by the const accessors.
+  mutable std::vector<Vertex> decodedVertices_;
+  mutable PolygonList decodedPolygons_;
 };
 
 }  // namespace s21
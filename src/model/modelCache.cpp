@@ -0,0 +1,256 @@
+#include "modelCache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+#include "hash.h"
+#include "mappedFile.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', '2', '1', 'M', 'E', 'S', 'H', '\0'};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  uint64_t sourceSize;
+  int64_t sourceMtimeNs;
+  uint64_t sourceHash;
+  uint64_t vertexCount;
+  uint64_t polygonCount;
+  uint64_t indexCount;
+  uint64_t edgeCount;
+  uint64_t groupCount;
+  uint64_t groupTextBytes;
+  float bounds[6];
+  uint64_t payloadHash;
+};
+
+// One FaceGroup; its names follow in the text section, back to back.
+struct GroupRecord {
+  uint32_t firstFace, faceCount, firstEdge, edgeCount;
+  uint32_t objectBytes, groupBytes, materialBytes, sharedEdgeCount;
+};
+
+constexpr int kSections = 6;
+
+// Payload sections, in file order.
+struct Layout {
+  uint64_t vertexBytes, offsetBytes, indexBytes, edgeBytes, groupBytes,
+      groupTextBytes;
+  uint64_t total() const {
+    return vertexBytes + offsetBytes + indexBytes + edgeBytes + groupBytes +
+           groupTextBytes;
+  }
+  void sizes(uint64_t out[kSections]) const {
+    const uint64_t all[kSections] = {vertexBytes, offsetBytes, indexBytes,
+                                     edgeBytes,   groupBytes,  groupTextBytes};
+    std::copy(all, all + kSections, out);
+  }
+};
+
+// Hash of the concatenated section hashes, so the writer can stream the
+// sections without assembling the payload in memory first.
+uint64_t payloadHash(const void *const sections[kSections],
+                     const Layout &layout) {
+  uint64_t bytes[kSections];
+  layout.sizes(bytes);
+  uint64_t hashes[kSections];
+  for (int i = 0; i < kSections; ++i)
+    hashes[i] = hashBytes(sections[i], bytes[i]);
+  return hashBytes(hashes, sizeof(hashes));
+}
+
+Layout layoutFor(const Header &h) {
+  return {h.vertexCount * sizeof(Vertex),
+          (h.polygonCount + 1) * sizeof(unsigned int),
+          h.indexCount * sizeof(unsigned int),
+          h.edgeCount * sizeof(Edge),
+          h.groupCount * sizeof(GroupRecord),
+          h.groupTextBytes};
+}
+
+// Whether the arrays describe a mesh the rest of the code can index
+// without bounds checks: offsets rise from 0 to the index count, every
+// vertex reference is in range and every group range lies inside the faces
+// and edges. The payload hash only proves the file is what was written.
+bool validTopology(const Header &h, const unsigned int *offsets,
+                   const unsigned int *indices, const Edge *edges,
+                   const GroupRecord *records) {
+  if (offsets[0] != 0 || offsets[h.polygonCount] != h.indexCount)
+    return false;
+  for (uint64_t i = 0; i < h.polygonCount; ++i)
+    if (offsets[i] > offsets[i + 1]) return false;
+  for (uint64_t i = 0; i < h.indexCount; ++i)
+    if (indices[i] >= h.vertexCount) return false;
+  for (uint64_t i = 0; i < h.edgeCount; ++i)
+    if (edges[i].a >= h.vertexCount || edges[i].b >= h.vertexCount)
+      return false;
+  for (uint64_t i = 0; i < h.groupCount; ++i) {
+    GroupRecord r;
+    std::memcpy(&r, records + i, sizeof(r));
+    if (uint64_t{r.firstFace} + r.faceCount > h.polygonCount ||
+        uint64_t{r.firstEdge} + r.edgeCount > h.edgeCount ||
+        r.sharedEdgeCount > r.edgeCount)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string ModelCache::cachePath(const std::string &source) {
+  return source + ".s21cache";
+}
+
+bool ModelCache::load(const std::string &source, Mesh &mesh) {
+  FileStamp stamp;
+  if (!fileStamp(source, stamp)) return false;
+
+  try {
+    MappedFile file(cachePath(source));
+    if (file.size() < sizeof(Header)) return false;
+
+    Header h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 ||
+        h.version != kVersion || h.headerSize != sizeof(Header) ||
+        h.sourceSize != stamp.size || h.sourceMtimeNs != stamp.mtimeNs)
+      return false;
+
+    // Guard the size arithmetic against absurd counts before trusting it.
+    const uint64_t limit = file.size();
+    if (h.vertexCount > limit || h.polygonCount > limit ||
+        h.indexCount > limit || h.edgeCount > limit ||
+        h.groupCount > limit || h.groupTextBytes > limit)
+      return false;
+    const Layout layout = layoutFor(h);
+    if (sizeof(Header) + layout.total() != file.size()) return false;
+
+    const char *payload = file.data() + sizeof(Header);
+    const auto *vertices = reinterpret_cast<const Vertex *>(payload);
+    payload += layout.vertexBytes;
+    const auto *offsets = reinterpret_cast<const unsigned int *>(payload);
+    payload += layout.offsetBytes;
+    const auto *indices = reinterpret_cast<const unsigned int *>(payload);
+    payload += layout.indexBytes;
+    const auto *edges = reinterpret_cast<const Edge *>(payload);
+    payload += layout.edgeBytes;
+    const auto *records = reinterpret_cast<const GroupRecord *>(payload);
+    payload += layout.groupBytes;
+    const char *text = payload;
+
+    const void *sections[kSections] = {vertices, offsets, indices,
+                                       edges,    records, text};
+    if (payloadHash(sections, layout) != h.payloadHash) return false;
+
+    if (!validTopology(h, offsets, indices, edges, records)) return false;
+
+    // Size and mtime miss edits that keep both (a same-size rewrite with
+    // the timestamp restored), so the source itself must still hash to
+    // what was parsed. This reads the source once at memory speed, far
+    // less than parsing it; the mapping is dropped before the copies.
+    {
+      MappedFile sourceFile(source);
+      if (hashBytes(sourceFile.data(), sourceFile.size()) != h.sourceHash)
+        return false;
+    }
+
+    std::vector<FaceGroup> groups(h.groupCount);
+    uint64_t textUsed = 0;
+    for (size_t i = 0; i < groups.size(); ++i) {
+      GroupRecord r;
+      std::memcpy(&r, records + i, sizeof(r));
+      const uint64_t nameBytes =
+          uint64_t{r.objectBytes} + r.groupBytes + r.materialBytes;
+      if (nameBytes > h.groupTextBytes - textUsed) return false;
+      FaceGroup &g = groups[i];
+      g.object.assign(text + textUsed, r.objectBytes);
+      textUsed += r.objectBytes;
+      g.group.assign(text + textUsed, r.groupBytes);
+      textUsed += r.groupBytes;
+      g.material.assign(text + textUsed, r.materialBytes);
+      textUsed += r.materialBytes;
+      g.firstFace = r.firstFace;
+      g.faceCount = r.faceCount;
+      g.firstEdge = r.firstEdge;
+      g.edgeCount = r.edgeCount;
+      g.sharedEdgeCount = r.sharedEdgeCount;
+    }
+
+    mesh.vertices.assign(vertices, vertices + h.vertexCount);
+    mesh.polygons.assign(indices, h.indexCount, offsets, h.polygonCount + 1);
+    mesh.edges.assign(edges, edges + h.edgeCount);
+    mesh.groups = std::move(groups);
+    mesh.bounds = {{h.bounds[0], h.bounds[1], h.bounds[2]},
+                   {h.bounds[3], h.bounds[4], h.bounds[5]}};
+    mesh.sourceHash = h.sourceHash;
+    return true;
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+bool ModelCache::store(const std::string &source, const Mesh &mesh) {
+  Header h{};
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version = kVersion;
+  h.headerSize = sizeof(Header);
+  FileStamp stamp;
+  if (!fileStamp(source, stamp)) return false;
+  h.sourceSize = stamp.size;
+  h.sourceMtimeNs = stamp.mtimeNs;
+  h.sourceHash = mesh.sourceHash;
+  h.vertexCount = mesh.vertices.size();
+  h.polygonCount = mesh.polygons.size();
+  h.indexCount = mesh.polygons.indices().size();
+  h.edgeCount = mesh.edges.size();
+  std::vector<GroupRecord> records;
+  std::string text;
+  for (const FaceGroup &g : mesh.groups) {
+    records.push_back({g.firstFace, g.faceCount, g.firstEdge, g.edgeCount,
+                       static_cast<uint32_t>(g.object.size()),
+                       static_cast<uint32_t>(g.group.size()),
+                       static_cast<uint32_t>(g.material.size()),
+                       g.sharedEdgeCount});
+    text += g.object + g.group + g.material;
+  }
+  h.groupCount = records.size();
+  h.groupTextBytes = text.size();
+  const Bounds &b = mesh.bounds;
+  const float bounds[6] = {b.min.x, b.min.y, b.min.z,
+                           b.max.x, b.max.y, b.max.z};
+  std::memcpy(h.bounds, bounds, sizeof(bounds));
+
+  const Layout layout = layoutFor(h);
+  const void *sections[kSections] = {
+      mesh.vertices.data(), mesh.polygons.offsets().data(),
+      mesh.polygons.indices().data(), mesh.edges.data(), records.data(),
+      text.data()};
+  uint64_t bytes[kSections];
+  layout.sizes(bytes);
+  h.payloadHash = payloadHash(sections, layout);
+
+  // Write to a temporary name and rename, so readers never see a partial
+  // file.
+  const std::string path = cachePath(source);
+  const std::string tmp = path + ".tmp" + std::to_string(::getpid());
+  std::FILE *f = std::fopen(tmp.c_str(), "wb");
+  if (!f) return false;
+  bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+  for (int i = 0; ok && i < kSections; ++i)
+    ok = bytes[i] == 0 || std::fwrite(sections[i], bytes[i], 1, f) == 1;
+  ok = (std::fclose(f) == 0) && ok;
+  if (ok) ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+  if (!ok) std::remove(tmp.c_str());
+  return ok;
+}
+
+}  // namespace s21
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "mesh.h"
+
+namespace s21 {
+
+// Versioned binary sidecar ("<model>.s21cache") holding a model after
+// parsing and normalization. The payload is a fixed header followed by the
+// raw vertex, offset, index and edge arrays and the face groups, so loading
+// is a straight copy out of the mapped file.
+//
+// A cache entry is used only if the source file still has the recorded
+// size, modification time and content hash, the payload hash matches and
+// the arrays form a valid mesh (offsets in order, vertex references and
+// group ranges in bounds); anything else (missing, stale, truncated,
+// corrupted, other format version) is treated as a miss.
+class ModelCache {
+ public:
+  static constexpr uint32_t kVersion = 3;
+
+  static std::string cachePath(const std::string &source);
+
+  // Returns false and leaves mesh untouched on a cache miss.
+  static bool load(const std::string &source, Mesh &mesh);
+  // Best effort: returns false if the sidecar cannot be written.
+  static bool store(const std::string &source, const Mesh &mesh);
+};
+
+}  // namespace s21
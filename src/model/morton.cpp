@@ -0,0 +1,56 @@
+#include "morton.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace s21 {
+
+namespace {
+
+uint32_t cell(float v, float lo, float hi) {
+  const float size = hi - lo;
+  const float unit = size > 0.f ? (v - lo) / size : 0.f;
+  return static_cast<uint32_t>(std::clamp(unit * 1023.f, 0.f, 1023.f));
+}
+
+// Spreads the low 10 bits of v to every third bit.
+uint32_t spread(uint32_t v) {
+  v = (v | (v << 16)) & 0x030000FFu;
+  v = (v | (v << 8)) & 0x0300F00Fu;
+  v = (v | (v << 4)) & 0x030C30C3u;
+  return (v | (v << 2)) & 0x09249249u;
+}
+
+}  // namespace
+
+uint32_t mortonCode(const Vertex &p, const Bounds &range) {
+  return spread(cell(p.x, range.min.x, range.max.x)) |
+         spread(cell(p.y, range.min.y, range.max.y)) << 1 |
+         spread(cell(p.z, range.min.z, range.max.z)) << 2;
+}
+
+std::vector<unsigned> sortByCode(std::vector<uint32_t> &codes) {
+  constexpr int kRadixBits = 15;
+  constexpr uint32_t kRadixMask = (1u << kRadixBits) - 1;
+  const size_t count = codes.size();
+  std::vector<unsigned> order(count), sorted(count);
+  std::vector<uint32_t> sortedCodes(count);
+  std::iota(order.begin(), order.end(), 0u);
+  std::vector<size_t> offsets(kRadixMask + 2);
+  for (int shift = 0; shift < 30; shift += kRadixBits) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for (uint32_t code : codes) ++offsets[((code >> shift) & kRadixMask) + 1];
+    for (size_t i = 0; i + 1 < offsets.size(); ++i)
+      offsets[i + 1] += offsets[i];
+    for (size_t i = 0; i < count; ++i) {
+      const size_t slot = offsets[(codes[i] >> shift) & kRadixMask]++;
+      sorted[slot] = order[i];
+      sortedCodes[slot] = codes[i];
+    }
+    order.swap(sorted);
+    codes.swap(sortedCodes);
+  }
+  return order;
+}
+
+}  // namespace s21
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geometry.h"
+
+namespace s21 {
+
+// 30-bit Morton (Z-order) code of p on a 1024^3 grid spanning range. Points
+// outside range are clamped onto it.
+uint32_t mortonCode(const Vertex &p, const Bounds &range);
+
+// Indices 0..codes.size()-1 in ascending code order, by a stable two-pass
+// LSD radix sort; codes ends up sorted as well.
+std::vector<unsigned> sortByCode(std::vector<uint32_t> &codes);
+
+}  // namespace s21
@@ -0,0 +1,444 @@
+#include "objParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "profiler.h"
+#include "threadPool.h"
+
+namespace s21 {
+
+namespace {
+
+inline bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline const char *skipBlanks(const char *p, const char *end) {
+  while (p < end && isBlank(*p)) ++p;
+  return p;
+}
+
+inline const char *skipToken(const char *p, const char *end) {
+  while (p < end && !isBlank(*p)) ++p;
+  return p;
+}
+
+// std::from_chars rejects an explicit '+', which operator>> accepts.
+inline const char *parseFloat(const char *p, const char *end, float &out) {
+  if (p < end && *p == '+') ++p;
+  auto [ptr, ec] = std::from_chars(p, end, out);
+  return ec == std::errc() ? ptr : nullptr;
+}
+
+// Splits text into about `count` pieces, each ending after a newline (or at
+// the end of the text).
+std::vector<std::string_view> splitLines(std::string_view text, size_t count) {
+  std::vector<std::string_view> chunks;
+  chunks.reserve(count);
+  size_t begin = 0;
+  for (size_t i = 1; i <= count && begin < text.size(); ++i) {
+    size_t end = std::max(begin, text.size() * i / count);
+    if (i < count) {
+      end = text.find('\n', end);
+      end = (end == std::string_view::npos) ? text.size() : end + 1;
+    }
+    chunks.push_back(text.substr(begin, end - begin));
+    begin = end;
+  }
+  return chunks;
+}
+
+// An "o", "g" or "usemtl" statement and the number of faces before it.
+struct GroupMark {
+  char kind;  // 'o', 'g' or 'm' (usemtl)
+  std::string name;
+  size_t face;
+};
+
+// A relative index met in a parallel chunk, which cannot know how many
+// vertices the earlier chunks hold: the index at `position` of the chunk's
+// polygons refers to vertex `local` counted from the chunk's first vertex
+// (negative when it lies in an earlier chunk).
+struct RelativeIndex {
+  unsigned position;
+  long long local;
+};
+
+// Where one piece of text is parsed to.
+struct ParseTarget {
+  std::vector<Vertex> &vertices;
+  PolygonList &polygons;
+  // File vertices before vertices[0].
+  size_t vertexBase = 0;
+  std::vector<GroupMark> *marks = nullptr;
+  // Set for parallel chunks: relative indices are recorded here and
+  // resolved at stitch time instead of being checked right away.
+  std::vector<RelativeIndex> *relative = nullptr;
+};
+
+// Relative indices are rare; the fail path and their bookkeeping stay out
+// of the loop over plain indices.
+[[noreturn]] void failFace(const char *message, std::string_view line,
+                           PolygonList &polygons,
+                           std::vector<RelativeIndex> *relative,
+                           size_t relativeBefore) {
+  polygons.discardPending();
+  if (relative) relative->resize(relativeBefore);
+  throw std::runtime_error(message + std::string(line));
+}
+
+void parseFace(std::string_view line, PolygonList &polygons,
+               size_t vertexCount, std::vector<RelativeIndex> *relative) {
+  const char *end = line.data() + line.size();
+  const char *p = skipToken(skipBlanks(line.data(), end), end);
+  const size_t relativeBefore = relative ? relative->size() : 0;
+
+  for (p = skipBlanks(p, end); p < end; p = skipBlanks(p, end)) {
+    const bool negative = *p == '-';
+    unsigned idx = 0;
+    auto [ptr, ec] = std::from_chars(p + negative, end, idx);
+    if (ec != std::errc() || (negative && idx == 0))
+      failFace("Invalid polygon index: ", line, polygons, relative,
+               relativeBefore);
+    if (!negative) {
+      polygons.appendIndex(idx - 1);
+    } else if (relative) {
+      const auto position = static_cast<unsigned>(polygons.indices().size());
+      relative->push_back({position, static_cast<long long>(vertexCount) -
+                                         static_cast<long long>(idx)});
+      polygons.appendIndex(0);
+    } else {
+      // -1 is the last vertex defined so far.
+      if (idx > vertexCount)
+        failFace("Invalid polygon index: ", line, polygons, relative,
+                 relativeBefore);
+      polygons.appendIndex(static_cast<unsigned>(vertexCount - idx));
+    }
+    // Texture and normal references ("v/vt/vn") are not used.
+    p = skipToken(ptr, end);
+  }
+
+  if (polygons.pendingSize() >= 3)
+    polygons.commitPolygon();
+  else
+    failFace("Invalid polygon (less than 3 vertices): ", line, polygons,
+             relative, relativeBefore);
+}
+
+void parseInto(std::string_view text, ParseTarget &target) {
+  ScopedTimer timer(Stage::kParse);
+  const char *p = text.data();
+  const char *end = p + text.size();
+
+  while (p < end) {
+    const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    const char *lineEnd = nl ? nl : end;
+    const char *tok = skipBlanks(p, lineEnd);
+    const char *tokEnd = skipToken(tok, lineEnd);
+    const std::string_view line(p, lineEnd - p);
+
+    char mark = 0;
+    if (tokEnd - tok == 1) {
+      if (*tok == 'v')
+        ObjParser::parseVertex(line, target.vertices);
+      else if (*tok == 'f')
+        parseFace(line, target.polygons,
+                  target.vertexBase + target.vertices.size(), target.relative);
+      else if (*tok == 'o' || *tok == 'g')
+        mark = *tok;
+    } else if (std::string_view(tok, tokEnd - tok) == "usemtl") {
+      mark = 'm';
+    }
+    if (mark && target.marks) {
+      const char *name = skipBlanks(tokEnd, lineEnd);
+      const char *nameEnd = lineEnd;
+      while (nameEnd > name && isBlank(nameEnd[-1])) --nameEnd;
+      target.marks->push_back(
+          {mark, std::string(name, nameEnd), target.polygons.size()});
+    }
+    p = nl ? nl + 1 : end;
+  }
+}
+
+// Capacity for `extra` more elements. Exact when the storage has to grow
+// anyway, but never less than doubling, so appending many small texts to
+// the same containers stays linear.
+size_t grownCapacity(size_t size, size_t capacity, size_t extra) {
+  if (size + extra <= capacity) return capacity;
+  return std::max(size + extra, capacity * 2);
+}
+
+// Makes room for everything parsing `text` appends, so an empty container
+// is allocated once instead of doubling its way up.
+void reserveFor(std::string_view text, std::vector<Vertex> &vertices,
+                PolygonList &polygons) {
+  const ObjCounts counts = ObjParser::count(text);
+  const std::vector<unsigned> &offsets = polygons.offsets();
+  const std::vector<unsigned> &indices = polygons.indices();
+  vertices.reserve(
+      grownCapacity(vertices.size(), vertices.capacity(), counts.vertices));
+  polygons.reserve(
+      grownCapacity(offsets.size(), offsets.capacity(), counts.faces) - 1,
+      grownCapacity(indices.size(), indices.capacity(), counts.indices));
+}
+
+// Replays the marks, ordered by face, into groups covering faces
+// [first, end). Runs without faces are dropped; no marks, no groups.
+void buildGroups(const std::vector<GroupMark> &marks, size_t first,
+                 size_t end, std::vector<FaceGroup> &groups) {
+  groups.clear();
+  if (marks.empty()) return;
+  FaceGroup current;
+  current.firstFace = static_cast<unsigned>(first);
+  auto close = [&](size_t face) {
+    if (face == current.firstFace) return;
+    current.faceCount = static_cast<unsigned>(face - current.firstFace);
+    groups.push_back(current);
+    current.firstFace = static_cast<unsigned>(face);
+  };
+  for (const GroupMark &mark : marks) {
+    close(mark.face);
+    if (mark.kind == 'o')
+      current.object = mark.name;
+    else if (mark.kind == 'g')
+      current.group = mark.name;
+    else
+      current.material = mark.name;
+  }
+  close(end);
+}
+
+}  // namespace
+
+ObjCounts ObjParser::count(std::string_view text) {
+  ObjCounts counts;
+  const char *p = text.data();
+  const char *end = p + text.size();
+  while (p < end) {
+    const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    const char *lineEnd = nl ? nl : end;
+    const char *tok = skipBlanks(p, lineEnd);
+    if (tok < lineEnd && (tok + 1 == lineEnd || isBlank(tok[1]))) {
+      if (*tok == 'v') {
+        ++counts.vertices;
+      } else if (*tok == 'f') {
+        ++counts.faces;
+        for (const char *q = skipBlanks(tok + 1, lineEnd); q < lineEnd;
+             q = skipBlanks(skipToken(q, lineEnd), lineEnd))
+          ++counts.indices;
+      }
+    }
+    p = nl ? nl + 1 : end;
+  }
+  return counts;
+}
+
+void ObjParser::parseText(std::string_view text, std::vector<Vertex> &vertices,
+                          PolygonList &polygons,
+                          std::vector<FaceGroup> *groups) {
+  std::vector<GroupMark> marks;
+  const size_t firstFace = polygons.size();
+  reserveFor(text, vertices, polygons);
+  ParseTarget target{vertices, polygons, 0, groups ? &marks : nullptr};
+  parseInto(text, target);
+  if (groups) buildGroups(marks, firstFace, polygons.size(), *groups);
+}
+
+void ObjParser::parseParallel(std::string_view text, unsigned threads,
+                              std::vector<Vertex> &vertices,
+                              PolygonList &polygons,
+                              const LoadProgress *progress,
+                              size_t minChunkBytes,
+                              std::vector<FaceGroup> *groups) {
+  ThreadPool &pool = ThreadPool::shared();
+  if (threads == 0 || threads > pool.concurrency())
+    threads = pool.concurrency();
+  const bool streaming = progress && progress->onBatch;
+  const size_t maxChunkBytes = streaming ? kStreamChunkBytes : kMaxChunkBytes;
+  minChunkBytes = std::clamp<size_t>(minChunkBytes, 1, maxChunkBytes);
+
+  // A few chunks per thread keeps the workers busy when line density varies
+  // across the file; the size cap bounds progress and cancellation latency.
+  size_t chunkCount = std::max<size_t>(
+      threads > 1 ? size_t{threads} * 4 : 1,
+      (text.size() + maxChunkBytes - 1) / maxChunkBytes);
+  chunkCount = std::max<size_t>(
+      1, std::min(chunkCount, text.size() / minChunkBytes));
+  const std::vector<std::string_view> chunks = splitLines(text, chunkCount);
+
+  std::atomic<size_t> done{0};
+  auto chunkDone = [&](size_t bytes) {
+    size_t total = done.fetch_add(bytes) + bytes;
+    if (progress && progress->onProgress)
+      progress->onProgress(total, text.size());
+  };
+
+  const size_t firstFace = polygons.size();
+  std::vector<GroupMark> marks;
+  std::vector<GroupMark> *markTarget = groups ? &marks : nullptr;
+
+  if (threads <= 1 || chunks.size() < 2) {
+    reserveFor(text, vertices, polygons);
+    std::vector<Vertex> batchVertices;
+    PolygonList batchPolygons;
+    for (std::string_view chunk : chunks) {
+      if (progress && progress->isCancelled()) throw LoadCancelled();
+      if (streaming) {
+        batchVertices.clear();
+        batchPolygons.clear();
+        const size_t markCount = marks.size();
+        ParseTarget target{batchVertices, batchPolygons, vertices.size(),
+                           markTarget};
+        parseInto(chunk, target);
+        for (size_t i = markCount; i < marks.size(); ++i)
+          marks[i].face += polygons.size();
+        progress->onBatch(batchVertices, batchPolygons);
+        vertices.insert(vertices.end(), batchVertices.begin(),
+                        batchVertices.end());
+        polygons.append(batchPolygons);
+      } else {
+        ParseTarget target{vertices, polygons, 0, markTarget};
+        parseInto(chunk, target);
+      }
+      chunkDone(chunk.size());
+    }
+    if (groups) buildGroups(marks, firstFace, polygons.size(), *groups);
+    return;
+  }
+
+  struct Chunk {
+    std::vector<Vertex> vertices;
+    PolygonList polygons;
+    std::vector<GroupMark> marks;
+    std::vector<RelativeIndex> relative;
+    bool rebased = false;
+    std::exception_ptr error;
+    bool ready = false;
+  };
+  std::vector<Chunk> parsed(chunks.size());
+
+  // Resolves the relative indices of chunk i once the vertices before it
+  // are counted. If one points before the first vertex, the chunk is parsed
+  // again the serial way, which throws the error parseText would.
+  auto rebase = [&](size_t i, size_t vertexBase) {
+    Chunk &c = parsed[i];
+    if (c.rebased) return;
+    const auto base = static_cast<long long>(vertexBase);
+    for (const RelativeIndex &r : c.relative) {
+      if (base + r.local >= 0) continue;
+      std::vector<Vertex> serialVertices;
+      PolygonList serialPolygons;
+      ParseTarget serial{serialVertices, serialPolygons, vertexBase};
+      parseInto(chunks[i], serial);
+    }
+    for (const RelativeIndex &r : c.relative)
+      c.polygons.setIndex(r.position, static_cast<unsigned>(base + r.local));
+    c.rebased = true;
+  };
+
+  // Chunks finish out of order; whoever completes the oldest outstanding one
+  // delivers it and every finished chunk right after it. Delivery stops at
+  // the first failed chunk, whose error is rethrown below.
+  std::mutex publishMutex;
+  size_t nextBatch = 0;
+  size_t publishedVertices = vertices.size();
+  auto publish = [&](size_t i) {
+    std::lock_guard<std::mutex> lock(publishMutex);
+    parsed[i].ready = true;
+    while (nextBatch < parsed.size() && parsed[nextBatch].ready) {
+      Chunk &c = parsed[nextBatch];
+      // A bad relative index may come before the line that failed.
+      try {
+        rebase(nextBatch, publishedVertices);
+      } catch (...) {
+        c.error = std::current_exception();
+      }
+      if (c.error) {
+        nextBatch = parsed.size();
+        break;
+      }
+      const size_t current = nextBatch;
+      nextBatch = parsed.size();  // stays closed if onBatch throws
+      progress->onBatch(c.vertices, c.polygons);
+      publishedVertices += c.vertices.size();
+      nextBatch = current + 1;
+    }
+  };
+
+  pool.parallelFor(chunks.size(), threads, [&](size_t i) {
+    try {
+      if (progress && progress->isCancelled()) throw LoadCancelled();
+      // The count pass leaves the chunk in cache for the parse.
+      reserveFor(chunks[i], parsed[i].vertices, parsed[i].polygons);
+      ParseTarget target{parsed[i].vertices, parsed[i].polygons, 0,
+                         groups ? &parsed[i].marks : nullptr,
+                         &parsed[i].relative};
+      parseInto(chunks[i], target);
+      chunkDone(chunks[i].size());
+    } catch (...) {
+      parsed[i].error = std::current_exception();
+    }
+    if (streaming) {
+      try {
+        publish(i);
+      } catch (...) {
+        if (!parsed[i].error) parsed[i].error = std::current_exception();
+      }
+    }
+  });
+  if (progress && progress->isCancelled()) throw LoadCancelled();
+
+  // Every chunk before the first failing one parsed cleanly, so its error is
+  // the one the serial parser would have reported.
+  size_t vertexTotal = vertices.size();
+  size_t polygonTotal = polygons.size();
+  size_t indexTotal = polygons.indices().size();
+  for (size_t i = 0; i < parsed.size(); ++i) {
+    const Chunk &c = parsed[i];
+    rebase(i, vertexTotal);
+    if (c.error) std::rethrow_exception(c.error);
+    vertexTotal += c.vertices.size();
+    polygonTotal += c.polygons.size();
+    indexTotal += c.polygons.indices().size();
+  }
+
+  // Each chunk is released as soon as it is copied, so the peak stays near
+  // one copy of the mesh rather than two.
+  vertices.reserve(vertexTotal);
+  polygons.reserve(polygonTotal, indexTotal);
+  for (auto &c : parsed) {
+    for (const GroupMark &mark : c.marks)
+      marks.push_back({mark.kind, mark.name, mark.face + polygons.size()});
+    vertices.insert(vertices.end(), c.vertices.begin(), c.vertices.end());
+    polygons.append(c.polygons);
+    c = Chunk{};
+  }
+  if (groups) buildGroups(marks, firstFace, polygons.size(), *groups);
+}
+
+void ObjParser::parseVertex(std::string_view line,
+                            std::vector<Vertex> &vertices) {
+  const char *end = line.data() + line.size();
+  const char *p = skipToken(skipBlanks(line.data(), end), end);
+
+  float xyz[3];
+  for (float &c : xyz) {
+    p = parseFloat(skipBlanks(p, end), end, c);
+    if (!p)
+      throw std::runtime_error("Invalid vertex line: " + std::string(line));
+  }
+  vertices.push_back({xyz[0], xyz[1], xyz[2]});
+}
+
+void ObjParser::parsePolygon(std::string_view line, PolygonList &polygons,
+                             size_t vertexCount) {
+  parseFace(line, polygons, vertexCount, nullptr);
+}
+
+}  // namespace s21
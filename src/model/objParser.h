@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "geometry.h"
+
+namespace s21 {
+
+// Optional progress reporting and cancellation for long loads.
+struct LoadProgress {
+  // Called with the number of bytes parsed so far; in parallel mode it may
+  // be called concurrently from worker threads.
+  std::function<void(size_t done, size_t total)> onProgress;
+  // Checked between chunks; once set, the load throws LoadCancelled.
+  const std::atomic<bool> *cancelled = nullptr;
+  // Streaming: receives the vertices and faces of each parsed chunk, in file
+  // order, as soon as every earlier chunk has been delivered. Face indices
+  // are file-global, relative ones included. Calls never overlap but may
+  // come from worker threads.
+  std::function<void(const std::vector<Vertex> &vertices,
+                     const PolygonList &polygons)>
+      onBatch;
+
+  bool isCancelled() const {
+    return cancelled && cancelled->load(std::memory_order_relaxed);
+  }
+};
+
+// Statement counts of an OBJ text, from ObjParser::count().
+struct ObjCounts {
+  size_t vertices = 0;
+  size_t faces = 0;
+  size_t indices = 0;
+};
+
+class LoadCancelled : public std::runtime_error {
+ public:
+  LoadCancelled() : std::runtime_error("Loading cancelled") {}
+};
+
+// Allocation-free scanner for the subset of Wavefront OBJ the viewer uses.
+// Works directly on a borrowed buffer (usually a MappedFile) and only ever
+// allocates when appending to the output containers or building an error
+// message. The containers are sized from a count() pre-scan first, so a
+// load allocates each of them once instead of growing them step by step.
+class ObjParser {
+ public:
+  // Files smaller than two chunks of this size are parsed serially.
+  static constexpr size_t kMinChunkBytes = 1 << 20;
+  // Upper bound on the work between two progress/cancellation checks.
+  static constexpr size_t kMaxChunkBytes = 4 << 20;
+  // Chunk size bound when LoadProgress::onBatch is set, so the first batch
+  // arrives after a fixed amount of parsing whatever the file size.
+  static constexpr size_t kStreamChunkBytes = 256 << 10;
+
+  // Counts "v" and "f" statements and face index tokens without converting
+  // any number; for text that parses these are exactly the sizes parseText
+  // appends. About a quarter of the cost of parsing.
+  static ObjCounts count(std::string_view text);
+  // Relative (negative) face indices count back from the last vertex
+  // parsed so far. If groups is set it receives the FaceGroup ranges of
+  // the appended faces; it is left empty when the text has no "o", "g" or
+  // "usemtl" statement. Edge ranges are filled in later by EdgeBuilder.
+  static void parseText(std::string_view text, std::vector<Vertex> &vertices,
+                        PolygonList &polygons,
+                        std::vector<FaceGroup> *groups = nullptr);
+  // Splits text at line boundaries and parses the pieces on the shared
+  // ThreadPool with at most `threads` threads (0 means all cores; 1 parses
+  // the chunks in order on the calling thread). The result, including which
+  // error is thrown, is identical to parseText. A chunk does not know how
+  // many vertices precede it, so its relative indices are resolved when the
+  // chunks are stitched together.
+  static void parseParallel(std::string_view text, unsigned threads,
+                            std::vector<Vertex> &vertices,
+                            PolygonList &polygons,
+                            const LoadProgress *progress = nullptr,
+                            size_t minChunkBytes = kMinChunkBytes,
+                            std::vector<FaceGroup> *groups = nullptr);
+  static void parseVertex(std::string_view line,
+                          std::vector<Vertex> &vertices);
+  // vertexCount is the number of vertices defined before the line, which
+  // relative indices count back from.
+  static void parsePolygon(std::string_view line, PolygonList &polygons,
+                           size_t vertexCount = 0);
+};
+
+}  // namespace s21
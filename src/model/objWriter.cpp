@@ -0,0 +1,83 @@
+#include "objWriter.h"
+
+#include <charconv>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+namespace s21 {
+
+namespace {
+
+constexpr size_t kBlockBytes = 1 << 20;
+// Longest line piece appended between two flush checks: "v" plus three
+// shortest-form floats, or one face index.
+constexpr size_t kMaxPieceBytes = 64;
+
+class BlockWriter {
+ public:
+  BlockWriter(std::FILE *file, const std::string &filename)
+      : file_(file), filename_(filename) {
+    buffer_.resize(kBlockBytes + kMaxPieceBytes);
+  }
+
+  char *reserve() {
+    if (used_ >= kBlockBytes) flush();
+    return buffer_.data() + used_;
+  }
+  void commit(char *end) { used_ = end - buffer_.data(); }
+  char *limit() { return buffer_.data() + buffer_.size(); }
+
+  void flush() {
+    if (used_ && std::fwrite(buffer_.data(), used_, 1, file_) != 1)
+      throw std::runtime_error("Cannot write file: " + filename_);
+    used_ = 0;
+  }
+
+ private:
+  std::FILE *file_;
+  const std::string &filename_;
+  std::string buffer_;
+  size_t used_ = 0;
+};
+
+}  // namespace
+
+void ObjWriter::write(const std::string &filename,
+                      const std::vector<Vertex> &vertices,
+                      const PolygonList &polygons) {
+  std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(
+      std::fopen(filename.c_str(), "wb"), &std::fclose);
+  if (!file) throw std::runtime_error("Cannot create file: " + filename);
+  BlockWriter out(file.get(), filename);
+
+  for (const auto &v : vertices) {
+    char *p = out.reserve();
+    *p++ = 'v';
+    for (float c : {v.x, v.y, v.z}) {
+      *p++ = ' ';
+      p = std::to_chars(p, out.limit(), c).ptr;
+    }
+    *p++ = '\n';
+    out.commit(p);
+  }
+  for (Polygon polygon : polygons) {
+    char *p = out.reserve();
+    *p++ = 'f';
+    out.commit(p);
+    for (unsigned index : polygon) {
+      p = out.reserve();
+      *p++ = ' ';
+      p = std::to_chars(p, out.limit(), index + 1).ptr;
+      out.commit(p);
+    }
+    p = out.reserve();
+    *p++ = '\n';
+    out.commit(p);
+  }
+  out.flush();
+  if (std::fflush(file.get()) != 0)
+    throw std::runtime_error("Cannot write file: " + filename);
+}
+
+}  // namespace s21
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+
+namespace s21 {
+
+// Writes "v" and "f" lines that ObjParser reads back bit for bit: floats
+// use the shortest round-trip representation (std::to_chars) and the file
+// is formatted in large blocks instead of per-value stdio calls.
+class ObjWriter {
+ public:
+  // Throws std::runtime_error on I/O errors.
+  static void write(const std::string &filename,
+                    const std::vector<Vertex> &vertices,
+                    const PolygonList &polygons);
+};
+
+}  // namespace s21
@@ -0,0 +1,152 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+namespace s21 {
+
+namespace {
+
+uint32_t threadIndex() {
+  static std::atomic<uint32_t> next{1};
+  thread_local const uint32_t index = next.fetch_add(1);
+  return index;
+}
+
+}  // namespace
+
+double ProfilerStats::verticesPerSecond() const {
+  const uint64_t ns = stage(Stage::kTransform).totalNs;
+  return ns ? verticesTransformed * 1e9 / ns : 0.0;
+}
+
+Profiler::Profiler() : epoch_(std::chrono::steady_clock::now()) {}
+
+Profiler &Profiler::instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+const char *Profiler::stageName(Stage stage) {
+  switch (stage) {
+    case Stage::kLoad:
+      return "load";
+    case Stage::kParse:
+      return "parse";
+    case Stage::kEdges:
+      return "edges";
+    case Stage::kNormalize:
+      return "normalize";
+    case Stage::kLod:
+      return "lod";
+    case Stage::kTransform:
+      return "transform";
+    case Stage::kCull:
+      return "cull";
+    case Stage::kInput:
+      return "input";
+    case Stage::kPaint:
+      return "paint";
+    case Stage::kCount:
+      break;
+  }
+  return "";
+}
+
+void Profiler::setEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_.store(enabled, std::memory_order_relaxed);
+  lastFrameNs_ = 0;
+}
+
+uint64_t Profiler::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - epoch_)
+      .count();
+}
+
+void Profiler::record(Stage stage, uint64_t startNs, uint64_t endNs) {
+  if (!enabled()) return;
+  const uint64_t duration = endNs - startNs;
+  const uint32_t thread = threadIndex();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  StageStats &s = stats_.stages[static_cast<size_t>(stage)];
+  ++s.calls;
+  s.totalNs += duration;
+  s.lastNs = duration;
+  s.maxNs = std::max(s.maxNs, duration);
+  if (events_.size() < kMaxTraceEvents)
+    events_.push_back(Event{stage, thread, startNs, duration});
+}
+
+void Profiler::addTransformedVertices(size_t count) {
+  if (!enabled()) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.verticesTransformed += count;
+}
+
+void Profiler::frame(size_t edges) {
+  if (!enabled()) return;
+  const uint64_t t = now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (lastFrameNs_ != 0) {
+    stats_.frameMs = (t - lastFrameNs_) * 1e-6;
+    // Mean over the frames that have a predecessor.
+    stats_.averageFrameMs +=
+        (stats_.frameMs - stats_.averageFrameMs) / stats_.frames;
+  }
+  ++stats_.frames;
+  lastFrameNs_ = t;
+  stats_.edgesPerFrame = edges;
+}
+
+void Profiler::recordCull(const CullStats &cull) {
+  if (!enabled()) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.cull = cull;
+  stats_.culledEdges += cull.skippedEdges();
+}
+
+void Profiler::setModelBytes(size_t bytes) {
+  if (!enabled()) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.modelBytes = bytes;
+  stats_.peakModelBytes = std::max(stats_.peakModelBytes, bytes);
+}
+
+ProfilerStats Profiler::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void Profiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_ = ProfilerStats{};
+  lastFrameNs_ = 0;
+  events_.clear();
+}
+
+void Profiler::writeChromeTrace(const std::string &filename) const {
+  std::unique_ptr<FILE, int (*)(FILE *)> file(std::fopen(filename.c_str(), "w"),
+                                              &std::fclose);
+  if (!file) throw std::runtime_error("Cannot create file: " + filename);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file.get());
+  for (size_t i = 0; i < events_.size(); ++i) {
+    const Event &e = events_[i];
+    std::fprintf(file.get(),
+                 "%s\n{\"name\":\"%s\",\"cat\":\"s21\",\"ph\":\"X\","
+                 "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                 i ? "," : "", stageName(e.stage), e.startNs * 1e-3,
+                 e.durationNs * 1e-3, e.thread);
+  }
+  std::fputs("\n]}\n", file.get());
+  if (std::fflush(file.get()) != 0)
+    throw std::runtime_error("Cannot write file: " + filename);
+}
+
+}  // namespace s21
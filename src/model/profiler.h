@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cullStats.h"
+
+namespace s21 {
+
+// Pipeline stages timed by ScopedTimer.
+enum class Stage {
+  kLoad,          // MeshLoader::load, cache lookup included
+  kParse,         // one ObjParser chunk; lines are not timed one by one
+  kEdges,         // EdgeBuilder::build
+  kNormalize,     // normalizeVertices
+  kLod,           // LodBuilder::build
+  kTransform,     // Model::rebuildFromTransform
+  kCull,          // EdgeClusters::cull
+  kInput,         // first coalesced transform command to frame presented
+  kPaint,         // WireframeWidget::paintGL
+  kCount
+};
+
+struct StageStats {
+  uint64_t calls = 0;
+  uint64_t totalNs = 0;
+  uint64_t lastNs = 0;
+  uint64_t maxNs = 0;
+
+  double totalMs() const { return totalNs * 1e-6; }
+  double lastMs() const { return lastNs * 1e-6; }
+  double averageMs() const { return calls ? totalMs() / calls : 0.0; }
+};
+
+struct ProfilerStats {
+  std::array<StageStats, static_cast<size_t>(Stage::kCount)> stages{};
+  uint64_t verticesTransformed = 0;
+  uint64_t frames = 0;
+  // Time between the starts of the last two frames, and its running mean.
+  double frameMs = 0.0;
+  double averageFrameMs = 0.0;
+  uint64_t edgesPerFrame = 0;
+  // Culling of the last frame and edges skipped by culling over all frames.
+  CullStats cull;
+  uint64_t culledEdges = 0;
+  size_t modelBytes = 0;
+  size_t peakModelBytes = 0;
+
+  const StageStats &stage(Stage s) const {
+    return stages[static_cast<size_t>(s)];
+  }
+  // Throughput of Model::rebuildFromTransform.
+  double verticesPerSecond() const;
+};
+
+// Process-wide stage timers and counters. Disabled by default: every entry
+// point then returns after one relaxed atomic load, so the instrumentation
+// can stay in release builds. Enabled, each timed scope takes a mutex once,
+// which is why only coarse operations (chunks, passes, frames) are timed.
+class Profiler {
+ public:
+  // Oldest trace events are kept; later ones are only aggregated.
+  static constexpr size_t kMaxTraceEvents = 1 << 18;
+
+  static Profiler &instance();
+  static const char *stageName(Stage stage);
+
+  void setEnabled(bool enabled);
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  void record(Stage stage, uint64_t startNs, uint64_t endNs);
+  void addTransformedVertices(size_t count);
+  // Marks the start of a frame that submits `edges` edges.
+  void frame(size_t edges);
+  // Reports what view culling skipped in the current frame.
+  void recordCull(const CullStats &cull);
+  void setModelBytes(size_t bytes);
+
+  ProfilerStats stats() const;
+  void reset();
+  // Writes the recorded scopes in Chrome trace-event format (load it in
+  // chrome://tracing or Perfetto). Throws std::runtime_error on I/O errors.
+  void writeChromeTrace(const std::string &filename) const;
+
+  // Nanoseconds since the profiler was created.
+  uint64_t now() const;
+
+ private:
+  struct Event {
+    Stage stage;
+    uint32_t thread;
+    uint64_t startNs;
+    uint64_t durationNs;
+  };
+
+  Profiler();
+
+  std::atomic<bool> enabled_{false};
+  const std::chrono::steady_clock::time_point epoch_;
+  mutable std::mutex mutex_;
+  ProfilerStats stats_;
+  uint64_t lastFrameNs_ = 0;
+  std::vector<Event> events_;
+};
+
+// Times the enclosing scope as `stage` if the profiler is enabled.
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Stage stage)
+      : stage_(stage),
+        startNs_(Profiler::instance().enabled() ? Profiler::instance().now()
+                                                : kInactive) {}
+  ~ScopedTimer() {
+    if (startNs_ != kInactive)
+      Profiler::instance().record(stage_, startNs_, Profiler::instance().now());
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+ private:
+  static constexpr uint64_t kInactive = ~uint64_t{0};
+
+  Stage stage_;
+  uint64_t startNs_;
+};
+
+}  // namespace s21
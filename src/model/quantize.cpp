@@ -0,0 +1,152 @@
+#include "quantize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "threadPool.h"
+
+namespace s21 {
+
+namespace {
+
+template <typename T>
+size_t bytes(const std::vector<T> &v) {
+  return v.capacity() * sizeof(T);
+}
+
+uint16_t quantize(float v, float min, float inv) {
+  const float q = std::round((v - min) * inv);
+  return static_cast<uint16_t>(
+      std::clamp(q, 0.f, static_cast<float>(QuantizedVertices::kLevels)));
+}
+
+}  // namespace
+
+void QuantizedVertices::encode(const std::vector<Vertex> &vertices) {
+  Bounds box;
+  if (!vertices.empty()) box = {vertices.front(), vertices.front()};
+  for (const Vertex &v : vertices) {
+    box.min = {std::min(box.min.x, v.x), std::min(box.min.y, v.y),
+               std::min(box.min.z, v.z)};
+    box.max = {std::max(box.max.x, v.x), std::max(box.max.y, v.y),
+               std::max(box.max.z, v.z)};
+  }
+  const float levels = static_cast<float>(kLevels);
+  min_ = box.min;
+  step_ = {(box.max.x - box.min.x) / levels, (box.max.y - box.min.y) / levels,
+           (box.max.z - box.min.z) / levels};
+  // A flat axis keeps q = 0 and decodes to its minimum.
+  auto inverse = [](float step) { return step > 0.f ? 1.f / step : 0.f; };
+  const Vertex inv{inverse(step_.x), inverse(step_.y), inverse(step_.z)};
+
+  const size_t n = vertices.size();
+  x_.resize(n);
+  y_.resize(n);
+  z_.resize(n);
+  maxError_ = 0.f;
+  for (size_t i = 0; i < n; ++i) {
+    const Vertex &v = vertices[i];
+    x_[i] = quantize(v.x, min_.x, inv.x);
+    y_[i] = quantize(v.y, min_.y, inv.y);
+    z_[i] = quantize(v.z, min_.z, inv.z);
+    const Vertex d = (*this)[i];
+    maxError_ = std::max({maxError_, std::abs(d.x - v.x),
+                          std::abs(d.y - v.y), std::abs(d.z - v.z)});
+  }
+}
+
+void QuantizedVertices::clear() {
+  x_.clear();
+  y_.clear();
+  z_.clear();
+  min_ = step_ = Vertex{0.f, 0.f, 0.f};
+  maxError_ = 0.f;
+}
+
+Vertex QuantizedVertices::operator[](size_t i) const {
+  return {min_.x + step_.x * x_[i], min_.y + step_.y * y_[i],
+          min_.z + step_.z * z_[i]};
+}
+
+void QuantizedVertices::appendTo(std::vector<Vertex> &out) const {
+  out.reserve(out.size() + size());
+  for (size_t i = 0; i < size(); ++i) out.push_back((*this)[i]);
+}
+
+AffineTransformer::Matrix QuantizedVertices::decodeMatrix(
+    const AffineTransformer::Matrix &m) const {
+  // M * (T(min) * S(step)): the linear columns scale by the step and the
+  // translation picks up M applied to min.
+  AffineTransformer::Matrix d = m;
+  const float step[3] = {step_.x, step_.y, step_.z};
+  const float min[3] = {min_.x, min_.y, min_.z};
+  for (int r = 0; r < 4; ++r) {
+    d[r][3] = m[r][0] * min[0] + m[r][1] * min[1] + m[r][2] * min[2] + m[r][3];
+    for (int k = 0; k < 3; ++k) d[r][k] = m[r][k] * step[k];
+  }
+  return d;
+}
+
+void QuantizedVertices::transform(const AffineTransformer::Matrix &m,
+                                  VertexArrays &out) const {
+  transform(m, out, TransformKernel::bestIsa());
+}
+
+void QuantizedVertices::transform(const AffineTransformer::Matrix &m,
+                                  VertexArrays &out,
+                                  TransformKernel::Isa isa) const {
+  transform(m, out, isa, 1);
+}
+
+void QuantizedVertices::transform(const AffineTransformer::Matrix &m,
+                                  VertexArrays &out, TransformKernel::Isa isa,
+                                  unsigned threads) const {
+  out.resize(size());
+  const AffineTransformer::Matrix d = decodeMatrix(m);
+  ThreadPool::shared().parallelBlocks(
+      size(), threads, [&](size_t, size_t begin, size_t end) {
+        TransformKernel::transform(d, x_.data() + begin, y_.data() + begin,
+                                   z_.data() + begin, out.x.data() + begin,
+                                   out.y.data() + begin, out.z.data() + begin,
+                                   end - begin, isa);
+      });
+}
+
+size_t QuantizedVertices::memoryBytes() const {
+  return bytes(x_) + bytes(y_) + bytes(z_);
+}
+
+void CompactIndices::assign(const std::vector<unsigned int> &indices) {
+  const unsigned int largest =
+      indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+  narrow_ = largest <= std::numeric_limits<uint16_t>::max();
+  if (narrow_) {
+    narrowIndices_.assign(indices.begin(), indices.end());
+    wideIndices_.clear();
+    wideIndices_.shrink_to_fit();
+  } else {
+    wideIndices_ = indices;
+    narrowIndices_.clear();
+    narrowIndices_.shrink_to_fit();
+  }
+}
+
+void CompactIndices::clear() {
+  narrow_ = true;
+  narrowIndices_.clear();
+  wideIndices_.clear();
+}
+
+void CompactIndices::widenTo(std::vector<unsigned int> &out) const {
+  if (narrow_)
+    out.assign(narrowIndices_.begin(), narrowIndices_.end());
+  else
+    out = wideIndices_;
+}
+
+size_t CompactIndices::memoryBytes() const {
+  return bytes(narrowIndices_) + bytes(wideIndices_);
+}
+
+}  // namespace s21
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "affineTransformer.h"
+#include "geometry.h"
+#include "transformKernel.h"
+
+namespace s21 {
+
+// Positions quantized to 16 bits per axis on a grid spanning their bounding
+// box, stored as three coordinate arrays: 6 bytes per vertex instead of 12.
+// Decoding is the affine map min + step * q, so it folds into any model
+// matrix and transform() decodes and transforms in one pass.
+class QuantizedVertices {
+ public:
+  static constexpr uint32_t kLevels = 65535;
+
+  // For normalized geometry the grid step is at most 1 / 65535 units.
+  void encode(const std::vector<Vertex> &vertices);
+  void clear();
+
+  size_t size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+  Vertex operator[](size_t i) const;
+  // Appends the decoded positions to out.
+  void appendTo(std::vector<Vertex> &out) const;
+  // Grid step per axis; the error bound of an axis is half its step.
+  const Vertex &step() const { return step_; }
+  // Largest difference along any axis between an encoded and a decoded
+  // position, measured by encode().
+  float maxError() const { return maxError_; }
+
+  // M * decode, the matrix taking the stored integers to M's output space.
+  AffineTransformer::Matrix decodeMatrix(
+      const AffineTransformer::Matrix &m) const;
+  // out = M * decode(q) for every vertex through TransformKernel.
+  void transform(const AffineTransformer::Matrix &m, VertexArrays &out) const;
+  void transform(const AffineTransformer::Matrix &m, VertexArrays &out,
+                 TransformKernel::Isa isa) const;
+  // On up to `threads` threads, as the TransformKernel overload.
+  void transform(const AffineTransformer::Matrix &m, VertexArrays &out,
+                 TransformKernel::Isa isa, unsigned threads) const;
+
+  // Heap bytes (capacity, not size).
+  size_t memoryBytes() const;
+
+ private:
+  std::vector<uint16_t> x_, y_, z_;
+  Vertex min_{0.f, 0.f, 0.f};
+  Vertex step_{0.f, 0.f, 0.f};
+  float maxError_ = 0.f;
+};
+
+// Vertex indices stored in 16 bits when every index fits, 32 otherwise.
+class CompactIndices {
+ public:
+  void assign(const std::vector<unsigned int> &indices);
+  void clear();
+
+  size_t size() const {
+    return narrow_ ? narrowIndices_.size() : wideIndices_.size();
+  }
+  bool narrow() const { return narrow_; }
+  unsigned int operator[](size_t i) const {
+    return narrow_ ? narrowIndices_[i] : wideIndices_[i];
+  }
+  // Replaces out with the indices widened to 32 bits.
+  void widenTo(std::vector<unsigned int> &out) const;
+  size_t memoryBytes() const;
+
+ private:
+  bool narrow_ = true;
+  std::vector<uint16_t> narrowIndices_;
+  std::vector<unsigned int> wideIndices_;
+};
+
+}  // namespace s21
@@ -0,0 +1,178 @@
+#include "scene.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "edgeClusters.h"
+#include "hash.h"
+#include "lodBuilder.h"
+#include "mappedFile.h"
+
+namespace s21 {
+
+const std::vector<Vertex> &SceneGeometry::vertices(size_t level) const {
+  return level == 0 ? mesh.vertices : mesh.lods[level - 1].vertices;
+}
+
+const std::vector<Edge> &SceneGeometry::edges(size_t level) const {
+  return level == 0 ? mesh.edges : mesh.lods[level - 1].edges;
+}
+
+void Scene::setLoadOptions(const LoadOptions &options) { options_ = options; }
+
+void Scene::setLodThreshold(float pixels) { lodThreshold_ = pixels; }
+
+size_t Scene::addFromFile(const std::string &filename) {
+  uint64_t hash = 0;
+  {
+    MappedFile file(filename);
+    hash = hashBytes(file.data(), file.size());
+  }
+  std::shared_ptr<const SceneGeometry> geometry;
+  if (auto it = byHash_.find(hash); it != byHash_.end())
+    geometry = it->second.lock();
+  if (!geometry) {
+    auto loaded = std::make_shared<SceneGeometry>();
+    LoadOptions options = options_;
+    options.buildEdgeClusters = true;
+    loaded->mesh = MeshLoader::load(filename, options);
+    loaded->center = centroid(loaded->mesh.vertices, options.threads);
+    loaded->hash = hash;
+    loaded->filename = filename;
+    geometry = loaded;
+    byHash_[hash] = geometry;
+  }
+  instances_.push_back({std::move(geometry), Transform{}, true});
+  ++version_;
+  return instances_.size() - 1;
+}
+
+size_t Scene::addInstance(size_t source) {
+  SceneInstance copy{instances_.at(source).geometry, Transform{}, true};
+  instances_.push_back(std::move(copy));
+  ++version_;
+  return instances_.size() - 1;
+}
+
+void Scene::remove(size_t index) {
+  if (index >= instances_.size())
+    throw std::out_of_range("Scene instance index out of range");
+  instances_.erase(instances_.begin() + static_cast<long>(index));
+  std::erase_if(byHash_, [](const auto &entry) {
+    return entry.second.expired();
+  });
+  ++version_;
+}
+
+void Scene::clear() {
+  instances_.clear();
+  byHash_.clear();
+  ++version_;
+}
+
+size_t Scene::size() const { return instances_.size(); }
+
+bool Scene::empty() const { return instances_.empty(); }
+
+const SceneInstance &Scene::instance(size_t index) const {
+  return instances_.at(index);
+}
+
+void Scene::setTransform(size_t index, const Transform &transform) {
+  instances_.at(index).transform = transform;
+}
+
+void Scene::setVisible(size_t index, bool visible) {
+  instances_.at(index).visible = visible;
+}
+
+size_t Scene::geometryCount() const {
+  std::unordered_set<const SceneGeometry *> unique;
+  for (const SceneInstance &i : instances_) unique.insert(i.geometry.get());
+  return unique.size();
+}
+
+std::vector<Scene::Batch> Scene::batches() const {
+  std::vector<Batch> result;
+  std::unordered_map<const SceneGeometry *, size_t> slot;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!instances_[i].visible) continue;
+    const SceneGeometry *g = instances_[i].geometry.get();
+    auto [it, inserted] = slot.try_emplace(g, result.size());
+    if (inserted) result.push_back({g, {}});
+    result[it->second].instances.push_back(i);
+  }
+  return result;
+}
+
+unsigned long long Scene::version() const { return version_; }
+
+void Scene::arrangeGrid(float margin) {
+  if (instances_.empty()) return;
+  const auto columns = static_cast<size_t>(
+      std::ceil(std::sqrt(static_cast<double>(instances_.size()))));
+  const float cell = 2.f / static_cast<float>(columns);
+  // Normalized geometry spans at most 1 unit along every axis.
+  const float scale = cell * (1.f - margin);
+  AffineTransformer transformer;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    SceneInstance &instance = instances_[i];
+    const float x = -1.f + cell * (static_cast<float>(i % columns) + 0.5f);
+    const float y = 1.f - cell * (static_cast<float>(i / columns) + 0.5f);
+    // Where the bounding box center lands without translation.
+    Transform t = instance.transform;
+    t.tx = t.ty = t.tz = 0.f;
+    t.s = scale;
+    const Bounds &b = instance.geometry->mesh.bounds;
+    Vertex center{(b.min.x + b.max.x) * 0.5f, (b.min.y + b.max.y) * 0.5f,
+                  (b.min.z + b.max.z) * 0.5f};
+    composeTransform(t, instance.geometry->center, transformer);
+    transformer.applyToVertex(center);
+    t.tx = x - center.x;
+    t.ty = y - center.y;
+    t.tz = -center.z;
+    instance.transform = t;
+  }
+}
+
+AffineTransformer::Matrix Scene::matrix(size_t index) const {
+  const SceneInstance &instance = instances_.at(index);
+  AffineTransformer transformer;
+  composeTransform(instance.transform, instance.geometry->center,
+                   transformer);
+  return transformer.matrix();
+}
+
+bool Scene::inView(size_t index) const {
+  return !viewBox(instances_.at(index).geometry->mesh.bounds, matrix(index))
+              .outsideView();
+}
+
+size_t Scene::selectLod(size_t index, float pixelsPerUnit) const {
+  const SceneInstance &instance = instances_.at(index);
+  return LodBuilder::select(instance.geometry->mesh.lods,
+                            instance.transform.s * pixelsPerUnit,
+                            lodThreshold_);
+}
+
+size_t Scene::cull(size_t index, float pixelsPerUnit,
+                   std::vector<EdgeClusters::Range> &ranges,
+                   CullStats &stats) const {
+  const size_t level = selectLod(index, pixelsPerUnit);
+  stats = instances_.at(index).geometry->clusters(level).cull(
+      matrix(index), pixelsPerUnit, ranges);
+  return level;
+}
+
+size_t Scene::memoryBytes() const {
+  std::unordered_set<const SceneGeometry *> counted;
+  size_t total = instances_.capacity() * sizeof(SceneInstance);
+  for (const SceneInstance &i : instances_) {
+    if (!counted.insert(i.geometry.get()).second) continue;
+    total += sizeof(SceneGeometry) + s21::memoryBytes(i.geometry->mesh);
+  }
+  return total;
+}
+
+}  // namespace s21
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "affineTransformer.h"
+#include "edgeClusters.h"
+#include "mesh.h"
+#include "meshLoader.h"
+#include "model.h"
+
+namespace s21 {
+
+// Loaded geometry shared by every instance of the same file contents. It is
+// never modified once added to a Scene, so it always carries the edge
+// clusters of every level.
+struct SceneGeometry {
+  Mesh mesh;
+  // Pivot for rotation and scale, as in Model.
+  Vertex center{0.f, 0.f, 0.f};
+  // hashBytes() of the source file.
+  uint64_t hash = 0;
+  // File the geometry was first loaded from.
+  std::string filename;
+
+  // Level 0 is the full mesh, level i is mesh.lods[i - 1].
+  size_t levelCount() const { return mesh.lods.size() + 1; }
+  const std::vector<Vertex> &vertices(size_t level) const;
+  const std::vector<Edge> &edges(size_t level) const;
+  const EdgeClusters &clusters(size_t level) const {
+    return *mesh.edgeClusters[level];
+  }
+};
+
+struct SceneInstance {
+  std::shared_ptr<const SceneGeometry> geometry;
+  Transform transform;
+  bool visible = true;
+};
+
+// Many placed copies of loaded models. Files with identical contents share
+// one SceneGeometry, so memory grows with the number of distinct parts
+// rather than with the number of instances: an instance is a pointer and a
+// Transform. batches() groups the instances by geometry, letting renderers
+// bind each geometry once per frame.
+class Scene {
+ public:
+  struct Batch {
+    const SceneGeometry *geometry = nullptr;
+    std::vector<size_t> instances;
+  };
+
+  // Used for geometry loaded from now on; edge clusters are always built.
+  void setLoadOptions(const LoadOptions &options);
+  // Same meaning as Model::setLodThreshold().
+  void setLodThreshold(float pixels);
+
+  // Appends an instance of the file with an identity transform and returns
+  // its index. The file is hashed before parsing; if an instance already
+  // holds geometry with the same hash, that geometry is reused and the file
+  // is not parsed again. Throws std::runtime_error like MeshLoader::load().
+  size_t addFromFile(const std::string &filename);
+  // Appends another instance of instance(source)'s geometry.
+  size_t addInstance(size_t source);
+  void remove(size_t index);
+  void clear();
+
+  size_t size() const;
+  bool empty() const;
+  const SceneInstance &instance(size_t index) const;
+  void setTransform(size_t index, const Transform &transform);
+  void setVisible(size_t index, bool visible);
+  // Distinct geometries referenced by the instances.
+  size_t geometryCount() const;
+  // Visible instances grouped by geometry, in order of first appearance.
+  std::vector<Batch> batches() const;
+  // Changes whenever instances are added or removed, not on transform
+  // changes, so renderers can cache per-geometry buffers.
+  unsigned long long version() const;
+
+  // Places the instances on a square grid filling the
+  // glOrtho(-1, 1, -1, 1, -10, 10) view, each scaled to leave `margin` of
+  // its cell free. Rotations are kept.
+  void arrangeGrid(float margin = 0.1f);
+
+  // Model matrix of an instance, as Model::transformMatrix() of a model
+  // holding its geometry.
+  AffineTransformer::Matrix matrix(size_t index) const;
+  // False when the instance's bounds miss the view volume.
+  bool inView(size_t index) const;
+  // Level of detail for the instance, as Model::selectLod().
+  size_t selectLod(size_t index, float pixelsPerUnit) const;
+  // Picks the level and runs EdgeClusters::cull() on it, so a small
+  // instance draws about as many edges as it covers pixels. Returns the
+  // level.
+  size_t cull(size_t index, float pixelsPerUnit,
+              std::vector<EdgeClusters::Range> &ranges,
+              CullStats &stats) const;
+  // Every distinct geometry counted once, plus the instances themselves.
+  size_t memoryBytes() const;
+
+ private:
+  LoadOptions options_;
+  float lodThreshold_ = 1.f;
+  std::vector<SceneInstance> instances_;
+  // Loaded geometry by file hash; entries expire with their last instance.
+  std::unordered_map<uint64_t, std::weak_ptr<const SceneGeometry>> byHash_;
+  unsigned long long version_ = 0;
+};
+
+}  // namespace s21
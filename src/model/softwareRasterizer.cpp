@@ -0,0 +1,233 @@
+#include "softwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+#include "edgeClusters.h"
+#include "model.h"
+#include "scene.h"
+#include "threadPool.h"
+
+namespace s21 {
+
+namespace {
+
+// Edge in window space: x to the right and y down in pixels, depth in
+// [0, 1] as glDepthRange(0, 1) would produce.
+struct ScreenLine {
+  float x0, y0, z0;
+  float x1, y1, z1;
+};
+
+// Liang-Barsky clipping against the NDC cube of
+// glOrtho(-1, 1, -1, 1, -10, 10), which maps z to -z / 10.
+bool project(const Vertex &a, const Vertex &b, int width, int height,
+             ScreenLine &out) {
+  const float p0[3] = {a.x, a.y, -a.z * 0.1f};
+  const float p1[3] = {b.x, b.y, -b.z * 0.1f};
+  float t0 = 0.f, t1 = 1.f;
+  for (int axis = 0; axis < 3; ++axis) {
+    const float d = p1[axis] - p0[axis];
+    // -1 <= p0 + t d  and  p0 + t d <= 1
+    const float pq[2][2] = {{-d, p0[axis] + 1.f}, {d, 1.f - p0[axis]}};
+    for (const auto &[p, q] : pq) {
+      if (p == 0.f) {
+        if (q < 0.f) return false;
+        continue;
+      }
+      const float t = q / p;
+      if (p < 0.f) {
+        if (t > t1) return false;
+        t0 = std::max(t0, t);
+      } else {
+        if (t < t0) return false;
+        t1 = std::min(t1, t);
+      }
+    }
+  }
+
+  auto toWindow = [&](float t, float &x, float &y, float &z) {
+    const float nx = p0[0] + t * (p1[0] - p0[0]);
+    const float ny = p0[1] + t * (p1[1] - p0[1]);
+    const float nz = p0[2] + t * (p1[2] - p0[2]);
+    x = (nx + 1.f) * 0.5f * width;
+    y = height - (ny + 1.f) * 0.5f * height;
+    z = (nz + 1.f) * 0.5f;
+  };
+  toWindow(t0, out.x0, out.y0, out.z0);
+  toWindow(t1, out.x1, out.y1, out.z1);
+  return true;
+}
+
+struct Tile {
+  int x0, y0, x1, y1;
+};
+
+// Samples the line at the centers of the pixel columns (x-major) or rows
+// (y-major) it crosses, restricted to the tile.
+void rasterize(const ScreenLine &l, const Tile &tile,
+               const RasterOptions &options, Framebuffer &target) {
+  float x0 = l.x0, y0 = l.y0, z0 = l.z0;
+  float x1 = l.x1, y1 = l.y1, z1 = l.z1;
+  const bool xMajor = std::abs(x1 - x0) >= std::abs(y1 - y0);
+  if (!xMajor) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 == x1) return;
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+    std::swap(z0, z1);
+  }
+  const int majorBegin = xMajor ? tile.x0 : tile.y0;
+  const int majorEnd = xMajor ? tile.x1 : tile.y1;
+  const int minorBegin = xMajor ? tile.y0 : tile.x0;
+  const int minorEnd = xMajor ? tile.y1 : tile.x1;
+
+  const int first = std::max(majorBegin, int(std::ceil(x0 - 0.5f)));
+  const int last = std::min(majorEnd, int(std::ceil(x1 - 0.5f)));
+  const float inv = 1.f / (x1 - x0);
+  for (int i = first; i < last; ++i) {
+    const float t = (i + 0.5f - x0) * inv;
+    const int j = int(std::floor(y0 + t * (y1 - y0)));
+    if (j < minorBegin || j >= minorEnd) continue;
+    const int px = xMajor ? i : j;
+    const int py = xMajor ? j : i;
+    if (options.depthTest) {
+      const float z = z0 + t * (z1 - z0);
+      float &depth = target.depth(px, py);
+      if (!(z < depth)) continue;
+      depth = z;
+    }
+    target.setPixel(px, py, options.line);
+  }
+}
+
+void appendLines(const std::vector<Vertex> &vertices,
+                 std::span<const Edge> edges, int width, int height,
+                 std::vector<ScreenLine> &lines) {
+  for (const Edge &e : edges) {
+    ScreenLine l;
+    if (e.a < vertices.size() && e.b < vertices.size() &&
+        project(vertices[e.a], vertices[e.b], width, height, l))
+      lines.push_back(l);
+  }
+}
+
+// Bins the lines into tiles and rasterizes the tiles in parallel.
+void drawLines(const std::vector<ScreenLine> &lines,
+               const RasterOptions &options, Framebuffer &target) {
+  const int width = target.width();
+  const int height = target.height();
+  const int tileSize = std::max(8, options.tileSize);
+  const int tilesX = (width + tileSize - 1) / tileSize;
+  const int tilesY = (height + tileSize - 1) / tileSize;
+  std::vector<std::vector<unsigned>> bins(size_t(tilesX) * tilesY);
+  auto tileOf = [tileSize](float v, int limit) {
+    return std::clamp(int(std::floor(v)), 0, limit - 1) / tileSize;
+  };
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const ScreenLine &l = lines[i];
+    const int tx0 = tileOf(std::min(l.x0, l.x1), width);
+    const int tx1 = tileOf(std::max(l.x0, l.x1), width);
+    const int ty0 = tileOf(std::min(l.y0, l.y1), height);
+    const int ty1 = tileOf(std::max(l.y0, l.y1), height);
+    for (int ty = ty0; ty <= ty1; ++ty)
+      for (int tx = tx0; tx <= tx1; ++tx)
+        bins[size_t(ty) * tilesX + tx].push_back(static_cast<unsigned>(i));
+  }
+
+  ThreadPool::shared().parallelFor(
+      bins.size(), options.threads, [&](size_t index) {
+        const int tx = static_cast<int>(index % tilesX);
+        const int ty = static_cast<int>(index / tilesX);
+        const Tile tile{tx * tileSize, ty * tileSize,
+                        std::min(width, (tx + 1) * tileSize),
+                        std::min(height, (ty + 1) * tileSize)};
+        for (unsigned i : bins[index])
+          rasterize(lines[i], tile, options, target);
+      });
+}
+
+}  // namespace
+
+void SoftwareRasterizer::render(const std::vector<Vertex> &vertices,
+                                const std::vector<Edge> &edges,
+                                const RasterOptions &options,
+                                Framebuffer &target) {
+  target.clear(options.background);
+  if (target.width() == 0 || target.height() == 0) return;
+  std::vector<ScreenLine> lines;
+  lines.reserve(edges.size());
+  appendLines(vertices, edges, target.width(), target.height(), lines);
+  drawLines(lines, options, target);
+}
+
+void SoftwareRasterizer::render(Model &model, const RasterOptions &options,
+                                Framebuffer &target) {
+  const size_t level =
+      model.selectLod(std::max(target.width(), target.height()) * 0.5f);
+  if (model.allGroupsVisible()) {
+    render(model.getLodVertices(level), model.getLodEdges(level), options,
+           target);
+    return;
+  }
+  // Hidden groups keep the full mesh; only the visible ranges are drawn.
+  target.clear(options.background);
+  if (target.width() == 0 || target.height() == 0) return;
+  const std::vector<Vertex> &vertices = model.getVertices();
+  const std::span<const Edge> edges(model.getEdges());
+  std::vector<ScreenLine> lines;
+  for (const EdgeClusters::Range &r : model.visibleEdgeRanges())
+    appendLines(vertices, edges.subspan(r.first, r.count), target.width(),
+                target.height(), lines);
+  drawLines(lines, options, target);
+}
+
+void SoftwareRasterizer::render(const Scene &scene,
+                                const RasterOptions &options,
+                                Framebuffer &target) {
+  target.clear(options.background);
+  if (target.width() == 0 || target.height() == 0) return;
+  const float pixelsPerUnit = std::max(target.width(), target.height()) * 0.5f;
+  std::vector<ScreenLine> lines;
+  std::vector<EdgeClusters::Range> ranges;
+  CullStats stats;
+  std::vector<Vertex> transformed;
+  AffineTransformer transformer;
+  for (const Scene::Batch &batch : scene.batches()) {
+    for (size_t index : batch.instances) {
+      if (!scene.inView(index)) continue;
+      const size_t level = scene.cull(index, pixelsPerUnit, ranges, stats);
+      const std::vector<Vertex> &vertices = batch.geometry->vertices(level);
+      const std::vector<Edge> &edges = batch.geometry->edges(level);
+      const std::vector<unsigned> &order =
+          batch.geometry->clusters(level).order();
+      composeTransform(scene.instance(index).transform, batch.geometry->center,
+                       transformer);
+      transformed = vertices;
+      for (Vertex &v : transformed) transformer.applyToVertex(v);
+      // The file order of the edges is the more coherent one for binning;
+      // the cluster order is only worth it when it skips edges.
+      if (stats.skippedEdges() == 0) {
+        appendLines(transformed, edges, target.width(), target.height(),
+                    lines);
+        continue;
+      }
+      for (const EdgeClusters::Range &r : ranges) {
+        for (unsigned i = r.first; i < r.first + r.count; ++i) {
+          const Edge &e = edges[order[i]];
+          ScreenLine l;
+          if (project(transformed[e.a], transformed[e.b], target.width(),
+                      target.height(), l))
+            lines.push_back(l);
+        }
+      }
+    }
+  }
+  drawLines(lines, options, target);
+}
+
+}  // namespace s21
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "framebuffer.h"
+#include "geometry.h"
+
+namespace s21 {
+
+class Model;
+class Scene;
+
+struct RasterOptions {
+  // GL_LESS depth test against a buffer cleared to the far plane.
+  bool depthTest = false;
+  // Same colors as WireframeWidget.
+  Color background{26, 26, 31};
+  Color line{230, 230, 230};
+  // Threads for the tile loop: 0 uses every core, 1 renders serially.
+  unsigned threads = 0;
+  int tileSize = 64;
+};
+
+// CPU counterpart of WireframeRenderer for machines without a GPU or
+// display. Vertices are projected with the volume paintGL uses,
+// glOrtho(-1, 1, -1, 1, -10, 10), clipped to it, and drawn as one pixel wide
+// lines sampled at pixel centers along the major axis, which matches GL
+// line rasterization up to ties on pixel borders.
+//
+// The image is split into square tiles: edges are binned by the tiles their
+// screen bounding box touches and the tiles are rasterized in parallel on
+// the shared ThreadPool. Each tile owns its pixels, so the result does not
+// depend on the thread count.
+class SoftwareRasterizer {
+ public:
+  // Draws the edges of already transformed vertices into target, which is
+  // cleared first.
+  static void render(const std::vector<Vertex> &vertices,
+                     const std::vector<Edge> &edges,
+                     const RasterOptions &options, Framebuffer &target);
+  // Draws the model with its current transform, at the level of detail
+  // Model::selectLod() picks for the target size. Hidden groups are
+  // skipped.
+  static void render(Model &model, const RasterOptions &options,
+                     Framebuffer &target);
+  // Draws every visible instance of the scene at its own level of detail,
+  // culled and thinned like WireframeRenderer culls a model.
+  static void render(const Scene &scene, const RasterOptions &options,
+                     Framebuffer &target);
+};
+
+}  // namespace s21
@@ -0,0 +1,351 @@
+#include "spatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+
+#include "morton.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr float kInf = std::numeric_limits<float>::infinity();
+
+Vertex sub(const Vertex &a, const Vertex &b) {
+  return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+Vertex add(const Vertex &a, const Vertex &b) {
+  return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+Vertex mul(const Vertex &a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+float dot(const Vertex &a, const Vertex &b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+Vertex cross(const Vertex &a, const Vertex &b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+          a.x * b.y - a.y * b.x};
+}
+float component(const Vertex &v, int axis) {
+  return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+Bounds emptyBounds() {
+  return Bounds{{kInf, kInf, kInf}, {-kInf, -kInf, -kInf}};
+}
+void expand(Bounds &b, const Vertex &v) {
+  b.min = {std::min(b.min.x, v.x), std::min(b.min.y, v.y),
+           std::min(b.min.z, v.z)};
+  b.max = {std::max(b.max.x, v.x), std::max(b.max.y, v.y),
+           std::max(b.max.z, v.z)};
+}
+
+// Whether the segment passes within `margin` of the box (tested against
+// the box grown by margin) at some t in [0, tMax].
+bool segmentHitsBox(const Ray &ray, const Bounds &box, float margin,
+                    float tMax) {
+  float t0 = 0.f, t1 = tMax;
+  for (int axis = 0; axis < 3; ++axis) {
+    const float o = component(ray.origin, axis);
+    const float d = component(ray.direction, axis);
+    const float lo = component(box.min, axis) - margin;
+    const float hi = component(box.max, axis) + margin;
+    if (d == 0.f) {
+      if (o < lo || o > hi) return false;
+      continue;
+    }
+    const float inv = 1.f / d;
+    float a = (lo - o) * inv, b = (hi - o) * inv;
+    if (a > b) std::swap(a, b);
+    t0 = std::max(t0, a);
+    t1 = std::min(t1, b);
+    if (t0 > t1) return false;
+  }
+  return true;
+}
+
+float squaredDistanceToBox(const Vertex &p, const Bounds &box) {
+  const float dx = std::max({box.min.x - p.x, 0.f, p.x - box.max.x});
+  const float dy = std::max({box.min.y - p.y, 0.f, p.y - box.max.y});
+  const float dz = std::max({box.min.z - p.z, 0.f, p.z - box.max.z});
+  return dx * dx + dy * dy + dz * dz;
+}
+
+// Closest points of segments p + s u and q + t v, s, t in [0, 1] (Ericson,
+// Real-Time Collision Detection, 5.1.9). Returns the squared distance.
+float segmentDistance(const Vertex &p, const Vertex &u, const Vertex &q,
+                      const Vertex &v, float &s, float &t) {
+  const Vertex r = sub(p, q);
+  const float a = dot(u, u), e = dot(v, v), f = dot(v, r);
+  if (a <= 1e-30f && e <= 1e-30f) {
+    s = t = 0.f;
+  } else if (a <= 1e-30f) {
+    s = 0.f;
+    t = std::clamp(f / e, 0.f, 1.f);
+  } else {
+    const float c = dot(u, r);
+    if (e <= 1e-30f) {
+      t = 0.f;
+      s = std::clamp(-c / a, 0.f, 1.f);
+    } else {
+      const float b = dot(u, v);
+      const float denom = a * e - b * b;
+      s = denom > 0.f ? std::clamp((b * f - c * e) / denom, 0.f, 1.f) : 0.f;
+      t = (b * s + f) / e;
+      if (t < 0.f) {
+        t = 0.f;
+        s = std::clamp(-c / a, 0.f, 1.f);
+      } else if (t > 1.f) {
+        t = 1.f;
+        s = std::clamp((b - c) / a, 0.f, 1.f);
+      }
+    }
+  }
+  const Vertex d = sub(add(p, mul(u, s)), add(q, mul(v, t)));
+  return dot(d, d);
+}
+
+// Nodes of a Bvh over n primitives. Halving only produces sizes k and
+// k + 1 on each level, so the memo stays O(log n).
+size_t nodeCount(size_t n, std::map<size_t, size_t> &memo) {
+  if (n <= Bvh::kLeafSize) return 1;
+  auto it = memo.find(n);
+  if (it != memo.end()) return it->second;
+  const size_t nodes =
+      1 + nodeCount(n / 2, memo) + nodeCount(n - n / 2, memo);
+  memo.emplace(n, nodes);
+  return nodes;
+}
+
+// Visits the leaves whose boxes pass `accept`, in depth-first order.
+template <typename Accept, typename Leaf>
+void traverse(const Bvh &tree, Accept &&accept, Leaf &&leaf) {
+  if (tree.empty()) return;
+  const auto &nodes = tree.nodes();
+  unsigned stack[64];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const unsigned index = stack[--top];
+    const Bvh::Node &node = nodes[index];
+    if (!accept(node.box)) continue;
+    if (node.count > 0) {
+      leaf(node);
+    } else {
+      stack[top++] = node.first;
+      stack[top++] = index + 1;
+    }
+  }
+}
+
+}  // namespace
+
+Bvh::Bvh(const std::vector<Vertex> &points) {
+  Bounds range = emptyBounds();
+  for (const Vertex &p : points) expand(range, p);
+  build(
+      points.size(), range, [&points](unsigned i) { return points[i]; },
+      [&points](unsigned i, Bounds &box) { expand(box, points[i]); });
+}
+
+Bvh::Bvh(const std::vector<Vertex> &vertices, const PolygonList &polygons) {
+  Bounds range = emptyBounds();
+  for (const Vertex &v : vertices) expand(range, v);
+  build(
+      polygons.size(), range,
+      [&](unsigned i) {
+        const Polygon face = polygons[i];
+        Vertex sum{0.f, 0.f, 0.f};
+        for (unsigned v : face) sum = add(sum, vertices[v]);
+        return face.empty() ? range.min : mul(sum, 1.f / face.size());
+      },
+      [&](unsigned i, Bounds &box) {
+        for (unsigned v : polygons[i]) expand(box, vertices[v]);
+      });
+}
+
+template <typename Centroid, typename Grow>
+void Bvh::build(size_t count, const Bounds &range, Centroid &&centroid,
+                Grow &&grow) {
+  nodes_.clear();
+  primitives_.clear();
+  if (count == 0) return;
+
+  std::vector<uint32_t> codes(count);
+  for (size_t i = 0; i < count; ++i)
+    codes[i] = mortonCode(centroid(static_cast<unsigned>(i)), range);
+  primitives_ = sortByCode(codes);
+
+  std::map<size_t, size_t> memo;
+  nodes_.reserve(nodeCount(count, memo));
+  build(0, static_cast<unsigned>(count), grow);
+}
+
+template <typename Grow>
+unsigned Bvh::build(unsigned begin, unsigned end, Grow &grow) {
+  const unsigned index = static_cast<unsigned>(nodes_.size());
+  nodes_.emplace_back();
+  if (end - begin <= kLeafSize) {
+    Bounds box = emptyBounds();
+    for (unsigned i = begin; i < end; ++i) grow(primitives_[i], box);
+    nodes_[index] = Node{box, begin, end - begin};
+    return index;
+  }
+
+  // Halving the Morton order splits space roughly at its median.
+  const unsigned mid = begin + (end - begin) / 2;
+  const unsigned left = build(begin, mid, grow);
+  const unsigned right = build(mid, end, grow);
+  Bounds box = nodes_[left].box;
+  expand(box, nodes_[right].box.min);
+  expand(box, nodes_[right].box.max);
+  nodes_[index] = Node{box, right, 0};
+  return index;
+}
+
+size_t Bvh::memoryBytes() const {
+  return nodes_.capacity() * sizeof(Node) +
+         primitives_.capacity() * sizeof(unsigned);
+}
+
+SpatialIndex::SpatialIndex(const std::vector<Vertex> &vertices,
+                           const PolygonList &polygons)
+    : vertexTree_(vertices), faceTree_(vertices, polygons) {}
+
+PickResult SpatialIndex::pickVertex(const std::vector<Vertex> &vertices,
+                                    const Ray &ray, float maxDistance,
+                                    const PickFilter &visible) const {
+  PickResult best;
+  best.distance = maxDistance;
+  const float lengthSq = dot(ray.direction, ray.direction);
+  if (lengthSq == 0.f) return best;
+  const auto &prims = vertexTree_.primitives();
+  traverse(
+      vertexTree_,
+      [&](const Bounds &box) {
+        return segmentHitsBox(ray, box, best.distance, 1.f);
+      },
+      [&](const Bvh::Node &leaf) {
+        for (unsigned i = leaf.first; i < leaf.first + leaf.count; ++i) {
+          if (visible && !visible(prims[i])) continue;
+          const Vertex &p = vertices[prims[i]];
+          const float t = std::clamp(
+              dot(sub(p, ray.origin), ray.direction) / lengthSq, 0.f, 1.f);
+          const Vertex d = sub(add(ray.origin, mul(ray.direction, t)), p);
+          const float distance = std::sqrt(dot(d, d));
+          if (distance < best.distance ||
+              (distance == best.distance && best.found && t < best.t)) {
+            best = PickResult{true, prims[i], distance, t};
+          }
+        }
+      });
+  return best;
+}
+
+PickResult SpatialIndex::pickEdge(const std::vector<Vertex> &vertices,
+                                  const PolygonList &polygons, const Ray &ray,
+                                  float maxDistance, Edge &edge,
+                                  const PickFilter &visible) const {
+  PickResult best;
+  best.distance = maxDistance;
+  const auto &prims = faceTree_.primitives();
+  traverse(
+      faceTree_,
+      [&](const Bounds &box) {
+        return segmentHitsBox(ray, box, best.distance, 1.f);
+      },
+      [&](const Bvh::Node &leaf) {
+        for (unsigned i = leaf.first; i < leaf.first + leaf.count; ++i) {
+          if (visible && !visible(prims[i])) continue;
+          const Polygon face = polygons[prims[i]];
+          for (size_t k = 0; k < face.size(); ++k) {
+            const unsigned a = face[k];
+            const unsigned b = face[(k + 1) % face.size()];
+            if (a == b) continue;
+            float s = 0.f, t = 0.f;
+            const float distance = std::sqrt(segmentDistance(
+                ray.origin, ray.direction, vertices[a],
+                sub(vertices[b], vertices[a]), s, t));
+            if (distance < best.distance ||
+                (distance == best.distance && best.found && s < best.t)) {
+              best = PickResult{true, prims[i], distance, s};
+              edge = Edge{std::min(a, b), std::max(a, b)};
+            }
+          }
+        }
+      });
+  return best;
+}
+
+PickResult SpatialIndex::raycast(const std::vector<Vertex> &vertices,
+                                 const PolygonList &polygons, const Ray &ray,
+                                 const PickFilter &visible) const {
+  PickResult best;
+  best.t = 1.f;
+  const auto &prims = faceTree_.primitives();
+  traverse(
+      faceTree_,
+      [&](const Bounds &box) { return segmentHitsBox(ray, box, 0.f, best.t); },
+      [&](const Bvh::Node &leaf) {
+        for (unsigned i = leaf.first; i < leaf.first + leaf.count; ++i) {
+          if (visible && !visible(prims[i])) continue;
+          const Polygon face = polygons[prims[i]];
+          const Vertex &p0 = vertices[face[0]];
+          // Moller-Trumbore on the fan triangles (p0, pk, pk+1).
+          for (size_t k = 1; k + 1 < face.size(); ++k) {
+            const Vertex e1 = sub(vertices[face[k]], p0);
+            const Vertex e2 = sub(vertices[face[k + 1]], p0);
+            const Vertex h = cross(ray.direction, e2);
+            const float det = dot(e1, h);
+            if (std::abs(det) < 1e-20f) continue;
+            const float inv = 1.f / det;
+            const Vertex s = sub(ray.origin, p0);
+            const float u = dot(s, h) * inv;
+            if (u < 0.f || u > 1.f) continue;
+            const Vertex q = cross(s, e1);
+            const float v = dot(ray.direction, q) * inv;
+            if (v < 0.f || u + v > 1.f) continue;
+            const float t = dot(e2, q) * inv;
+            if (t >= 0.f && (t < best.t || (!best.found && t <= best.t))) {
+              best = PickResult{true, prims[i], 0.f, t};
+            }
+          }
+        }
+      });
+  return best;
+}
+
+PickResult SpatialIndex::nearestVertex(const std::vector<Vertex> &vertices,
+                                       const Vertex &point,
+                                       float maxDistance,
+                                       const PickFilter &visible) const {
+  PickResult best;
+  float bestSq = maxDistance == kInf ? kInf : maxDistance * maxDistance;
+  const auto &prims = vertexTree_.primitives();
+  traverse(
+      vertexTree_,
+      [&](const Bounds &box) {
+        return squaredDistanceToBox(point, box) <= bestSq;
+      },
+      [&](const Bvh::Node &leaf) {
+        for (unsigned i = leaf.first; i < leaf.first + leaf.count; ++i) {
+          if (visible && !visible(prims[i])) continue;
+          const Vertex d = sub(vertices[prims[i]], point);
+          const float distanceSq = dot(d, d);
+          if (distanceSq < bestSq || (!best.found && distanceSq <= bestSq)) {
+            bestSq = distanceSq;
+            best.found = true;
+            best.index = prims[i];
+          }
+        }
+      });
+  if (best.found) best.distance = std::sqrt(bestSq);
+  return best;
+}
+
+size_t SpatialIndex::memoryBytes() const {
+  return vertexTree_.memoryBytes() + faceTree_.memoryBytes();
+}
+
+}  // namespace s21
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "geometry.h"
+
+namespace s21 {
+
+// Segment origin + t * direction for t in [0, 1]; picking rays span the
+// view volume from the near to the far plane.
+struct Ray {
+  Vertex origin;
+  Vertex direction;
+};
+
+struct PickResult {
+  bool found = false;
+  // Vertex, face or edge index, depending on the query.
+  size_t index = 0;
+  // Distance to the query point or ray, in model units.
+  float distance = std::numeric_limits<float>::infinity();
+  // Ray parameter of the closest approach (0 = near plane).
+  float t = 0.f;
+};
+
+// Whether a vertex or face index takes part in a query, e.g. whether it
+// belongs to a shown group. An empty filter accepts everything.
+using PickFilter = std::function<bool(unsigned)>;
+
+// Bounding volume hierarchy over points or polygons. Primitives are radix
+// sorted by the Morton code of their centroid and the sorted range is
+// halved recursively, so a build is O(n) apart from the sort. Nodes are
+// stored depth first: an inner node's left child follows it directly and
+// `first` points at its right child.
+class Bvh {
+ public:
+  struct Node {
+    Bounds box;
+    unsigned first = 0;
+    unsigned count = 0;  // primitives in a leaf, 0 for inner nodes
+  };
+
+  static constexpr unsigned kLeafSize = 8;
+
+  Bvh() = default;
+  explicit Bvh(const std::vector<Vertex> &points);
+  // One primitive per polygon, bounded by its vertices.
+  Bvh(const std::vector<Vertex> &vertices, const PolygonList &polygons);
+
+  bool empty() const { return nodes_.empty(); }
+  const std::vector<Node> &nodes() const { return nodes_; }
+  // Primitive indices of the leaves.
+  const std::vector<unsigned> &primitives() const { return primitives_; }
+  size_t memoryBytes() const;
+
+ private:
+  // centroid(i) is a point of primitive i inside range; grow(i, box)
+  // extends box by primitive i.
+  template <typename Centroid, typename Grow>
+  void build(size_t count, const Bounds &range, Centroid &&centroid,
+             Grow &&grow);
+  template <typename Grow>
+  unsigned build(unsigned begin, unsigned end, Grow &grow);
+
+  std::vector<Node> nodes_;
+  std::vector<unsigned> primitives_;
+};
+
+// Picking structure over a mesh in its untransformed (model) space. Callers
+// map screen rays into model space with the inverse model matrix, so the
+// index stays valid under every transform and is only rebuilt when the
+// geometry changes.
+class SpatialIndex {
+ public:
+  SpatialIndex(const std::vector<Vertex> &vertices,
+               const PolygonList &polygons);
+
+  // The queries skip the vertices or faces `visible` rejects while they
+  // traverse, so a filtered-out primitive never hides one behind it.
+
+  // Vertex closest to the ray within maxDistance of it.
+  PickResult pickVertex(const std::vector<Vertex> &vertices, const Ray &ray,
+                        float maxDistance,
+                        const PickFilter &visible = {}) const;
+  // Face edge closest to the ray within maxDistance; index is the face and
+  // edge its endpoints.
+  PickResult pickEdge(const std::vector<Vertex> &vertices,
+                      const PolygonList &polygons, const Ray &ray,
+                      float maxDistance, Edge &edge,
+                      const PickFilter &visible = {}) const;
+  // First face the ray hits (faces are fan-triangulated).
+  PickResult raycast(const std::vector<Vertex> &vertices,
+                     const PolygonList &polygons, const Ray &ray,
+                     const PickFilter &visible = {}) const;
+  // Vertex nearest to point within maxDistance.
+  PickResult nearestVertex(
+      const std::vector<Vertex> &vertices, const Vertex &point,
+      float maxDistance = std::numeric_limits<float>::infinity(),
+      const PickFilter &visible = {}) const;
+
+  size_t memoryBytes() const;
+
+ private:
+  Bvh vertexTree_;
+  Bvh faceTree_;
+};
+
+}  // namespace s21
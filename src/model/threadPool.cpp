@@ -0,0 +1,117 @@
+#include "threadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace s21 {
+
+struct ThreadPool::Loop {
+  size_t count = 0;
+  const std::function<void(size_t)> *body = nullptr;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> done{0};
+  std::mutex mutex;
+  std::condition_variable finished;
+  std::exception_ptr error;
+};
+
+ThreadPool::ThreadPool(unsigned workers) {
+  workers_.reserve(workers);
+  for (unsigned i = 0; i < workers; ++i)
+    workers_.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto &w : workers_) w.join();
+}
+
+ThreadPool &ThreadPool::shared() {
+  static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) -
+                         1);
+  return pool;
+}
+
+unsigned ThreadPool::concurrency() const {
+  return static_cast<unsigned>(workers_.size()) + 1;
+}
+
+void ThreadPool::parallelFor(size_t count, unsigned maxThreads,
+                             const std::function<void(size_t)> &body) {
+  if (count == 0) return;
+  if (maxThreads == 0 || maxThreads > concurrency()) maxThreads = concurrency();
+  size_t helpers = std::min<size_t>(maxThreads - 1, count - 1);
+
+  if (helpers == 0) {
+    for (size_t i = 0; i < count; ++i) body(i);
+    return;
+  }
+
+  auto loop = std::make_shared<Loop>();
+  loop->count = count;
+  loop->body = &body;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < helpers; ++i) queue_.push_back(loop);
+  }
+  if (helpers == 1)
+    wake_.notify_one();
+  else
+    wake_.notify_all();
+
+  run(*loop);
+
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->finished.wait(lock, [&] { return loop->done.load() == count; });
+  if (loop->error) std::rethrow_exception(loop->error);
+}
+
+size_t ThreadPool::blockCount(size_t count) {
+  return (count + kBlockSize - 1) / kBlockSize;
+}
+
+void ThreadPool::parallelBlocks(
+    size_t count, unsigned maxThreads,
+    const std::function<void(size_t, size_t, size_t)> &body) {
+  if (count < kParallelThreshold) maxThreads = 1;
+  parallelFor(blockCount(count), maxThreads, [&](size_t block) {
+    const size_t begin = block * kBlockSize;
+    body(block, begin, std::min(count, begin + kBlockSize));
+  });
+}
+
+void ThreadPool::workerLoop() {
+  for (;;) {
+    std::shared_ptr<Loop> loop;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (stop_ && queue_.empty()) return;
+      loop = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    run(*loop);
+  }
+}
+
+void ThreadPool::run(Loop &loop) {
+  for (size_t i = loop.next++; i < loop.count; i = loop.next++) {
+    try {
+      (*loop.body)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(loop.mutex);
+      if (!loop.error) loop.error = std::current_exception();
+    }
+    if (++loop.done == loop.count) {
+      std::lock_guard<std::mutex> lock(loop.mutex);
+      loop.finished.notify_all();
+    }
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+// Fixed set of worker threads running index-parallel loops. The calling
+// thread always takes part in its own loop, so parallelFor may be nested
+// (or called from a worker) without risk of deadlock.
+class ThreadPool {
+ public:
+  explicit ThreadPool(unsigned workers);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Process-wide pool with one thread per hardware core (caller included).
+  static ThreadPool &shared();
+
+  // Number of threads that can work on one loop, the caller included.
+  unsigned concurrency() const;
+
+  // Runs body(i) for every i in [0, count) on at most maxThreads threads
+  // (0 means all of them) and returns when all calls have finished. The
+  // first exception thrown by body is rethrown here.
+  void parallelFor(size_t count, unsigned maxThreads,
+                   const std::function<void(size_t)> &body);
+
+  // Data-parallel passes over [0, count): the range is cut into blocks of
+  // kBlockSize indices (the last one shorter) and body(block, begin, end)
+  // runs once per block. Blocks depend only on count, so partial results
+  // kept per block and combined in block order are the same on any number
+  // of threads. Passes shorter than kParallelThreshold stay on the calling
+  // thread.
+  static constexpr size_t kBlockSize = size_t{1} << 15;
+  static constexpr size_t kParallelThreshold = size_t{1} << 17;
+  static size_t blockCount(size_t count);
+  void parallelBlocks(
+      size_t count, unsigned maxThreads,
+      const std::function<void(size_t, size_t, size_t)> &body);
+
+ private:
+  struct Loop;
+
+  void workerLoop();
+  static void run(Loop &loop);
+
+  std::vector<std::thread> workers_;
+  std::deque<std::shared_ptr<Loop>> queue_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+};
+
+}  // namespace s21
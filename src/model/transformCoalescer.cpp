@@ -0,0 +1,41 @@
+#include "transformCoalescer.h"
+
+#include "profiler.h"
+
+namespace s21 {
+
+bool TransformCoalescer::post(const std::function<void(Transform &)> &edit) {
+  const bool first = !pending_;
+  if (first) {
+    state_ = model_.transform();
+    pending_ = true;
+    pendingInputNs_ = Profiler::instance().now();
+  }
+  edit(state_);
+  ++commands_;
+  return first;
+}
+
+bool TransformCoalescer::apply() {
+  if (!pending_) return false;
+  model_.setTranslation(state_.tx, state_.ty, state_.tz);
+  model_.setRotation(state_.rx, state_.ry, state_.rz);
+  model_.setScale(state_.s);
+  pending_ = false;
+  // Frames applied before a present count from the earliest input.
+  if (!awaitingPresent_) appliedInputNs_ = pendingInputNs_;
+  awaitingPresent_ = true;
+  ++appliedFrames_;
+  return true;
+}
+
+void TransformCoalescer::presented() {
+  if (!awaitingPresent_) return;
+  Profiler &profiler = Profiler::instance();
+  profiler.record(Stage::kInput, appliedInputNs_, profiler.now());
+  awaitingPresent_ = false;
+}
+
+void TransformCoalescer::discard() { pending_ = false; }
+
+}  // namespace s21
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "model.h"
+
+namespace s21 {
+
+// Collects transform commands between frames and applies only the latest
+// state, once per frame. A slider drag delivers many valueChanged signals
+// per displayed frame; each one now costs a copy of a Transform instead of
+// a Model update, and the model sees one change per frame.
+//
+// The time from the first command of a frame to presented() is recorded
+// as Stage::kInput in the Profiler: the input-to-present latency of that
+// interaction.
+class TransformCoalescer {
+ public:
+  explicit TransformCoalescer(Model &model) : model_(model) {}
+
+  // Edits the pending state (the model's current transform if nothing is
+  // pending). Returns true for the first command since the last apply(),
+  // when the caller should request a frame.
+  bool post(const std::function<void(Transform &)> &edit);
+  bool pending() const { return pending_; }
+  // Applies the pending state to the model, if any; returns whether it
+  // did. Call when a frame starts.
+  bool apply();
+  // Call once the frame that apply() prepared is on screen.
+  void presented();
+  // Drops pending commands, for example when the model is replaced.
+  void discard();
+
+  // Commands posted and frames that applied them, since construction.
+  uint64_t commands() const { return commands_; }
+  uint64_t appliedFrames() const { return appliedFrames_; }
+
+ private:
+  Model &model_;
+  Transform state_;
+  bool pending_ = false;
+  // Profiler::now() of the first pending command, and of the first command
+  // of the frame waiting for presented().
+  uint64_t pendingInputNs_ = 0;
+  uint64_t appliedInputNs_ = 0;
+  bool awaitingPresent_ = false;
+  uint64_t commands_ = 0;
+  uint64_t appliedFrames_ = 0;
+};
+
+}  // namespace s21
@@ -0,0 +1,205 @@
+#include "transformKernel.h"
+
+#include "threadPool.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define S21_X86 1
+#endif
+
+namespace s21 {
+
+namespace {
+
+template <typename T>
+void transformScalar(const AffineTransformer::Matrix &m, const T *x,
+                     const T *y, const T *z, float *ox, float *oy, float *oz,
+                     size_t begin, size_t n) {
+  for (size_t i = begin; i < n; ++i) {
+    const auto vx = static_cast<float>(x[i]);
+    const auto vy = static_cast<float>(y[i]);
+    const auto vz = static_cast<float>(z[i]);
+    ox[i] = m[0][0] * vx + m[0][1] * vy + m[0][2] * vz + m[0][3];
+    oy[i] = m[1][0] * vx + m[1][1] * vy + m[1][2] * vz + m[1][3];
+    oz[i] = m[2][0] * vx + m[2][1] * vy + m[2][2] * vz + m[2][3];
+  }
+}
+
+#ifdef S21_X86
+
+__m128 load4(const float *p) { return _mm_loadu_ps(p); }
+
+// Zero-extends four 16-bit values to 32 bits; int32 to float is exact.
+__m128 load4(const uint16_t *p) {
+  const __m128i q = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+  return _mm_cvtepi32_ps(_mm_unpacklo_epi16(q, _mm_setzero_si128()));
+}
+
+template <typename T>
+void transformSse(const AffineTransformer::Matrix &m, const T *x, const T *y,
+                  const T *z, float *ox, float *oy, float *oz, size_t n) {
+  __m128 c[3][4];
+  for (int r = 0; r < 3; ++r)
+    for (int k = 0; k < 4; ++k) c[r][k] = _mm_set1_ps(m[r][k]);
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128 vx = load4(x + i);
+    const __m128 vy = load4(y + i);
+    const __m128 vz = load4(z + i);
+    float *dst[3] = {ox, oy, oz};
+    for (int r = 0; r < 3; ++r) {
+      __m128 acc = _mm_mul_ps(c[r][0], vx);
+      acc = _mm_add_ps(acc, _mm_mul_ps(c[r][1], vy));
+      acc = _mm_add_ps(acc, _mm_mul_ps(c[r][2], vz));
+      acc = _mm_add_ps(acc, c[r][3]);
+      _mm_storeu_ps(dst[r] + i, acc);
+    }
+  }
+  transformScalar(m, x, y, z, ox, oy, oz, i, n);
+}
+
+__attribute__((target("avx2,fma"))) __m256 load8(const float *p) {
+  return _mm256_loadu_ps(p);
+}
+
+__attribute__((target("avx2,fma"))) __m256 load8(const uint16_t *p) {
+  const __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(q));
+}
+
+template <typename T>
+__attribute__((target("avx2,fma"))) void transformAvx2(
+    const AffineTransformer::Matrix &m, const T *x, const T *y, const T *z,
+    float *ox, float *oy, float *oz, size_t n) {
+  __m256 c[3][4];
+  for (int r = 0; r < 3; ++r)
+    for (int k = 0; k < 4; ++k) c[r][k] = _mm256_set1_ps(m[r][k]);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 vx = load8(x + i);
+    const __m256 vy = load8(y + i);
+    const __m256 vz = load8(z + i);
+    float *dst[3] = {ox, oy, oz};
+    for (int r = 0; r < 3; ++r) {
+      __m256 acc = _mm256_fmadd_ps(c[r][0], vx, c[r][3]);
+      acc = _mm256_fmadd_ps(c[r][1], vy, acc);
+      acc = _mm256_fmadd_ps(c[r][2], vz, acc);
+      _mm256_storeu_ps(dst[r] + i, acc);
+    }
+  }
+  transformScalar(m, x, y, z, ox, oy, oz, i, n);
+}
+
+#endif
+
+template <typename T>
+void dispatch(const AffineTransformer::Matrix &m, const T *x, const T *y,
+              const T *z, float *ox, float *oy, float *oz, size_t n,
+              TransformKernel::Isa isa) {
+  using Isa = TransformKernel::Isa;
+  if (!TransformKernel::isSupported(isa)) isa = Isa::kScalar;
+  switch (isa) {
+#ifdef S21_X86
+    case Isa::kAvx2:
+      transformAvx2(m, x, y, z, ox, oy, oz, n);
+      return;
+    case Isa::kSse:
+      transformSse(m, x, y, z, ox, oy, oz, n);
+      return;
+#endif
+    default:
+      transformScalar(m, x, y, z, ox, oy, oz, 0, n);
+  }
+}
+
+}  // namespace
+
+void VertexArrays::assign(const std::vector<Vertex> &vertices) {
+  resize(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    x[i] = vertices[i].x;
+    y[i] = vertices[i].y;
+    z[i] = vertices[i].z;
+  }
+}
+
+void VertexArrays::append(const std::vector<Vertex> &vertices) {
+  const size_t base = size();
+  resize(base + vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    x[base + i] = vertices[i].x;
+    y[base + i] = vertices[i].y;
+    z[base + i] = vertices[i].z;
+  }
+}
+
+void VertexArrays::storeTo(std::vector<Vertex> &vertices) const {
+  vertices.resize(size());
+  for (size_t i = 0; i < size(); ++i) vertices[i] = {x[i], y[i], z[i]};
+}
+
+bool TransformKernel::isSupported(Isa isa) {
+  switch (isa) {
+    case Isa::kScalar:
+      return true;
+#ifdef S21_X86
+    case Isa::kSse:
+      return true;
+    case Isa::kAvx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    default:
+      return false;
+  }
+}
+
+TransformKernel::Isa TransformKernel::bestIsa() {
+  static const Isa best = isSupported(Isa::kAvx2)  ? Isa::kAvx2
+                          : isSupported(Isa::kSse) ? Isa::kSse
+                                                   : Isa::kScalar;
+  return best;
+}
+
+void TransformKernel::transform(const AffineTransformer::Matrix &m,
+                                const VertexArrays &in, VertexArrays &out) {
+  transform(m, in, out, bestIsa());
+}
+
+void TransformKernel::transform(const AffineTransformer::Matrix &m,
+                                const VertexArrays &in, VertexArrays &out,
+                                Isa isa) {
+  out.resize(in.size());
+  transform(m, in.x.data(), in.y.data(), in.z.data(), out.x.data(),
+            out.y.data(), out.z.data(), in.size(), isa);
+}
+
+void TransformKernel::transform(const AffineTransformer::Matrix &m,
+                                const VertexArrays &in, VertexArrays &out,
+                                Isa isa, unsigned threads) {
+  out.resize(in.size());
+  ThreadPool::shared().parallelBlocks(
+      in.size(), threads, [&](size_t, size_t begin, size_t end) {
+        transform(m, in.x.data() + begin, in.y.data() + begin,
+                  in.z.data() + begin, out.x.data() + begin,
+                  out.y.data() + begin, out.z.data() + begin, end - begin,
+                  isa);
+      });
+}
+
+void TransformKernel::transform(const AffineTransformer::Matrix &m,
+                                const float *x, const float *y, const float *z,
+                                float *ox, float *oy, float *oz, size_t n,
+                                Isa isa) {
+  dispatch(m, x, y, z, ox, oy, oz, n, isa);
+}
+
+void TransformKernel::transform(const AffineTransformer::Matrix &m,
+                                const uint16_t *x, const uint16_t *y,
+                                const uint16_t *z, float *ox, float *oy,
+                                float *oz, size_t n, Isa isa) {
+  dispatch(m, x, y, z, ox, oy, oz, n, isa);
+}
+
+}  // namespace s21
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "affineTransformer.h"
+#include "geometry.h"
+
+namespace s21 {
+
+// Vertex positions as three separate coordinate arrays (structure of
+// arrays), the layout the vectorized transform kernel works on.
+struct VertexArrays {
+  std::vector<float> x, y, z;
+
+  size_t size() const { return x.size(); }
+  void resize(size_t n) {
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+  }
+  void clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+  }
+  void assign(const std::vector<Vertex> &vertices);
+  void append(const std::vector<Vertex> &vertices);
+  void storeTo(std::vector<Vertex> &vertices) const;
+};
+
+// Batch affine transform: out = M * (x, y, z, 1) for every vertex, using
+// only the upper 3x4 part of M. The widest instruction set supported by the
+// CPU is picked at runtime.
+//
+// The SSE path performs exactly the operations of the scalar path and
+// matches it bit for bit. The AVX2 path uses fused multiply-add, so its
+// results may differ from the scalar ones by a few ulps:
+//   |simd - scalar| <= kTransformEpsilon * max(1, |scalar|).
+class TransformKernel {
+ public:
+  enum class Isa { kScalar, kSse, kAvx2 };
+
+  static constexpr float kTransformEpsilon = 1e-5f;
+
+  static Isa bestIsa();
+  static bool isSupported(Isa isa);
+
+  static void transform(const AffineTransformer::Matrix &m,
+                        const VertexArrays &in, VertexArrays &out);
+  static void transform(const AffineTransformer::Matrix &m,
+                        const VertexArrays &in, VertexArrays &out, Isa isa);
+  // Split into ThreadPool::parallelBlocks() on up to `threads` threads (0
+  // uses every core); every vertex is computed as on one thread.
+  static void transform(const AffineTransformer::Matrix &m,
+                        const VertexArrays &in, VertexArrays &out, Isa isa,
+                        unsigned threads);
+
+  // Raw form on [0, n) of the given arrays; out may not alias in.
+  static void transform(const AffineTransformer::Matrix &m, const float *x,
+                        const float *y, const float *z, float *ox, float *oy,
+                        float *oz, size_t n, Isa isa);
+  // Same on 16-bit integer coordinates, which convert to float exactly;
+  // pair with a matrix that includes their dequantization
+  // (QuantizedVertices::decodeMatrix()) to decode and transform in one
+  // pass.
+  static void transform(const AffineTransformer::Matrix &m,
+                        const uint16_t *x, const uint16_t *y,
+                        const uint16_t *z, float *ox, float *oy, float *oz,
+                        size_t n, Isa isa);
+};
+
+}  // namespace s21
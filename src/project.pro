@@ -7,15 +7,64 @@ SOURCES += \
     View/mainwindow.cpp \
     model/model.cpp \
     model/affineTransformer.cpp \
+    model/edgeBuilder.cpp \
+    model/edgeClusters.cpp \
+    model/framebuffer.cpp \
+    model/hash.cpp \
+    model/localityReorder.cpp \
+    model/lodBuilder.cpp \
+    model/mappedFile.cpp \
+    model/mesh.cpp \
+    model/meshCache.cpp \
+    model/meshLoader.cpp \
+    model/modelCache.cpp \
+    model/morton.cpp \
+    model/objParser.cpp \
+    model/objWriter.cpp \
+    model/profiler.cpp \
+    model/quantize.cpp \
+    model/scene.cpp \
+    model/softwareRasterizer.cpp \
+    model/spatialIndex.cpp \
+    model/threadPool.cpp \
+    model/transformCoalescer.cpp \
+    model/transformKernel.cpp \
     Controller/controller.cpp \
-    View/wireframewidget.cpp
+    View/wireframewidget.cpp \
+    View/wireframeRenderer.cpp
 
 HEADERS += \
     View/mainwindow.h \
     model/model.h \
     model/affineTransformer.h \
+    model/backgroundJobs.h \
+    model/cullStats.h \
+    model/edgeBuilder.h \
+    model/edgeClusters.h \
+    model/framebuffer.h \
+    model/geometry.h \
+    model/hash.h \
+    model/localityReorder.h \
+    model/lodBuilder.h \
+    model/mappedFile.h \
+    model/mesh.h \
+    model/meshCache.h \
+    model/meshLoader.h \
+    model/modelCache.h \
+    model/morton.h \
+    model/objParser.h \
+    model/objWriter.h \
+    model/profiler.h \
+    model/quantize.h \
+    model/scene.h \
+    model/softwareRasterizer.h \
+    model/spatialIndex.h \
+    model/threadPool.h \
+    model/transformCoalescer.h \
+    model/transformKernel.h \
     Controller/controller.h \
-    View/wireframewidget.h
+    View/wireframewidget.h \
+    View/wireframeRenderer.h
 
 FORMS += \
     View/mainwindow.ui
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QSurfaceFormat>
+
+#include "../../View/wireframeRenderer.h"
+#include "../../model/model.h"
+#include "../../model/softwareRasterizer.h"
+
+namespace {
+
+constexpr int kSize = 128;
+
+struct GlContext {
+  GlContext() {
+    QSurfaceFormat fmt;
+    fmt.setRenderableType(QSurfaceFormat::OpenGL);
+    fmt.setProfile(QSurfaceFormat::CompatibilityProfile);
+    fmt.setVersion(2, 1);
+    context.setFormat(fmt);
+    surface.setFormat(fmt);
+    surface.create();
+    ok = context.create() && context.makeCurrent(&surface);
+  }
+  ~GlContext() { context.doneCurrent(); }
+
+  QOpenGLContext context;
+  QOffscreenSurface surface;
+  bool ok = false;
+};
+
+QImage Render(s21::WireframeRenderer &renderer, s21::Model &model) {
+  QOpenGLFramebufferObject fbo(kSize, kSize,
+                               QOpenGLFramebufferObject::Depth);
+  fbo.bind();
+  QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+  gl->glViewport(0, 0, kSize, kSize);
+  gl->glEnable(GL_DEPTH_TEST);
+  gl->glClearColor(0.f, 0.f, 0.f, 1.f);
+  gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  renderer.render(model);
+  fbo.release();
+  return fbo.toImage();
+}
+
+int LitPixels(const QImage &image) {
+  int lit = 0;
+  for (int y = 0; y < image.height(); ++y)
+    for (int x = 0; x < image.width(); ++x)
+      if (qGray(image.pixel(x, y)) > 128) ++lit;
+  return lit;
+}
+
+// Share of the lit pixels of a that have a lit pixel of b within one pixel.
+double Coverage(const QImage &a, const QImage &b) {
+  int lit = 0, matched = 0;
+  for (int y = 0; y < a.height(); ++y) {
+    for (int x = 0; x < a.width(); ++x) {
+      if (qGray(a.pixel(x, y)) <= 128) continue;
+      ++lit;
+      bool found = false;
+      for (int dy = -1; dy <= 1 && !found; ++dy)
+        for (int dx = -1; dx <= 1 && !found; ++dx)
+          found = b.valid(x + dx, y + dy) &&
+                  qGray(b.pixel(x + dx, y + dy)) > 128;
+      matched += found;
+    }
+  }
+  return lit ? double(matched) / lit : 1.0;
+}
+
+QImage ToImage(const s21::Framebuffer &fb) {
+  QImage image(fb.width(), fb.height(), QImage::Format_RGB888);
+  for (int y = 0; y < fb.height(); ++y)
+    for (int x = 0; x < fb.width(); ++x) {
+      const s21::Color c = fb.pixel(x, y);
+      image.setPixel(x, y, qRgb(c.r, c.g, c.b));
+    }
+  return image;
+}
+
+}  // namespace
+
+TEST(Render, SoftwareMatchesGl) {
+  GlContext gl;
+  ASSERT_TRUE(gl.ok);
+
+  s21::Model model;
+  model.loadFromFile("../objModels/skull.obj");
+  model.setRotation(0.5f, 0.7f, 0.1f);
+  model.setScale(1.2f);
+
+  s21::WireframeRenderer renderer;
+  renderer.initialize();
+  renderer.setMode(s21::WireframeRenderer::Mode::kImmediate);
+  const QImage hardware = Render(renderer, model);
+  renderer.release();
+
+  s21::RasterOptions options;
+  options.depthTest = true;
+  options.background = {0, 0, 0};
+  s21::Framebuffer fb(kSize, kSize);
+  s21::SoftwareRasterizer::render(model, options, fb);
+  const QImage software = ToImage(fb);
+
+  EXPECT_GT(LitPixels(software), 0);
+  EXPECT_NEAR(LitPixels(software), LitPixels(hardware),
+              LitPixels(hardware) / 10);
+  EXPECT_GT(Coverage(software, hardware), 0.95);
+  EXPECT_GT(Coverage(hardware, software), 0.95);
+}
+
+TEST(Render, RetainedMatchesImmediate) {
+  GlContext gl;
+  ASSERT_TRUE(gl.ok);
+
+  s21::Model model;
+  model.loadFromFile("test_figure.obj");
+  model.setRotation(0.5f, 0.7f, 0.1f);
+  model.setScale(1.2f);
+
+  s21::WireframeRenderer renderer;
+  renderer.initialize();
+  ASSERT_TRUE(renderer.retainedSupported());
+
+  renderer.setMode(s21::WireframeRenderer::Mode::kImmediate);
+  const int immediate = LitPixels(Render(renderer, model));
+  renderer.setMode(s21::WireframeRenderer::Mode::kRetained);
+  const int retained = LitPixels(Render(renderer, model));
+
+  EXPECT_GT(immediate, 0);
+  EXPECT_NEAR(retained, immediate, immediate / 20 + 2);
+  renderer.release();
+}
+
+TEST(Render, TransformChangeNeedsNoUpload) {
+  GlContext gl;
+  ASSERT_TRUE(gl.ok);
+
+  s21::Model model;
+  model.loadFromFile("test_figure.obj");
+  s21::WireframeRenderer renderer;
+  renderer.initialize();
+  ASSERT_TRUE(renderer.retainedSupported());
+
+  const QImage before = Render(renderer, model);
+  EXPECT_EQ(renderer.uploadCount(), 1);
+  model.setTranslation(5.f, 0.f, 0.f);
+  const QImage moved = Render(renderer, model);
+
+  EXPECT_GT(LitPixels(before), 0);
+  EXPECT_EQ(LitPixels(moved), 0);
+  EXPECT_EQ(renderer.uploadCount(), 1);
+
+  // New geometry is uploaded again.
+  model.loadFromFile("test_figure.obj");
+  Render(renderer, model);
+  EXPECT_EQ(renderer.uploadCount(), 2);
+  renderer.release();
+}
+
+int main(int argc, char **argv) {
+  QGuiApplication app(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
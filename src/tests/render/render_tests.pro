@@ -0,0 +1,16 @@
+TEMPLATE = app
+TARGET = render_tests
+CONFIG += c++20 console
+CONFIG -= app_bundle
+QT += gui opengl
+
+INCLUDEPATH += ../..
+LIBS += -lgtest -pthread
+
+SOURCES += \
+    render_tests.cpp \
+    ../../View/wireframeRenderer.cpp \
+    $$files(../../model/*.cpp)
+
+HEADERS += \
+    ../../View/wireframeRenderer.h
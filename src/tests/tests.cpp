@@ -1,7 +1,33 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
 #include "../model/affineTransformer.h"
+#include "../model/backgroundJobs.h"
+#include "../model/edgeBuilder.h"
+#include "../model/edgeClusters.h"
+#include "../model/localityReorder.h"
+#include "../model/mappedFile.h"
+#include "../model/meshCache.h"
+#include "../model/meshLoader.h"
 #include "../model/model.h"
+#include "../model/modelCache.h"
+#include "../model/morton.h"
+#include "../model/objParser.h"
+#include "../model/objWriter.h"
+#include "../model/profiler.h"
+#include "../model/quantize.h"
+#include "../model/scene.h"
+#include "../model/softwareRasterizer.h"
+#include "../model/spatialIndex.h"
+#include "../model/threadPool.h"
+#include "../model/transformCoalescer.h"
+#include "../model/transformKernel.h"
 
 TEST(Test, LoadFile) {
   s21::Model model;
@@ -39,11 +65,9 @@ TEST(Test, PolygonCount) {
 }
 
 TEST(Test, NormalizeModel) {
-  s21::Model model;
-  model.getVertices().push_back({-0.001f, -0.002f, -0.003f});
-  model.getVertices().push_back({0.001f, 0.002f, 0.003f});
-  model.normalize();
-  auto vertices = model.getVertices();
+  std::vector<s21::Vertex> vertices = {{-0.001f, -0.002f, -0.003f},
+                                       {0.001f, 0.002f, 0.003f}};
+  s21::normalizeVertices(vertices);
   for (const auto& vertex : vertices) {
     EXPECT_GE(vertex.x, -1.0f);
     EXPECT_LE(vertex.x, 1.0f);
@@ -222,4 +246,1640 @@ TEST(Test, ScaleDown) {
   EXPECT_NEAR(after.x / before.x, 0.5, 1e-6);
   EXPECT_NEAR(after.y / before.y, 0.5, 1e-6);
   EXPECT_NEAR(after.z / before.z, 0.5, 1e-6);
-}
\ No newline at end of file
+}
+TEST(Test, LoadMixedFormatting) {
+  s21::Model model;
+  EXPECT_NO_THROW(model.loadFromFile("test_formats.obj"));
+  EXPECT_EQ(model.vertexCount(), 4);
+  ASSERT_EQ(model.getPolygons().size(), 2);
+  s21::Polygon second = model.getPolygons()[1];
+  ASSERT_EQ(second.size(), 3);
+  EXPECT_EQ(second[0], 0u);
+  EXPECT_EQ(second[1], 2u);
+  EXPECT_EQ(second[2], 3u);
+}
+
+TEST(Test, LoadInvalidVertex) {
+  s21::Model model;
+  EXPECT_THROW(model.loadFromFile("test_invalid_vertex.obj"),
+               std::runtime_error);
+}
+
+TEST(Test, ParseVertexLine) {
+  std::vector<s21::Vertex> vertices;
+  s21::ObjParser::parseVertex("v 1.5 -2 3e-1", vertices);
+  ASSERT_EQ(vertices.size(), 1);
+  EXPECT_FLOAT_EQ(vertices[0].x, 1.5f);
+  EXPECT_FLOAT_EQ(vertices[0].y, -2.0f);
+  EXPECT_FLOAT_EQ(vertices[0].z, 0.3f);
+  EXPECT_THROW(s21::ObjParser::parseVertex("v 1 two 3", vertices),
+               std::runtime_error);
+  s21::PolygonList polygons;
+  EXPECT_THROW(s21::ObjParser::parsePolygon("f 1 x 3", polygons, 1),
+               std::runtime_error);
+}
+
+TEST(Test, ParallelParseMatchesSerial) {
+  s21::MappedFile file("../objModels/skull.obj");
+  std::vector<s21::Vertex> serialV, parallelV;
+  s21::PolygonList serialP, parallelP;
+  s21::ObjParser::parseText(file.view(), serialV, serialP);
+  s21::ObjParser::parseParallel(file.view(), 4, parallelV, parallelP, nullptr,
+                                4096);
+
+  ASSERT_EQ(serialV.size(), parallelV.size());
+  ASSERT_EQ(serialP.size(), parallelP.size());
+  for (size_t i = 0; i < serialV.size(); ++i) {
+    EXPECT_EQ(serialV[i].x, parallelV[i].x);
+    EXPECT_EQ(serialV[i].y, parallelV[i].y);
+    EXPECT_EQ(serialV[i].z, parallelV[i].z);
+  }
+  for (size_t i = 0; i < serialP.size(); ++i)
+    EXPECT_TRUE(std::ranges::equal(serialP[i], parallelP[i]));
+}
+
+TEST(Test, ObjCountMatchesParse) {
+  const std::string text =
+      "# f 1 2 3\nv 0 0 0\n  v\t1 0 0 \nvt 0 0\nvn 0 0 1\nv 0 1 0\n"
+      "fo 1 2 3\nf 1/1/1 2//1  3/1 \nf\t-3 -2 -1\r\ng v f\nf 1 2 3 1";
+  const s21::ObjCounts counts = s21::ObjParser::count(text);
+  std::vector<s21::Vertex> vertices;
+  s21::PolygonList polygons;
+  s21::ObjParser::parseText(text, vertices, polygons);
+  EXPECT_EQ(counts.vertices, vertices.size());
+  EXPECT_EQ(counts.faces, polygons.size());
+  EXPECT_EQ(counts.indices, polygons.indices().size());
+  // The containers were sized once, from the counts.
+  EXPECT_EQ(vertices.capacity(), vertices.size());
+  EXPECT_EQ(polygons.indices().capacity(), polygons.indices().size());
+
+  s21::MappedFile file("../objModels/skull.obj");
+  const s21::ObjCounts skull = s21::ObjParser::count(file.view());
+  s21::ObjParser::parseParallel(file.view(), 4, vertices, polygons, nullptr,
+                                4096);
+  EXPECT_EQ(counts.vertices + skull.vertices, vertices.size());
+  EXPECT_EQ(counts.indices + skull.indices, polygons.indices().size());
+  EXPECT_EQ(vertices.capacity(), vertices.size());
+}
+
+TEST(Test, ParallelParseReportsFirstError) {
+  std::string text;
+  for (int i = 0; i < 2000; ++i) {
+    if (i == 700) text += "f 1 2\n";
+    if (i == 1500) text += "v 1 2\n";
+    text += "v 0.5 0.25 0.125\nf 1 2 3\n";
+  }
+
+  std::string serialError, parallelError;
+  std::vector<s21::Vertex> v;
+  s21::PolygonList p;
+  try {
+    s21::ObjParser::parseText(text, v, p);
+  } catch (const std::runtime_error& e) {
+    serialError = e.what();
+  }
+  v.clear();
+  p.clear();
+  try {
+    s21::ObjParser::parseParallel(text, 8, v, p, nullptr, 256);
+  } catch (const std::runtime_error& e) {
+    parallelError = e.what();
+  }
+  EXPECT_FALSE(serialError.empty());
+  EXPECT_EQ(serialError, parallelError);
+}
+
+TEST(Test, ObjGroupsAndRelativeIndices) {
+  // 300 parts of two quads each, addressed with relative indices, so the
+  // parallel chunks cut through parts and groups.
+  std::string text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+  for (int k = 0; k < 300; ++k) {
+    text += "o part" + std::to_string(k) + "\n";
+    if (k % 2) text += "usemtl steel\n";
+    for (int i = 0; i < 4; ++i) text += "v " + std::to_string(k + i) + " 1 2\n";
+    text += "f -4 -3 -2 -1\ng back\nf -1/-1 -2/-2 -3/-3 -4/-4\n";
+  }
+  std::vector<s21::Vertex> serialV, parallelV;
+  s21::PolygonList serialP, parallelP;
+  std::vector<s21::FaceGroup> serialG, parallelG;
+  s21::ObjParser::parseText(text, serialV, serialP, &serialG);
+  s21::ObjParser::parseParallel(text, 8, parallelV, parallelP, nullptr, 256,
+                                &parallelG);
+  EXPECT_EQ(serialP.indices(), parallelP.indices());
+  // Streamed batches carry resolved, file-global indices too.
+  s21::PolygonList streamed;
+  s21::LoadProgress progress;
+  progress.onBatch = [&](const std::vector<s21::Vertex>&,
+                         const s21::PolygonList& polygons) {
+    streamed.append(polygons);
+  };
+  parallelV.clear();
+  parallelP.clear();
+  s21::ObjParser::parseParallel(text, 8, parallelV, parallelP, &progress, 256);
+  EXPECT_EQ(serialP.indices(), streamed.indices());
+  ASSERT_EQ(serialG.size(), 601);
+  ASSERT_EQ(parallelG.size(), serialG.size());
+  for (size_t g = 0; g < serialG.size(); ++g) {
+    EXPECT_EQ(serialG[g].object, parallelG[g].object);
+    EXPECT_EQ(serialG[g].group, parallelG[g].group);
+    EXPECT_EQ(serialG[g].material, parallelG[g].material);
+    EXPECT_EQ(serialG[g].firstFace, parallelG[g].firstFace);
+    EXPECT_EQ(serialG[g].faceCount, parallelG[g].faceCount);
+  }
+  // Faces before the first statement form an unnamed group.
+  EXPECT_EQ(serialG[0].object, "");
+  EXPECT_EQ(serialG[0].faceCount, 1);
+  const s21::FaceGroup& back = serialG[2 * 7 + 2];
+  EXPECT_EQ(back.object, "part7");
+  EXPECT_EQ(back.group, "back");
+  EXPECT_EQ(back.material, "steel");
+  EXPECT_EQ(back.firstFace, 2 * 7 + 2);
+  const s21::Polygon face = serialP[back.firstFace];
+  ASSERT_EQ(face.size(), 4);
+  EXPECT_EQ(face[0], 3 + 4 * 7 + 3);
+  EXPECT_EQ(face[3], 3 + 4 * 7);
+
+  // Edges are unique per group and each group owns a contiguous range.
+  std::vector<s21::Edge> edges =
+      s21::EdgeBuilder::build(serialP, serialV.size(), serialG);
+  EXPECT_EQ(edges.size(), 3 + 300 * 8);
+  EXPECT_EQ(serialG[1].firstEdge, 3);
+  EXPECT_EQ(serialG[1].edgeCount, 4);
+  EXPECT_EQ(back.firstEdge, 3 + 8 * 7 + 4);
+
+  // A relative index before the first vertex fails the same way in both.
+  std::string bad = text + "f -1 -2 -99999\n" + text;
+  std::string serialError, parallelError;
+  serialV.clear();
+  serialP.clear();
+  try {
+    s21::ObjParser::parseText(bad, serialV, serialP);
+  } catch (const std::runtime_error& e) {
+    serialError = e.what();
+  }
+  parallelV.clear();
+  parallelP.clear();
+  try {
+    s21::ObjParser::parseParallel(bad, 8, parallelV, parallelP, nullptr, 256);
+  } catch (const std::runtime_error& e) {
+    parallelError = e.what();
+  }
+  EXPECT_EQ(serialError, "Invalid polygon index: f -1 -2 -99999");
+  EXPECT_EQ(serialError, parallelError);
+}
+
+TEST(Test, GroupVisibilitySelectsEdgeRanges) {
+  const s21::Mesh mesh = s21::MeshLoader::load("../objModels/skull.obj", {});
+  ASSERT_GE(mesh.groups.size(), 3);
+  s21::Model model;
+  model.setLodEnabled(true);
+  model.setMesh(mesh);
+  const unsigned total = static_cast<unsigned>(model.edgeCount());
+  ASSERT_EQ(model.visibleEdgeRanges().size(), 1);
+  EXPECT_EQ(model.visibleEdgeRanges()[0].count, total);
+
+  const unsigned long long version = model.geometryVersion();
+  model.isolateGroup(1);
+  const s21::FaceGroup& group = model.groups()[1];
+  ASSERT_EQ(model.visibleEdgeRanges().size(), 1);
+  EXPECT_EQ(model.visibleEdgeRanges()[0].first, group.firstEdge);
+  EXPECT_EQ(model.visibleEdgeRanges()[0].count, group.edgeCount);
+  EXPECT_FALSE(model.groupVisible(0));
+  EXPECT_EQ(model.geometryVersion(), version);
+  model.setForcedLod(1);
+  EXPECT_EQ(model.selectLod(100.f), 0);
+
+  // Clusters stay inside groups, so culling only sees the visible one.
+  std::vector<s21::EdgeClusters::Range> ranges;
+  const s21::CullStats stats = model.edgeClusters(0).cull(
+      model.transformMatrix(), 1000.f, ranges, &model.visibleEdgeRanges());
+  EXPECT_EQ(stats.edges, group.edgeCount);
+  for (const auto& r : ranges) {
+    EXPECT_GE(r.first, group.firstEdge);
+    EXPECT_LE(r.first + r.count, group.firstEdge + group.edgeCount);
+  }
+
+  model.setGroupVisible(0, true);
+  EXPECT_EQ(model.visibleEdgeRanges()[0].first, 0);
+  model.showAllGroups();
+  EXPECT_TRUE(model.allGroupsVisible());
+  EXPECT_EQ(model.visibleEdgeRanges()[0].count, total);
+  EXPECT_THROW(model.setGroupVisible(mesh.groups.size(), false),
+               std::out_of_range);
+}
+
+TEST(Test, GroupsShareBoundaryEdgesOnce) {
+  // A cube split into two groups of three faces meeting at opposite
+  // corners; the six edges between them belong to both.
+  const std::string text =
+      "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+      "v 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n"
+      "g low\nf 1 2 3 4\nf 1 2 6 5\nf 1 4 8 5\n"
+      "g high\nf 5 6 7 8\nf 4 3 7 8\nf 2 3 7 6\n";
+  s21::Mesh mesh;
+  s21::ObjParser::parseText(text, mesh.vertices, mesh.polygons, &mesh.groups);
+  mesh.edges = s21::EdgeBuilder::build(mesh.polygons, mesh.vertices.size(),
+                                       mesh.groups);
+  ASSERT_EQ(mesh.groups.size(), 2);
+  EXPECT_EQ(mesh.groups[0].edgeCount, 9);
+  EXPECT_EQ(mesh.groups[0].sharedEdgeCount, 0);
+  EXPECT_EQ(mesh.groups[1].edgeCount, 9);
+  EXPECT_EQ(mesh.groups[1].sharedEdgeCount, 6);
+  EXPECT_EQ(s21::uniqueEdgeCount(mesh), 12);
+
+  s21::Model model;
+  model.setMesh(mesh);
+  EXPECT_EQ(model.edgeCount(), 12);
+  // All shown: every edge drawn once.
+  auto drawn = [&model] {
+    std::vector<std::pair<unsigned, unsigned>> edges;
+    for (const auto& r : model.visibleEdgeRanges())
+      for (unsigned i = r.first; i < r.first + r.count; ++i)
+        edges.emplace_back(model.getEdges()[i].a, model.getEdges()[i].b);
+    std::sort(edges.begin(), edges.end());
+    return edges;
+  };
+  std::vector<std::pair<unsigned, unsigned>> all = drawn();
+  EXPECT_EQ(all.size(), 12);
+  EXPECT_EQ(std::unique(all.begin(), all.end()), all.end());
+  // The group holding only copies of the boundary still draws it whole.
+  model.isolateGroup(1);
+  EXPECT_EQ(drawn().size(), 9);
+  model.showAllGroups();
+  EXPECT_EQ(drawn().size(), 12);
+
+  std::vector<s21::EdgeClusters::Range> ranges;
+  const s21::CullStats stats = model.edgeClusters(0).cull(
+      model.transformMatrix(), 1000.f, ranges, &model.visibleEdgeRanges());
+  EXPECT_EQ(stats.edges, 12);
+}
+
+TEST(Test, ThreadPoolRunsEveryIndex) {
+  s21::ThreadPool pool(3);
+  std::vector<int> hits(1000, 0);
+  pool.parallelFor(hits.size(), 0, [&](size_t i) {
+    ++hits[i];
+    if (i % 100 == 0) pool.parallelFor(4, 0, [](size_t) {});
+  });
+  for (int h : hits) EXPECT_EQ(h, 1);
+  EXPECT_THROW(pool.parallelFor(10, 0,
+                                [](size_t i) {
+                                  if (i == 5) throw std::runtime_error("x");
+                                }),
+               std::runtime_error);
+}
+
+TEST(Test, ParallelPassesMatchSerial) {
+  s21::ThreadPool pool(3);
+  const size_t count = s21::ThreadPool::kParallelThreshold * 2 + 5;
+  std::vector<int> hits(count, 0);
+  std::vector<size_t> blocks;
+  std::mutex mutex;
+  pool.parallelBlocks(count, 0, [&](size_t block, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) ++hits[i];
+    std::lock_guard<std::mutex> lock(mutex);
+    blocks.push_back(block);
+    EXPECT_EQ(begin, block * s21::ThreadPool::kBlockSize);
+  });
+  for (int h : hits) EXPECT_EQ(h, 1);
+  EXPECT_EQ(blocks.size(), s21::ThreadPool::blockCount(count));
+
+  std::vector<s21::Vertex> vertices;
+  for (size_t i = 0; i < count; ++i)
+    vertices.push_back({std::sin(i * 0.37f) * 40.f, std::cos(i * 0.11f),
+                        std::sin(i * 0.05f) * 3.f + 7.f});
+  std::vector<s21::Vertex> serial = vertices;
+  const s21::Bounds a = s21::normalizeVertices(serial, 1);
+  const s21::Bounds b = s21::normalizeVertices(vertices, 0);
+  EXPECT_EQ(a.min.x, b.min.x);
+  EXPECT_EQ(a.max.z, b.max.z);
+  EXPECT_EQ(std::memcmp(serial.data(), vertices.data(),
+                        count * sizeof(s21::Vertex)),
+            0);
+  const s21::Vertex c1 = s21::centroid(vertices, 1);
+  const s21::Vertex c0 = s21::centroid(vertices, 0);
+  EXPECT_TRUE(c1.x == c0.x && c1.y == c0.y && c1.z == c0.z);
+  EXPECT_NEAR(c0.y, 0.f, 0.01f);
+
+  s21::Mesh mesh;
+  mesh.vertices = vertices;
+  for (auto layout : {s21::VertexLayout::kArrayOfStructs,
+                      s21::VertexLayout::kStructOfArrays,
+                      s21::VertexLayout::kQuantized}) {
+    s21::Model one, all;
+    one.setLoadThreads(1);
+    one.setVertexLayout(layout);
+    all.setVertexLayout(layout);
+    one.setMesh(mesh);
+    all.setMesh(mesh);
+    one.setRotation(0.3f, -1.2f, 2.f);
+    all.setRotation(0.3f, -1.2f, 2.f);
+    const auto& x = one.getVertices();
+    const auto& y = all.getVertices();
+    ASSERT_EQ(x.size(), y.size());
+    EXPECT_EQ(std::memcmp(x.data(), y.data(), count * sizeof(s21::Vertex)),
+              0);
+  }
+}
+
+TEST(Test, PolygonListLayout) {
+  s21::Model model;
+  model.loadFromFile("test_figure.obj");
+  const s21::PolygonList& polygons = model.getPolygons();
+  EXPECT_EQ(polygons.indices().size(), 24);
+  ASSERT_EQ(polygons.offsets().size(), polygons.size() + 1);
+  size_t faces = 0;
+  for (s21::Polygon p : polygons) {
+    EXPECT_EQ(p.size(), 4);
+    EXPECT_EQ(p.data(), polygons.indices().data() + 4 * faces);
+    ++faces;
+  }
+  EXPECT_EQ(faces, 6);
+}
+
+TEST(Test, TransformKernelMatchesScalar) {
+  s21::AffineTransformer t;
+  t.translate(0.3f, -1.2f, 4.0f);
+  t.rotateZ(0.7f);
+  t.rotateY(-1.1f);
+  t.rotateX(2.3f);
+  t.scale(17.5f, 17.5f, 17.5f);
+
+  std::vector<s21::Vertex> vertices;
+  for (int i = 0; i < 1003; ++i)
+    vertices.push_back({std::sin(i * 0.37f), std::cos(i * 0.11f),
+                        std::sin(i * 0.05f) * 0.5f});
+  s21::VertexArrays in;
+  in.assign(vertices);
+
+  using Isa = s21::TransformKernel::Isa;
+  for (Isa isa : {Isa::kScalar, Isa::kSse, Isa::kAvx2}) {
+    if (!s21::TransformKernel::isSupported(isa)) continue;
+    s21::VertexArrays out;
+    s21::TransformKernel::transform(t.matrix(), in, out, isa);
+    ASSERT_EQ(out.size(), vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      s21::Vertex expected = vertices[i];
+      t.applyToVertex(expected);
+      const float eps = s21::TransformKernel::kTransformEpsilon;
+      EXPECT_NEAR(out.x[i], expected.x,
+                  eps * std::max(1.f, std::fabs(expected.x)));
+      EXPECT_NEAR(out.y[i], expected.y,
+                  eps * std::max(1.f, std::fabs(expected.y)));
+      EXPECT_NEAR(out.z[i], expected.z,
+                  eps * std::max(1.f, std::fabs(expected.z)));
+    }
+  }
+}
+
+TEST(Test, StructOfArraysLayout) {
+  s21::Model aos;
+  s21::Model soa;
+  soa.setVertexLayout(s21::VertexLayout::kStructOfArrays);
+  aos.loadFromFile("test_figure.obj");
+  soa.loadFromFile("test_figure.obj");
+  aos.setRotation(0.4f, 1.3f, -0.2f);
+  soa.setRotation(0.4f, 1.3f, -0.2f);
+  aos.setScale(2.5f);
+  soa.setScale(2.5f);
+
+  ASSERT_EQ(soa.getVertexArrays().size(), 8);
+  const auto& a = aos.getVertices();
+  const auto& b = soa.getVertices();
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_NEAR(a[i].x, b[i].x, 1e-5);
+    EXPECT_NEAR(a[i].y, b[i].y, 1e-5);
+    EXPECT_NEAR(a[i].z, b[i].z, 1e-5);
+    EXPECT_EQ(b[i].x, soa.getVertexArrays().x[i]);
+  }
+}
+
+TEST(Test, QuantizedLayoutMatchesFloat) {
+  s21::Model soa;
+  s21::Model compact;
+  soa.setVertexLayout(s21::VertexLayout::kStructOfArrays);
+  compact.setVertexLayout(s21::VertexLayout::kQuantized);
+  soa.loadFromFile("../objModels/skull.obj");
+  compact.loadFromFile("../objModels/skull.obj");
+
+  const s21::GeometryFootprint f = compact.footprint();
+  EXPECT_TRUE(f.narrowIndices);
+  EXPECT_LE(f.bytesPerVertex, 6.5);
+  // Triangles: three 16-bit indices and a 32-bit offset against 16 bytes.
+  EXPECT_LE(f.bytesPerFace, 10.01);
+  EXPECT_LT(f.bytesPerFace + 5.9, soa.footprint().bytesPerFace);
+  // Normalized geometry spans at most 1 unit per axis.
+  EXPECT_GT(f.maxError, 0.f);
+  EXPECT_LE(f.maxError, 0.5f / 65535 + 1e-6f);
+
+  soa.setRotation(0.4f, 1.3f, -0.2f);
+  compact.setRotation(0.4f, 1.3f, -0.2f);
+  soa.setScale(2.5f);
+  compact.setScale(2.5f);
+  const auto& a = soa.getVertices();
+  const auto& b = compact.getVertices();
+  ASSERT_EQ(a.size(), b.size());
+  // A rotation keeps lengths, so the error grows only with the scale.
+  const float eps = 2.5f * f.maxError * std::sqrt(3.f) + 1e-5f;
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_NEAR(a[i].x, b[i].x, eps);
+    EXPECT_NEAR(a[i].y, b[i].y, eps);
+    EXPECT_NEAR(a[i].z, b[i].z, eps);
+  }
+  EXPECT_EQ(compact.getVertexArrays().x[7], b[7].x);
+
+  EXPECT_EQ(compact.getPolygons().indices(), soa.getPolygons().indices());
+  EXPECT_EQ(compact.getEdges().size(), soa.getEdges().size());
+  const s21::PickResult hit = compact.raycast(0.f, 0.f);
+  EXPECT_EQ(hit.found, soa.raycast(0.f, 0.f).found);
+
+  compact.setVertexLayout(s21::VertexLayout::kArrayOfStructs);
+  EXPECT_EQ(compact.footprint().maxError, 0.f);
+  EXPECT_EQ(compact.getOriginalVertices().size(), a.size());
+  EXPECT_NEAR(compact.getVertices()[7].x, a[7].x, eps);
+}
+
+TEST(Test, QuantizedKernelMatchesDecode) {
+  std::vector<s21::Vertex> vertices;
+  for (int i = 0; i < 1003; ++i)
+    vertices.push_back({std::sin(i * 0.37f), std::cos(i * 0.11f),
+                        std::sin(i * 0.05f) * 0.5f});
+  s21::QuantizedVertices q;
+  q.encode(vertices);
+  ASSERT_EQ(q.size(), vertices.size());
+  EXPECT_LE(q.maxError(), 0.5f * std::max({q.step().x, q.step().y,
+                                           q.step().z}) * 1.01f);
+
+  s21::AffineTransformer t;
+  t.translate(0.3f, -1.2f, 4.0f);
+  t.rotateY(-1.1f);
+  t.scale(17.5f, 17.5f, 17.5f);
+  using Isa = s21::TransformKernel::Isa;
+  for (Isa isa : {Isa::kScalar, Isa::kSse, Isa::kAvx2}) {
+    if (!s21::TransformKernel::isSupported(isa)) continue;
+    s21::VertexArrays out;
+    q.transform(t.matrix(), out, isa);
+    ASSERT_EQ(out.size(), vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      s21::Vertex expected = q[i];
+      t.applyToVertex(expected);
+      const float eps = 1e-4f * std::max(1.f, std::fabs(expected.x));
+      EXPECT_NEAR(out.x[i], expected.x, eps);
+      EXPECT_NEAR(out.y[i], expected.y, eps);
+      EXPECT_NEAR(out.z[i], expected.z, eps);
+    }
+  }
+}
+
+TEST(Test, TransformIsAppliedLazily) {
+  s21::Model model;
+  model.loadFromFile("test_figure.obj");
+  const auto& vertices = model.getVertices();
+  const s21::Vertex before = vertices[0];
+
+  model.setScale(2.0f);
+  model.setTranslation(1.0f, 0.0f, 0.0f);
+  model.setRotation(0.0f, 0.0f, 0.0f);
+  EXPECT_EQ(vertices[0].x, before.x);
+  EXPECT_FLOAT_EQ(model.transformMatrix()[0][0], 2.0f);
+  EXPECT_FLOAT_EQ(model.transformMatrix()[0][3], 1.0f);
+
+  const s21::Vertex after = model.getVertices()[0];
+  EXPECT_NEAR(after.x, before.x * 2.0f + 1.0f, 1e-6);
+  EXPECT_NEAR(after.y, before.y * 2.0f, 1e-6);
+  EXPECT_NEAR(after.z, before.z * 2.0f, 1e-6);
+}
+
+TEST(Test, EdgesAreUnique) {
+  s21::Model model;
+  model.loadFromFile("test_formats.obj");
+  const auto& edges = model.getEdges();
+  EXPECT_EQ(model.edgeCount(), 5);
+  ASSERT_EQ(edges.size(), 5);
+  for (size_t i = 0; i < edges.size(); ++i) {
+    EXPECT_LT(edges[i].a, edges[i].b);
+    if (i == 0) continue;
+    const s21::Edge& prev = edges[i - 1];
+    EXPECT_TRUE(prev.a < edges[i].a ||
+                (prev.a == edges[i].a && prev.b < edges[i].b));
+  }
+}
+
+TEST(Test, EdgeCountOpenMesh) {
+  s21::Model model;
+  model.loadFromFile("test_open_quad.obj");
+  EXPECT_EQ(model.edgeCount(), 4);
+}
+
+TEST(Test, LoadMissingVertex) {
+  s21::Model model;
+  EXPECT_THROW(model.loadFromFile("test_missing_vertex.obj"),
+               std::runtime_error);
+}
+
+TEST(Test, BinaryCacheRoundTrip) {
+  namespace fs = std::filesystem;
+  const fs::path dir = fs::temp_directory_path() / "s21_cache_test";
+  fs::create_directories(dir);
+  const fs::path source = dir / "figure.obj";
+  fs::copy_file("test_figure.obj", source,
+                fs::copy_options::overwrite_existing);
+  const std::string cache = s21::ModelCache::cachePath(source.string());
+  fs::remove(cache);
+
+  s21::Model parsed;
+  parsed.setBinaryCacheEnabled(true);
+  parsed.loadFromFile(source.string());
+  EXPECT_FALSE(parsed.loadedFromCache());
+  ASSERT_TRUE(fs::exists(cache));
+
+  s21::Model cached;
+  cached.setBinaryCacheEnabled(true);
+  cached.loadFromFile(source.string());
+  EXPECT_TRUE(cached.loadedFromCache());
+  EXPECT_EQ(cached.vertexCount(), parsed.vertexCount());
+  EXPECT_EQ(cached.edgeCount(), parsed.edgeCount());
+  EXPECT_EQ(cached.getPolygons().indices(), parsed.getPolygons().indices());
+  EXPECT_EQ(cached.bounds().max.x, parsed.bounds().max.x);
+  for (size_t i = 0; i < parsed.vertexCount(); ++i)
+    EXPECT_EQ(cached.getVertices()[i].y, parsed.getVertices()[i].y);
+
+  // A flipped payload byte must be detected and fall back to the parser.
+  {
+    std::fstream f(cache, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(-3, std::ios::end);
+    f.put('\x7f');
+  }
+  s21::Model corrupted;
+  corrupted.setBinaryCacheEnabled(true);
+  corrupted.loadFromFile(source.string());
+  EXPECT_FALSE(corrupted.loadedFromCache());
+  EXPECT_EQ(corrupted.edgeCount(), 12);
+
+  // A changed source makes the cache stale.
+  {
+    std::ofstream f(source, std::ios::app);
+    f << "\nv 2 2 2\n";
+  }
+  s21::Model stale;
+  stale.setBinaryCacheEnabled(true);
+  stale.loadFromFile(source.string());
+  EXPECT_FALSE(stale.loadedFromCache());
+  EXPECT_EQ(stale.vertexCount(), 9);
+
+  fs::remove_all(dir);
+}
+
+TEST(Test, BinaryCacheRejectsInvalidMesh) {
+  namespace fs = std::filesystem;
+  const fs::path dir = fs::temp_directory_path() / "s21_cache_invalid";
+  fs::create_directories(dir);
+  const fs::path source = dir / "figure.obj";
+  fs::copy_file("test_figure.obj", source,
+                fs::copy_options::overwrite_existing);
+  s21::LoadOptions options;
+  options.useCache = true;
+  const s21::Mesh good = s21::MeshLoader::load(source.string(), options);
+  s21::Mesh mesh;
+  ASSERT_TRUE(s21::ModelCache::load(source.string(), mesh));
+
+  // store() writes whatever it is given with a matching payload hash, so
+  // each of these reaches the topology checks.
+  const auto& indices = good.polygons.indices();
+  const auto& offsets = good.polygons.offsets();
+  std::vector<s21::Mesh> broken(6, good);
+  std::vector<unsigned> bad = indices;
+  bad.back() = static_cast<unsigned>(good.vertices.size());
+  broken[0].polygons.assign(bad.data(), bad.size(), offsets.data(),
+                            offsets.size());
+  std::vector<unsigned> unordered = offsets;
+  std::swap(unordered[1], unordered[2]);
+  broken[1].polygons.assign(indices.data(), indices.size(),
+                            unordered.data(), unordered.size());
+  broken[2].edges.back().b = static_cast<unsigned>(good.vertices.size());
+  broken[3].groups.assign(1, s21::FaceGroup{});
+  broken[3].groups[0].faceCount =
+      static_cast<unsigned>(good.polygons.size() + 1);
+  broken[4].groups.assign(1, s21::FaceGroup{});
+  broken[4].groups[0].firstEdge = 1;
+  broken[4].groups[0].edgeCount = static_cast<unsigned>(good.edges.size());
+  broken[5].groups.assign(1, s21::FaceGroup{});
+  broken[5].groups[0].edgeCount = 1;
+  broken[5].groups[0].sharedEdgeCount = 2;
+  for (const s21::Mesh& m : broken) {
+    ASSERT_TRUE(s21::ModelCache::store(source.string(), m));
+    EXPECT_FALSE(s21::ModelCache::load(source.string(), mesh));
+  }
+
+  // A same-size edit with the old mtime put back still misses: the source
+  // content hash is checked too.
+  ASSERT_TRUE(s21::ModelCache::store(source.string(), good));
+  const auto mtime = fs::last_write_time(source);
+  {
+    std::fstream f(source, std::ios::in | std::ios::out | std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(f)), {});
+    const size_t digit = text.find_first_of("0123456789");
+    ASSERT_NE(digit, std::string::npos);
+    f.seekp(static_cast<std::streamoff>(digit));
+    f.put(text[digit] == '9' ? '8' : '9');
+  }
+  fs::last_write_time(source, mtime);
+  EXPECT_FALSE(s21::ModelCache::load(source.string(), mesh));
+
+  fs::remove_all(dir);
+}
+
+TEST(Test, MeshLoaderReportsProgress) {
+  s21::LoadOptions options;
+  options.threads = 1;
+  size_t last = 0, total = 0;
+  options.progress.onProgress = [&](size_t done, size_t all) {
+    EXPECT_GE(done, last);
+    last = done;
+    total = all;
+  };
+  s21::Mesh mesh = s21::MeshLoader::load("../objModels/skull.obj", options);
+  EXPECT_GT(total, 0u);
+  EXPECT_EQ(last, total);
+
+  s21::Model model;
+  model.loadFromFile("test_figure.obj");
+  const auto version = model.geometryVersion();
+  const size_t vertices = mesh.vertices.size();
+  model.setMesh(std::move(mesh));
+  EXPECT_EQ(model.vertexCount(), vertices);
+  EXPECT_NE(model.geometryVersion(), version);
+  EXPECT_EQ(model.getVertices().size(), vertices);
+}
+
+TEST(Test, MeshLoaderCancels) {
+  std::atomic<bool> cancelled{true};
+  s21::LoadOptions options;
+  options.progress.cancelled = &cancelled;
+  EXPECT_THROW(s21::MeshLoader::load("../objModels/skull.obj", options),
+               s21::LoadCancelled);
+
+  s21::Model model;
+  model.loadFromFile("test_figure.obj");
+  EXPECT_THROW(model.loadFromFile("test_invalid.obj"), std::runtime_error);
+  EXPECT_EQ(model.vertexCount(), 8);
+}
+
+TEST(Test, StreamingBatchesArriveInOrder) {
+  s21::MappedFile file("../objModels/skull.obj");
+  std::vector<s21::Vertex> serialV;
+  s21::PolygonList serialP;
+  s21::ObjParser::parseText(file.view(), serialV, serialP);
+
+  for (unsigned threads : {1u, 4u}) {
+    std::vector<s21::Vertex> streamedV, v;
+    s21::PolygonList streamedP, p;
+    size_t batches = 0;
+    s21::LoadProgress progress;
+    progress.onBatch = [&](const std::vector<s21::Vertex> &vertices,
+                           const s21::PolygonList &polygons) {
+      streamedV.insert(streamedV.end(), vertices.begin(), vertices.end());
+      streamedP.append(polygons);
+      ++batches;
+    };
+    s21::ObjParser::parseParallel(file.view(), threads, v, p, &progress,
+                                  4096);
+
+    EXPECT_GT(batches, 1);
+    ASSERT_EQ(streamedV.size(), serialV.size());
+    ASSERT_EQ(streamedP.size(), serialP.size());
+    ASSERT_EQ(p.size(), serialP.size());
+    for (size_t i = 0; i < serialV.size(); ++i) {
+      EXPECT_EQ(streamedV[i].x, serialV[i].x);
+      EXPECT_EQ(streamedV[i].y, serialV[i].y);
+      EXPECT_EQ(streamedV[i].z, serialV[i].z);
+    }
+    EXPECT_TRUE(std::ranges::equal(streamedP.indices(), serialP.indices()));
+  }
+}
+
+TEST(Test, PreviewBatchesOnlyAppend) {
+  s21::Model model;
+  model.beginPreview("batches.obj");
+  const auto geometry = model.geometryVersion();
+  const auto preview = model.previewVersion();
+
+  const unsigned lower[] = {0, 1, 2}, upper[] = {1, 3, 2};
+  s21::PolygonList first, second;
+  first.addPolygon(lower);
+  second.addPolygon(upper);
+  model.appendPreview({{0, 0, 0}, {1, 0, 0}, {0, 1, 0}}, first);
+  const std::vector<s21::Edge> edges = model.getEdges();
+  ASSERT_EQ(edges.size(), 3);
+
+  model.appendPreview({{1, 1, 0}}, second);
+  EXPECT_EQ(model.previewVersion(), preview + 2);
+  EXPECT_EQ(model.geometryVersion(), geometry);
+  EXPECT_EQ(model.vertexCount(), 4);
+  ASSERT_EQ(model.getEdges().size(), 6);
+  EXPECT_TRUE(std::equal(edges.begin(), edges.end(),
+                         model.getEdges().begin(),
+                         [](const s21::Edge& a, const s21::Edge& b) {
+                           return a.a == b.a && a.b == b.b;
+                         }));
+
+  model.loadFromFile("test_figure.obj");
+  EXPECT_NE(model.geometryVersion(), geometry);
+}
+
+TEST(Test, PreviewConvergesToFinalMesh) {
+  s21::MappedFile file("../objModels/skull.obj");
+  s21::Model preview;
+  preview.beginPreview("../objModels/skull.obj");
+  s21::LoadProgress progress;
+  bool first = true;
+  progress.onBatch = [&](const std::vector<s21::Vertex> &vertices,
+                         const s21::PolygonList &polygons) {
+    preview.appendPreview(vertices, polygons);
+    if (first && preview.vertexCount() > 0) {
+      const s21::Bounds &b = preview.bounds();
+      EXPECT_GE(b.min.x, -0.5f - 1e-6f);
+      EXPECT_LE(b.max.x, 0.5f + 1e-6f);
+      EXPECT_FALSE(preview.getEdges().empty());
+      first = false;
+    }
+  };
+  std::vector<s21::Vertex> v;
+  s21::PolygonList p;
+  s21::ObjParser::parseParallel(file.view(), 1, v, p, &progress, 4096);
+  EXPECT_TRUE(preview.isPreview());
+
+  s21::Model final;
+  final.loadFromFile("../objModels/skull.obj");
+  ASSERT_EQ(preview.vertexCount(), final.vertexCount());
+  EXPECT_EQ(preview.getPolygons().size(), final.getPolygons().size());
+  preview.setRotation(0.3f, -0.2f, 0.1f);
+  final.setRotation(0.3f, -0.2f, 0.1f);
+  const auto &a = preview.getVertices();
+  const auto &b = final.getVertices();
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_NEAR(a[i].x, b[i].x, 1e-5f);
+    EXPECT_NEAR(a[i].y, b[i].y, 1e-5f);
+    EXPECT_NEAR(a[i].z, b[i].z, 1e-5f);
+  }
+
+  preview.setMesh(s21::MeshLoader::load("../objModels/skull.obj", {}));
+  EXPECT_FALSE(preview.isPreview());
+  EXPECT_EQ(preview.edgeCount(), final.edgeCount());
+}
+
+TEST(Test, ProfilerRecordsStagesWhenEnabled) {
+  s21::Profiler &profiler = s21::Profiler::instance();
+  profiler.reset();
+  s21::Model model;
+  model.loadFromFile("test_figure.obj");
+  model.getVertices();
+  EXPECT_EQ(profiler.stats().stage(s21::Stage::kLoad).calls, 0);
+
+  profiler.setEnabled(true);
+  model.loadFromFile("../objModels/skull.obj");
+  model.setRotation(0.5f, 0.f, 0.f);
+  model.getVertices();
+  profiler.frame(model.edgeCount());
+  profiler.frame(model.edgeCount());
+  profiler.setEnabled(false);
+
+  const s21::ProfilerStats stats = profiler.stats();
+  EXPECT_EQ(stats.stage(s21::Stage::kLoad).calls, 1);
+  EXPECT_GE(stats.stage(s21::Stage::kParse).calls, 1);
+  EXPECT_EQ(stats.stage(s21::Stage::kEdges).calls, 1);
+  EXPECT_EQ(stats.stage(s21::Stage::kNormalize).calls, 1);
+  EXPECT_EQ(stats.stage(s21::Stage::kTransform).calls, 1);
+  EXPECT_EQ(stats.verticesTransformed, model.vertexCount());
+  EXPECT_GT(stats.verticesPerSecond(), 0.0);
+  EXPECT_EQ(stats.frames, 2);
+  EXPECT_EQ(stats.edgesPerFrame, model.edgeCount());
+  EXPECT_GE(stats.peakModelBytes,
+            model.vertexCount() * sizeof(s21::Vertex) * 2);
+
+  const auto trace =
+      std::filesystem::temp_directory_path() / "s21_profiler_trace.json";
+  profiler.writeChromeTrace(trace.string());
+  std::ifstream in(trace);
+  std::string json((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  EXPECT_EQ(json.rfind("{\"displayTimeUnit\"", 0), 0);
+  EXPECT_NE(json.find("\"name\":\"parse\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"transform\""), std::string::npos);
+  std::filesystem::remove(trace);
+  profiler.reset();
+}
+
+TEST(Test, ObjWriterRoundTrip) {
+  s21::Model model;
+  model.loadFromFile("../objModels/skull.obj");
+  model.setRotation(0.3f, 1.1f, -0.7f);
+  const std::vector<s21::Vertex> &vertices = model.getVertices();
+  const auto path =
+      std::filesystem::temp_directory_path() / "s21_writer_roundtrip.obj";
+  s21::ObjWriter::write(path.string(), vertices, model.getPolygons());
+
+  std::vector<s21::Vertex> readV;
+  s21::PolygonList readP;
+  {
+    s21::MappedFile file(path.string());
+    s21::ObjParser::parseText(file.view(), readV, readP);
+  }
+  std::filesystem::remove(path);
+
+  ASSERT_EQ(readV.size(), vertices.size());
+  for (size_t i = 0; i < readV.size(); ++i) {
+    EXPECT_EQ(readV[i].x, vertices[i].x);
+    EXPECT_EQ(readV[i].y, vertices[i].y);
+    EXPECT_EQ(readV[i].z, vertices[i].z);
+  }
+  EXPECT_TRUE(
+      std::ranges::equal(readP.indices(), model.getPolygons().indices()));
+  EXPECT_TRUE(
+      std::ranges::equal(readP.offsets(), model.getPolygons().offsets()));
+}
+
+TEST(Test, SoftwareRasterizerDrawsLine) {
+  const std::vector<s21::Vertex> vertices = {{-0.5f, 0.05f, 0.f},
+                                             {0.5f, 0.05f, 0.f}};
+  const std::vector<s21::Edge> edges = {{0, 1}};
+  s21::RasterOptions options;
+  s21::Framebuffer image(16, 16);
+  s21::SoftwareRasterizer::render(vertices, edges, options, image);
+
+  int lit = 0;
+  for (int y = 0; y < 16; ++y) {
+    for (int x = 0; x < 16; ++x) {
+      const bool on = image.pixel(x, y) == options.line;
+      lit += on;
+      EXPECT_EQ(on, y == 7 && x >= 4 && x < 12) << x << "," << y;
+    }
+  }
+  EXPECT_EQ(lit, 8);
+}
+
+TEST(Test, SoftwareRasterizerDepthAndClipping) {
+  // A far vertical edge, a near horizontal one crossing it, and an edge
+  // behind the far plane.
+  const std::vector<s21::Vertex> vertices = {
+      {0.03f, -0.9f, -0.5f}, {0.03f, 0.9f, -0.5f}, {-0.9f, 0.03f, 0.5f},
+      {0.9f, 0.03f, 0.5f},   {-0.9f, 0.55f, -20.f}, {0.9f, 0.55f, -20.f}};
+  const std::vector<s21::Edge> edges = {{0, 1}, {2, 3}, {4, 5}};
+  s21::RasterOptions options;
+  options.depthTest = true;
+  s21::Framebuffer image(32, 32);
+  s21::SoftwareRasterizer::render(vertices, edges, options, image);
+
+  // Image row of y = 0.03 is 15, column of x = 0.03 is 16.
+  EXPECT_EQ(image.pixel(16, 15), options.line);
+  EXPECT_FLOAT_EQ(image.depth(16, 15), (-0.05f + 1.f) * 0.5f);
+  EXPECT_FLOAT_EQ(image.depth(16, 3), (0.05f + 1.f) * 0.5f);
+  for (int x = 0; x < 32; ++x) {
+    if (x == 16) continue;
+    EXPECT_EQ(image.pixel(x, 7), options.background);
+  }
+}
+
+TEST(Test, SoftwareRasterizerIgnoresThreadCount) {
+  s21::Model model;
+  model.loadFromFile("../objModels/skull.obj");
+  model.setRotation(0.4f, -0.8f, 0.2f);
+  model.setScale(1.5f);
+
+  s21::RasterOptions serial;
+  serial.threads = 1;
+  serial.depthTest = true;
+  s21::RasterOptions parallel = serial;
+  parallel.threads = 4;
+  parallel.tileSize = 16;
+  s21::Framebuffer a(256, 256), b(256, 256);
+  s21::SoftwareRasterizer::render(model, serial, a);
+  s21::SoftwareRasterizer::render(model, parallel, b);
+
+  EXPECT_EQ(a.rgb(), b.rgb());
+  EXPECT_GT(std::count(a.rgb().begin(), a.rgb().end(), 230), 1000);
+}
+
+TEST(Test, FramebufferWritesImages) {
+  s21::Framebuffer image(300, 250);
+  image.clear({1, 2, 3});
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto png = dir / "s21_image.png";
+  const auto ppm = dir / "s21_image.ppm";
+  image.write(png.string());
+  image.write(ppm.string());
+
+  std::ifstream in(png, std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+  EXPECT_EQ(bytes.substr(1, 3), "PNG");
+  EXPECT_NE(bytes.find("IHDR"), std::string::npos);
+  EXPECT_NE(bytes.find("IEND"), std::string::npos);
+  EXPECT_GT(bytes.size(), 300u * 250u * 3u);
+  EXPECT_EQ(std::filesystem::file_size(ppm),
+            std::string("P6\n300 250\n255\n").size() + 300u * 250u * 3u);
+  std::filesystem::remove(png);
+  std::filesystem::remove(ppm);
+}
+
+TEST(Test, LodPyramidGetsCoarser) {
+  s21::Model model;
+  model.setLodEnabled(true);
+  model.loadFromFile("../objModels/skull.obj");
+  ASSERT_GT(model.lodCount(), 2u);
+
+  for (size_t level = 1; level < model.lodCount(); ++level) {
+    const auto &vertices = model.getLodOriginalVertices(level);
+    const auto &edges = model.getLodEdges(level);
+    EXPECT_LT(edges.size() * 4, model.getLodEdges(level - 1).size() * 3 + 4);
+    EXPECT_GT(model.lodError(level), model.lodError(level - 1));
+    for (const s21::Edge &e : edges) {
+      ASSERT_LT(e.a, e.b);
+      ASSERT_LT(e.b, vertices.size());
+    }
+    const s21::Bounds &b = model.bounds();
+    for (const s21::Vertex &v : vertices) {
+      EXPECT_GE(v.x, b.min.x - 1e-6f);
+      EXPECT_LE(v.x, b.max.x + 1e-6f);
+    }
+  }
+
+  s21::Model plain;
+  plain.loadFromFile("../objModels/skull.obj");
+  EXPECT_EQ(plain.lodCount(), 1u);
+  EXPECT_EQ(plain.selectLod(1000.f), 0u);
+}
+
+TEST(Test, LodSelectionFollowsScale) {
+  s21::Model model;
+  model.setLodEnabled(true);
+  model.loadFromFile("../objModels/skull.obj");
+  const size_t coarsest = model.lodCount() - 1;
+
+  EXPECT_EQ(model.selectLod(1e6f), 0u);
+  const size_t full = model.selectLod(128.f);
+  model.setScale(0.1f);
+  const size_t small = model.selectLod(128.f);
+  EXPECT_GT(small, full);
+  EXPECT_LE(model.lodError(small) * 0.1f * 128.f, model.lodThreshold());
+  if (small < coarsest) {
+    EXPECT_GT(model.lodError(small + 1) * 0.1f * 128.f, model.lodThreshold());
+  }
+
+  model.setForcedLod(1);
+  EXPECT_EQ(model.selectLod(1e6f), 1u);
+  model.setForcedLod(100);
+  EXPECT_EQ(model.selectLod(1e6f), coarsest);
+  model.setForcedLod(-1);
+  EXPECT_EQ(model.selectLod(1e6f), 0u);
+}
+
+TEST(Test, LodVerticesFollowTransform) {
+  s21::Model model;
+  model.setLodEnabled(true);
+  model.loadFromFile("../objModels/skull.obj");
+  model.setRotation(0.2f, 0.4f, 0.6f);
+  model.setTranslation(0.1f, 0.f, -0.2f);
+  const auto &m = model.transformMatrix();
+  const auto &original = model.getLodOriginalVertices(2);
+  const auto &transformed = model.getLodVertices(2);
+  ASSERT_EQ(original.size(), transformed.size());
+  for (size_t i = 0; i < original.size(); ++i) {
+    const s21::Vertex &v = original[i];
+    EXPECT_NEAR(transformed[i].x,
+                m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3],
+                1e-5f);
+    EXPECT_NEAR(transformed[i].y,
+                m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3],
+                1e-5f);
+  }
+
+  // Changing the transform invalidates the cached level.
+  model.setRotation(0.f, 0.f, 0.f);
+  const s21::Vertex moved = model.getLodVertices(2)[0];
+  EXPECT_NEAR(moved.x, original[0].x + 0.1f, 1e-5f);
+  EXPECT_NEAR(moved.z, original[0].z - 0.2f, 1e-5f);
+}
+
+TEST(Test, AffineInverse) {
+  s21::AffineTransformer t;
+  t.translate(0.3f, -0.2f, 0.5f);
+  t.rotateZ(0.4f);
+  t.rotateY(-0.7f);
+  t.rotateX(1.1f);
+  t.scale(2.5f, 2.5f, 2.5f);
+  const auto& m = t.matrix();
+  const auto inv = s21::AffineTransformer::inverse(m);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      float sum = 0.f;
+      for (int k = 0; k < 4; ++k) sum += m[i][k] * inv[k][j];
+      EXPECT_NEAR(sum, i == j ? 1.f : 0.f, 1e-5f);
+    }
+  }
+}
+
+TEST(Test, SpatialIndexMatchesBruteForce) {
+  s21::Model model;
+  model.loadFromFile("../objModels/skull.obj");
+  const auto& vertices = model.getOriginalVertices();
+  const s21::SpatialIndex& index = model.spatialIndex();
+
+  for (int i = 0; i < 20; ++i) {
+    const float x = -0.5f + 0.05f * i, y = 0.4f - 0.04f * i;
+    const s21::Ray ray{{x, y, 10.f}, {0.f, 0.f, -20.f}};
+    float brute = 0.02f;
+    for (const s21::Vertex& v : vertices)
+      brute = std::min(brute, std::hypot(v.x - x, v.y - y));
+    const s21::PickResult hit = index.pickVertex(vertices, ray, 0.02f);
+    if (brute == 0.02f) {
+      EXPECT_FALSE(hit.found);
+      continue;
+    }
+    ASSERT_TRUE(hit.found);
+    EXPECT_NEAR(hit.distance, brute, 1e-5f);
+
+    const s21::Vertex point{x, y, 0.1f};
+    float nearest = std::numeric_limits<float>::infinity();
+    for (const s21::Vertex& v : vertices)
+      nearest = std::min(nearest, std::hypot(v.x - x, v.y - y, v.z - 0.1f));
+    EXPECT_NEAR(index.nearestVertex(vertices, point).distance, nearest,
+                1e-5f);
+  }
+}
+
+TEST(Test, SpatialIndexRaycast) {
+  // Two unit quads facing the camera at z = 0.5 and z = -0.5.
+  std::vector<s21::Vertex> vertices = {
+      {-1.f, -1.f, 0.5f},  {1.f, -1.f, 0.5f},  {1.f, 1.f, 0.5f},
+      {-1.f, 1.f, 0.5f},   {-1.f, -1.f, -0.5f}, {1.f, -1.f, -0.5f},
+      {1.f, 1.f, -0.5f},   {-1.f, 1.f, -0.5f}};
+  s21::PolygonList polygons;
+  const unsigned back[] = {4, 5, 6, 7}, front[] = {0, 1, 2, 3};
+  polygons.addPolygon(back);
+  polygons.addPolygon(front);
+  const s21::SpatialIndex index(vertices, polygons);
+
+  const s21::PickResult hit =
+      index.raycast(vertices, polygons, {{0.2f, 0.3f, 10.f}, {0, 0, -20.f}});
+  ASSERT_TRUE(hit.found);
+  EXPECT_EQ(hit.index, 1u);
+  EXPECT_NEAR(hit.t, 9.5f / 20.f, 1e-6f);
+  EXPECT_FALSE(
+      index.raycast(vertices, polygons, {{1.5f, 0.f, 10.f}, {0, 0, -20.f}})
+          .found);
+
+  s21::Edge edge{0, 0};
+  const s21::PickResult near = index.pickEdge(
+      vertices, polygons, {{0.98f, 0.f, 10.f}, {0, 0, -20.f}}, 0.05f, edge);
+  ASSERT_TRUE(near.found);
+  EXPECT_NEAR(near.distance, 0.02f, 1e-5f);
+  // Both quads have an edge at x = 1; the nearer one along the ray wins.
+  EXPECT_EQ(edge.a, 1u);
+  EXPECT_EQ(edge.b, 2u);
+}
+
+TEST(Test, ModelPickingFollowsTransform) {
+  s21::Model model;
+  model.loadFromFile("../objModels/skull.obj");
+  model.setRotation(0.3f, -0.5f, 0.2f);
+  model.setTranslation(0.1f, -0.1f, 0.f);
+  model.setScale(1.7f);
+  const auto& screen = model.getVertices();
+
+  const s21::Vertex& v = screen[screen.size() / 2];
+  const s21::PickResult vertex = model.pickVertex(v.x, v.y, 0.01f);
+  ASSERT_TRUE(vertex.found);
+  const s21::Vertex& picked = model.getVertices()[vertex.index];
+  EXPECT_LE(std::hypot(picked.x - v.x, picked.y - v.y), 1e-4f);
+
+  const s21::Edge& e = model.getEdges()[model.edgeCount() / 3];
+  const float mx = (screen[e.a].x + screen[e.b].x) * 0.5f;
+  const float my = (screen[e.a].y + screen[e.b].y) * 0.5f;
+  const s21::PickResult edge = model.pickEdge(mx, my, 0.01f);
+  ASSERT_TRUE(edge.found);
+  ASSERT_LT(edge.index, model.edgeCount());
+  EXPECT_NEAR(edge.distance, 0.f, 1e-4f);
+
+  EXPECT_TRUE(model.raycast(v.x, v.y).found);
+  EXPECT_FALSE(model.raycast(5.f, 5.f).found);
+  EXPECT_FALSE(model.pickVertex(5.f, 5.f, 0.01f).found);
+
+  const s21::Vertex& w = screen[screen.size() / 4];
+  const s21::PickResult nearest = model.nearestVertex({w.x, w.y, w.z});
+  ASSERT_TRUE(nearest.found);
+  EXPECT_NEAR(nearest.distance, 0.f, 1e-4f);
+  const s21::Vertex& n = screen[nearest.index];
+  EXPECT_LE(std::hypot(n.x - w.x, n.y - w.y, n.z - w.z), 1e-4f);
+  EXPECT_TRUE(model.nearestVertex({5.f, 5.f, 5.f}).found);
+  EXPECT_FALSE(model.nearestVertex({5.f, 5.f, 5.f}, 0.5f).found);
+}
+
+TEST(Test, GroupedPickingSkipsHiddenGroups) {
+  // The two-group cube of GroupsShareBoundaryEdgesOnce: "low" holds the
+  // faces at z = 0, y = 0 and x = 0, "high" the other three.
+  const std::string text =
+      "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+      "v 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n"
+      "g low\nf 1 2 3 4\nf 1 2 6 5\nf 1 4 8 5\n"
+      "g high\nf 5 6 7 8\nf 4 3 7 8\nf 2 3 7 6\n";
+  s21::Mesh mesh;
+  s21::ObjParser::parseText(text, mesh.vertices, mesh.polygons, &mesh.groups);
+  mesh.edges = s21::EdgeBuilder::build(mesh.polygons, mesh.vertices.size(),
+                                       mesh.groups);
+  mesh.bounds = s21::normalizeVertices(mesh.vertices);
+  s21::Model model;
+  model.setMesh(mesh);
+  const s21::FaceGroup& low = model.groups()[0];
+
+  // Every stored edge, own or shared copy, is found at its midpoint.
+  model.setRotation(0.3f, 0.4f, 0.f);
+  const std::vector<s21::Vertex> screen = model.getVertices();
+  auto midpoint = [&](unsigned a, unsigned b) {
+    return std::pair{(screen[a].x + screen[b].x) * 0.5f,
+                     (screen[a].y + screen[b].y) * 0.5f};
+  };
+  for (const s21::Edge& e : model.getEdges()) {
+    const auto [x, y] = midpoint(e.a, e.b);
+    const s21::PickResult picked = model.pickEdge(x, y, 1e-3f);
+    EXPECT_TRUE(picked.found);
+    if (!picked.found) continue;
+    EXPECT_EQ(model.getEdges()[picked.index].a, e.a);
+    EXPECT_EQ(model.getEdges()[picked.index].b, e.b);
+  }
+
+  // Vertex 6 and edge (5, 6) only belong to "high".
+  EXPECT_TRUE(model.pickVertex(screen[6].x, screen[6].y, 1e-3f).found);
+  model.isolateGroup(0);
+  EXPECT_FALSE(model.pickVertex(screen[6].x, screen[6].y, 1e-3f).found);
+  const auto [x, y] = midpoint(5, 6);
+  EXPECT_FALSE(model.pickEdge(x, y, 1e-3f).found);
+  // A hidden edge nearest to the cursor does not hide the visible ones.
+  const s21::PickResult near = model.pickEdge(x, y, 2.f);
+  ASSERT_TRUE(near.found);
+  EXPECT_GE(near.index, low.firstEdge);
+  EXPECT_LT(near.index, low.firstEdge + low.edgeCount);
+
+  // Looking down -z, the ray meets the top face (high) before the bottom
+  // one (low).
+  model.setRotation(0.f, 0.f, 0.f);
+  const std::vector<s21::Vertex>& flat = model.getVertices();
+  const float cx = (flat[4].x + flat[6].x) * 0.5f;
+  const float cy = (flat[4].y + flat[6].y) * 0.5f;
+  model.showAllGroups();
+  EXPECT_EQ(model.raycast(cx, cy).index, 3);
+  model.isolateGroup(0);
+  EXPECT_EQ(model.raycast(cx, cy).index, 0);
+}
+
+TEST(Test, EdgeClustersCoverEveryEdge) {
+  s21::Model model;
+  model.loadFromFile("../objModels/skull.obj");
+  const auto& vertices = model.getOriginalVertices();
+  const auto& edges = model.getEdges();
+  const s21::EdgeClusters& clusters = model.edgeClusters(0);
+
+  std::vector<unsigned> order = clusters.order();
+  ASSERT_EQ(order.size(), edges.size());
+  std::sort(order.begin(), order.end());
+  for (size_t i = 0; i < order.size(); ++i) ASSERT_EQ(order[i], i);
+
+  unsigned next = 0;
+  for (const auto& c : clusters.clusters()) {
+    EXPECT_EQ(c.first, next);
+    EXPECT_LE(c.count, s21::EdgeClusters::kClusterEdges);
+    next += c.count;
+    for (unsigned i = c.first; i < c.first + c.count; ++i) {
+      const s21::Edge& e = edges[clusters.order()[i]];
+      for (unsigned v : {e.a, e.b}) {
+        EXPECT_GE(vertices[v].x, c.box.min.x);
+        EXPECT_LE(vertices[v].x, c.box.max.x);
+        EXPECT_GE(vertices[v].z, c.box.min.z);
+        EXPECT_LE(vertices[v].z, c.box.max.z);
+      }
+    }
+  }
+  EXPECT_EQ(next, edges.size());
+}
+
+TEST(Test, EdgeClustersCullOutsideView) {
+  s21::Model model;
+  model.loadFromFile("../objModels/skull.obj");
+  const s21::EdgeClusters& clusters = model.edgeClusters(0);
+  std::vector<s21::EdgeClusters::Range> ranges;
+
+  s21::CullStats stats = clusters.cull(model.transformMatrix(), 512.f, ranges);
+  EXPECT_EQ(stats.drawnEdges, model.edgeCount());
+  ASSERT_EQ(ranges.size(), 1u);
+  EXPECT_EQ(ranges[0].count, model.edgeCount());
+
+  model.setTranslation(5.f, 0.f, 0.f);
+  stats = clusters.cull(model.transformMatrix(), 512.f, ranges);
+  EXPECT_EQ(stats.culledClusters, stats.clusters);
+  EXPECT_EQ(stats.drawnEdges, 0u);
+  EXPECT_TRUE(ranges.empty());
+
+  // Sliding the model out of view: edges with an endpoint inside are always
+  // kept, and some offsets cull part of the clusters.
+  bool partial = false;
+  for (float ty = 0.f; ty < 2.f; ty += 0.1f) {
+    model.setTranslation(0.f, ty, 0.f);
+    stats = clusters.cull(model.transformMatrix(), 512.f, ranges);
+    partial = partial || (stats.culledClusters > 0 &&
+                          stats.culledClusters < stats.clusters);
+    std::vector<bool> drawn(model.edgeCount(), false);
+    for (const auto& r : ranges) {
+      for (unsigned i = r.first; i < r.first + r.count; ++i)
+        drawn[clusters.order()[i]] = true;
+    }
+    const auto& screen = model.getVertices();
+    for (size_t i = 0; i < model.edgeCount(); ++i) {
+      const s21::Edge& e = model.getEdges()[i];
+      if (screen[e.a].y <= 1.f || screen[e.b].y <= 1.f) {
+        ASSERT_TRUE(drawn[i]);
+      }
+    }
+  }
+  EXPECT_TRUE(partial);
+}
+
+TEST(Test, EdgeClustersThinSubPixelEdges) {
+  s21::Model model;
+  model.loadFromFile("../objModels/skull.obj");
+  const s21::EdgeClusters& clusters = model.edgeClusters(0);
+  std::vector<s21::EdgeClusters::Range> ranges;
+
+  model.setScale(0.002f);
+  const s21::CullStats stats =
+      clusters.cull(model.transformMatrix(), 512.f, ranges);
+  EXPECT_EQ(stats.culledClusters, 0u);
+  EXPECT_EQ(stats.thinnedClusters, stats.clusters);
+  EXPECT_GE(stats.drawnEdges, stats.clusters);
+  EXPECT_LT(stats.drawnEdges, model.edgeCount() / 10);
+  // A thinned cluster keeps a prefix of itself.
+  for (const auto& r : ranges) {
+    bool atClusterStart = false;
+    for (const auto& c : clusters.clusters())
+      atClusterStart = atClusterStart || c.first == r.first;
+    EXPECT_TRUE(atClusterStart);
+  }
+}
+
+TEST(Test, LoaderBuildsEdgeClusters) {
+  s21::LoadOptions options;
+  options.buildLods = true;
+  options.buildEdgeClusters = true;
+  s21::Mesh mesh = s21::MeshLoader::load("../objModels/skull.obj", options);
+  ASSERT_EQ(mesh.edgeClusters.size(), mesh.lods.size() + 1);
+  EXPECT_EQ(mesh.edgeClusters[0]->order().size(), mesh.edges.size());
+  const s21::EdgeClusters* prebuilt = mesh.edgeClusters[1].get();
+
+  s21::Model model;
+  model.setMesh(std::move(mesh));
+  EXPECT_EQ(&model.edgeClusters(1), prebuilt);
+}
+
+TEST(Test, TransformCoalescerAppliesLatestStateOncePerFrame) {
+  s21::Profiler& profiler = s21::Profiler::instance();
+  profiler.reset();
+  profiler.setEnabled(true);
+  s21::Model model;
+  model.loadFromFile("test_figure.obj");
+  s21::TransformCoalescer coalescer(model);
+
+  EXPECT_TRUE(coalescer.post([](s21::Transform& t) { t.tx = 0.1f; }));
+  for (int i = 1; i <= 20; ++i) {
+    EXPECT_FALSE(coalescer.post([i](s21::Transform& t) {
+      t.tx = 0.1f * i;
+      t.ry += 0.01f;
+    }));
+  }
+  EXPECT_FALSE(coalescer.post([](s21::Transform& t) { t.s *= 2.f; }));
+  // Nothing reaches the model before the frame starts.
+  EXPECT_EQ(model.transform().tx, 0.f);
+
+  EXPECT_TRUE(coalescer.apply());
+  EXPECT_FALSE(coalescer.apply());
+  EXPECT_FLOAT_EQ(model.transform().tx, 2.f);
+  EXPECT_NEAR(model.transform().ry, 0.2f, 1e-5f);
+  EXPECT_FLOAT_EQ(model.transform().s, 2.f);
+  EXPECT_EQ(coalescer.commands(), 22u);
+  EXPECT_EQ(coalescer.appliedFrames(), 1u);
+
+  // Relative edits continue from the applied state.
+  coalescer.post([](s21::Transform& t) { t.tx += 1.f; });
+  coalescer.presented();
+  coalescer.apply();
+  coalescer.presented();
+  EXPECT_FLOAT_EQ(model.transform().tx, 3.f);
+
+  coalescer.post([](s21::Transform& t) { t.tx = 0.f; });
+  coalescer.discard();
+  EXPECT_FALSE(coalescer.apply());
+  coalescer.presented();
+
+  const s21::ProfilerStats stats = profiler.stats();
+  profiler.setEnabled(false);
+  // One latency sample per presented frame.
+  EXPECT_EQ(stats.stage(s21::Stage::kInput).calls, 2u);
+}
+
+TEST(Test, SceneSharesGeometryByContent) {
+  namespace fs = std::filesystem;
+  const fs::path copy = fs::temp_directory_path() / "s21_scene_figure.obj";
+  fs::copy_file("test_figure.obj", copy, fs::copy_options::overwrite_existing);
+
+  s21::Scene scene;
+  const size_t first = scene.addFromFile("test_figure.obj");
+  const size_t second = scene.addFromFile(copy.string());
+  const size_t skull = scene.addFromFile("../objModels/skull.obj");
+  const size_t third = scene.addInstance(first);
+  EXPECT_EQ(scene.size(), 4u);
+  EXPECT_EQ(scene.geometryCount(), 2u);
+  EXPECT_EQ(scene.instance(first).geometry, scene.instance(second).geometry);
+  EXPECT_EQ(scene.instance(first).geometry, scene.instance(third).geometry);
+  EXPECT_NE(scene.instance(first).geometry, scene.instance(skull).geometry);
+
+  scene.setVisible(second, false);
+  const auto batches = scene.batches();
+  ASSERT_EQ(batches.size(), 2u);
+  EXPECT_EQ(batches[0].geometry, scene.instance(first).geometry.get());
+  EXPECT_EQ(batches[0].instances, (std::vector<size_t>{first, third}));
+  EXPECT_EQ(batches[1].instances, (std::vector<size_t>{skull}));
+
+  const unsigned long long version = scene.version();
+  scene.remove(skull);
+  EXPECT_NE(scene.version(), version);
+  EXPECT_EQ(scene.geometryCount(), 1u);
+  EXPECT_THROW(scene.remove(10), std::out_of_range);
+  EXPECT_THROW(scene.addFromFile("missing.obj"), std::runtime_error);
+  EXPECT_EQ(scene.size(), 3u);
+  fs::remove(copy);
+}
+
+TEST(Test, SceneMemoryGrowsWithUniqueGeometry) {
+  s21::Scene scene;
+  scene.addFromFile("../objModels/skull.obj");
+  const size_t one = scene.memoryBytes();
+  for (int i = 0; i < 255; ++i) scene.addInstance(0);
+  const size_t many = scene.memoryBytes();
+  EXPECT_EQ(scene.geometryCount(), 1u);
+  // 256 instances cost far less than two copies of the geometry.
+  EXPECT_LT(many, one + one / 4);
+  EXPECT_LT(many - one, 256u * 256u);
+}
+
+TEST(Test, SceneGridKeepsInstancesApart) {
+  s21::Scene scene;
+  scene.addFromFile("test_figure.obj");
+  for (int i = 0; i < 9; ++i) scene.addInstance(0);
+  scene.setTransform(3, {0.f, 0.f, 0.f, 0.3f, 1.1f, 0.f, 1.f});
+  scene.arrangeGrid(0.1f);
+
+  // Four columns of cell 0.5: every bounding box lies inside its cell.
+  const s21::Bounds& b = scene.instance(0).geometry->mesh.bounds;
+  for (size_t i = 0; i < scene.size(); ++i) {
+    EXPECT_TRUE(scene.inView(i));
+    const float cx = -1.f + 0.5f * (float(i % 4) + 0.5f);
+    const float cy = 1.f - 0.5f * (float(i / 4) + 0.5f);
+    const s21::ViewBox box = s21::viewBox(b, scene.matrix(i));
+    EXPECT_NEAR(box.center[0], cx, 1e-5f) << i;
+    EXPECT_NEAR(box.center[1], cy, 1e-5f) << i;
+    if (i == 3) continue;  // a rotated box is only bounded loosely
+    EXPECT_LE(box.extent[0], 0.25f) << i;
+    EXPECT_LE(box.extent[1], 0.25f) << i;
+  }
+  EXPECT_NEAR(scene.instance(3).transform.rx, 0.3f, 1e-6f);
+
+  s21::Transform away = scene.instance(0).transform;
+  away.tx = 5.f;
+  scene.setTransform(0, away);
+  EXPECT_FALSE(scene.inView(0));
+}
+
+TEST(Test, SceneRenderMatchesModels) {
+  s21::Scene scene;
+  scene.addFromFile("../objModels/skull.obj");
+  scene.addInstance(0);
+  scene.arrangeGrid();
+
+  // Each instance alone, drawn through Model, lights the same pixels as
+  // the scene does.
+  s21::RasterOptions options;
+  s21::Framebuffer sceneImage(96, 96), expected(96, 96);
+  s21::SoftwareRasterizer::render(scene, options, sceneImage);
+  expected.clear(options.background);
+  for (size_t i = 0; i < scene.size(); ++i) {
+    s21::Model model;
+    model.loadFromFile("../objModels/skull.obj");
+    const s21::Transform& t = scene.instance(i).transform;
+    model.setTranslation(t.tx, t.ty, t.tz);
+    model.setRotation(t.rx, t.ry, t.rz);
+    model.setScale(t.s);
+    s21::Framebuffer single(96, 96);
+    s21::SoftwareRasterizer::render(model, options, single);
+    for (int y = 0; y < 96; ++y)
+      for (int x = 0; x < 96; ++x)
+        if (single.pixel(x, y) == options.line)
+          expected.setPixel(x, y, options.line);
+  }
+  int lit = 0, mismatched = 0;
+  for (int y = 0; y < 96; ++y) {
+    for (int x = 0; x < 96; ++x) {
+      lit += sceneImage.pixel(x, y) == options.line;
+      mismatched += sceneImage.pixel(x, y) != expected.pixel(x, y);
+    }
+  }
+  EXPECT_GT(lit, 200);
+  EXPECT_EQ(mismatched, 0);
+}
+
+TEST(Test, BackgroundJobsRetireRunningLoad) {
+  // Controller::LoadModel on a file held by its MeshCache: the running
+  // load is retired and the cached mesh shown without a new job. The
+  // cancelled load reports back later and must not pass for the current
+  // one.
+  struct Job {
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> finished{false};
+  };
+  auto waitFinished = [](const Job& job) {
+    while (!job.finished) std::this_thread::yield();
+  };
+  s21::BackgroundJobs<Job> jobs;
+  std::atomic<int> reports{0};
+  auto running = std::make_shared<Job>();
+  jobs.start(
+      running,
+      [running] {
+        while (!running->cancelled) std::this_thread::yield();
+      },
+      [&reports] { ++reports; });
+  EXPECT_EQ(jobs.current(), running);
+
+  jobs.retire();
+  EXPECT_EQ(jobs.current(), nullptr);
+  waitFinished(*running);
+  EXPECT_FALSE(jobs.finish(running));
+  EXPECT_EQ(jobs.retiredCount(), 0u);
+  EXPECT_EQ(reports, 1);
+
+  // The next uncached load is current until it reports back.
+  auto next = std::make_shared<Job>();
+  jobs.start(next, [] {}, [&reports] { ++reports; });
+  waitFinished(*next);
+  EXPECT_EQ(jobs.current(), next);
+  EXPECT_TRUE(jobs.finish(next));
+  EXPECT_EQ(jobs.current(), nullptr);
+  EXPECT_FALSE(next->cancelled);
+}
+
+TEST(Test, MeshCacheSwapsAndEvicts) {
+  namespace fs = std::filesystem;
+  const fs::path dir = fs::temp_directory_path() / "s21_mesh_cache_test";
+  fs::create_directories(dir);
+  std::vector<std::string> files;
+  for (const char* name : {"a.obj", "b.obj", "c.obj"}) {
+    fs::copy_file("test_figure.obj", dir / name,
+                  fs::copy_options::overwrite_existing);
+    files.push_back((dir / name).string());
+  }
+  auto load = [](const std::string& file, s21::FileStamp& stamp) {
+    EXPECT_TRUE(s21::fileStamp(file, stamp));
+    return s21::MeshLoader::load(file, s21::LoadOptions{});
+  };
+
+  s21::FileStamp stamp;
+  s21::Model model;
+  s21::Mesh first = load(files[0], stamp);
+  const size_t bytes = s21::memoryBytes(first);
+  model.setMesh(std::move(first), files[0]);
+  s21::MeshCache cache(2 * bytes);
+  const s21::Vertex* data = model.getOriginalVertices().data();
+  const std::string file = model.filename();
+  cache.put(file, stamp, model.takeMesh());
+  EXPECT_EQ(model.vertexCount(), 0u);
+  EXPECT_TRUE(cache.contains(files[0]));
+
+  // Taking moves the same buffers back out.
+  s21::FileStamp taken;
+  std::optional<s21::Mesh> mesh = cache.take(files[0], &taken);
+  ASSERT_TRUE(mesh.has_value());
+  EXPECT_EQ(mesh->vertices.data(), data);
+  EXPECT_TRUE(taken == stamp);
+  EXPECT_FALSE(cache.take(files[0]).has_value());
+
+  // The least recently stored entry goes once the budget is exceeded.
+  cache.put(files[0], stamp, std::move(*mesh));
+  for (size_t i = 1; i < files.size(); ++i) {
+    s21::FileStamp s;
+    s21::Mesh m = load(files[i], s);
+    cache.put(files[i], s, std::move(m));
+  }
+  EXPECT_FALSE(cache.contains(files[0]));
+  EXPECT_TRUE(cache.contains(files[1]));
+  EXPECT_TRUE(cache.contains(files[2]));
+  s21::MeshCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.entries, 2u);
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_LE(stats.bytes, stats.budgetBytes);
+
+  // A changed file invalidates its entry.
+  std::ofstream(files[1], std::ios::app) << "# edited\n";
+  EXPECT_FALSE(cache.take(files[1]).has_value());
+  EXPECT_TRUE(cache.take(files[2]).has_value());
+  stats = cache.stats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.invalidations, 1u);
+  EXPECT_EQ(stats.entries, 0u);
+  EXPECT_EQ(stats.bytes, 0u);
+
+  // Nothing is kept beyond the budget.
+  cache.setBudget(bytes / 2);
+  cache.put(files[2], stamp, load(files[2], stamp));
+  EXPECT_FALSE(cache.contains(files[2]));
+  cache.waitReclaimed();
+  fs::remove_all(dir);
+}
+
+TEST(Test, LocalityReorderKeepsTopology) {
+  const s21::Mesh original =
+      s21::MeshLoader::load("../objModels/skull.obj", {});
+  s21::Mesh mesh = original;
+  const std::vector<unsigned> remap = s21::LocalityReorder::apply(mesh);
+  ASSERT_EQ(remap.size(), original.vertices.size());
+  ASSERT_EQ(mesh.vertices.size(), original.vertices.size());
+  ASSERT_EQ(mesh.polygons.size(), original.polygons.size());
+  ASSERT_EQ(mesh.polygons.indices().size(),
+            original.polygons.indices().size());
+  ASSERT_EQ(mesh.edges.size(), original.edges.size());
+
+  for (size_t i = 0; i < remap.size(); ++i) {
+    const s21::Vertex& a = original.vertices[i];
+    const s21::Vertex& b = mesh.vertices[remap[i]];
+    EXPECT_TRUE(a.x == b.x && a.y == b.y && a.z == b.z);
+  }
+  uint32_t previous = 0;
+  for (const s21::Vertex& v : mesh.vertices) {
+    const uint32_t code = s21::mortonCode(v, mesh.bounds);
+    EXPECT_GE(code, previous);
+    previous = code;
+  }
+
+  // Same faces, renumbered and ordered by their lowest vertex.
+  auto faceSet = [](const s21::PolygonList& polygons,
+                    const std::vector<unsigned>* map) {
+    std::vector<std::vector<unsigned>> faces;
+    for (s21::Polygon p : polygons) {
+      std::vector<unsigned> face(p.begin(), p.end());
+      if (map)
+        for (unsigned& i : face) i = (*map)[i];
+      faces.push_back(std::move(face));
+    }
+    std::sort(faces.begin(), faces.end());
+    return faces;
+  };
+  EXPECT_EQ(faceSet(mesh.polygons, nullptr),
+            faceSet(original.polygons, &remap));
+  // skull.obj has groups: faces and edges keep their group ranges and are
+  // ordered within them.
+  ASSERT_FALSE(original.groups.empty());
+  ASSERT_EQ(mesh.groups.size(), original.groups.size());
+  for (size_t g = 0; g < mesh.groups.size(); ++g) {
+    const s21::FaceGroup& group = mesh.groups[g];
+    const s21::FaceGroup& before = original.groups[g];
+    EXPECT_EQ(group.firstFace, before.firstFace);
+    EXPECT_EQ(group.faceCount, before.faceCount);
+    EXPECT_EQ(group.edgeCount, before.edgeCount);
+    unsigned lowest = 0;
+    for (unsigned f = group.firstFace; f < group.firstFace + group.faceCount;
+         ++f) {
+      const s21::Polygon p = mesh.polygons[f];
+      const unsigned first = *std::min_element(p.begin(), p.end());
+      EXPECT_GE(first, lowest);
+      lowest = first;
+    }
+    const auto begin = mesh.edges.begin() + group.firstEdge;
+    const auto end = begin + group.edgeCount;
+    for (unsigned i = before.firstEdge;
+         i < before.firstEdge + before.edgeCount; ++i) {
+      const s21::Edge& e = original.edges[i];
+      const s21::Edge mapped{std::min(remap[e.a], remap[e.b]),
+                             std::max(remap[e.a], remap[e.b])};
+      EXPECT_TRUE(std::binary_search(
+          begin, end, mapped, [](const s21::Edge& l, const s21::Edge& r) {
+            return l.a < r.a || (l.a == r.a && l.b < r.b);
+          }));
+    }
+  }
+
+  s21::Model model;
+  model.setReorderEnabled(true);
+  model.setLodEnabled(true);
+  model.loadFromFile("../objModels/skull.obj");
+  EXPECT_EQ(model.getOriginalVertices()[remap[7]].x, original.vertices[7].x);
+  EXPECT_EQ(model.edgeCount(), original.edges.size());
+  EXPECT_GT(model.lodCount(), 1);
+}